@@ -23,6 +23,7 @@
 #include <polyglotbook.h>
 #include <tournament.h>
 #include <gamemanager.h>
+#include <gamewriter.h>
 #include <sprt.h>
 
 
@@ -122,6 +123,40 @@ void EngineMatch::onGameFinished(ChessGame* game, int number)
 	      qUtf8Printable(game->player(Chess::Side::Black)->name()),
 	      qUtf8Printable(result.toVerboseString()));
 
+	if (m_debug && game->resultCheckCount() > 0)
+	{
+		double usecs = game->resultCheckTime() / 1000.0
+			     / game->resultCheckCount();
+		print(QString("Game %1: result check took %2 us per move (%3 moves)")
+		      .arg(number)
+		      .arg(usecs, 0, 'f', 1)
+		      .arg(game->resultCheckCount()));
+	}
+	if (m_debug)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			Chess::Side side = Chess::Side::Type(i);
+			print(QString("Game %1: %2 clock overhead %3 ms, lag %4 ms (max %5 ms)")
+			      .arg(number)
+			      .arg(game->player(side)->name())
+			      .arg(game->clockOverhead(side))
+			      .arg(game->clockLag(side))
+			      .arg(game->maxClockLag(side)));
+		}
+
+		const GameWriter* writer = m_tournament->gameWriter();
+		qint64 msecs = qMax(writer->writeTime(), qint64(1));
+		print(QString("Game writer: queue %1 (max %2), %3 games, %4 KiB "
+			      "in %5 ms (%6 games/s)")
+		      .arg(writer->queueSize())
+		      .arg(writer->peakQueueSize())
+		      .arg(writer->writtenGameCount())
+		      .arg(writer->writtenByteCount() / 1024)
+		      .arg(writer->writeTime())
+		      .arg(writer->writtenGameCount() * 1000.0 / msecs, 0, 'f', 1));
+	}
+
 	if (m_tournament->playerCount() == 2)
 	{
 		TournamentPlayer fcp = m_tournament->playerAt(0);
@@ -36,6 +36,9 @@
 #include <enginefactory.h>
 #include <enginetextoption.h>
 #include <openingsuite.h>
+#include <compiledbook.h>
+#include <gamerecord.h>
+#include <gamerecordstream.h>
 #include <sprt.h>
 #include <board/syzygytablebase.h>
 #include <board/result.h>
@@ -224,6 +227,8 @@ bool parseEngine(const QStringList& args, EngineData& data)
 			data.config.setOption(name.section('.', 1), val);
 		else if (name == "stderr")
 			data.config.setStderrFile(val);
+		else if (name == "transcript")
+			data.config.setTranscriptFile(val);
 		else
 		{
 			qWarning() << "Invalid engine option:" << name;
@@ -243,6 +248,8 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	parser.addOption("-each", QVariant::StringList, 1);
 	parser.addOption("-variant", QVariant::String, 1, 1);
 	parser.addOption("-concurrency", QVariant::Int, 1, 1);
+	parser.addOption("-shards", QVariant::Int, 1, 1);
+	parser.addOption("-pin", QVariant::Bool, 0, 0);
 	parser.addOption("-draw", QVariant::StringList);
 	parser.addOption("-resign", QVariant::StringList);
 	parser.addOption("-maxmoves", QVariant::Int, 1, 1);
@@ -257,8 +264,10 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	parser.addOption("-debug", QVariant::Bool, 0, 0);
 	parser.addOption("-openings", QVariant::StringList);
 	parser.addOption("-bookmode", QVariant::String);
-	parser.addOption("-pgnout", QVariant::StringList, 1, 3);
+	parser.addOption("-pgnout", QVariant::StringList, 1, 4);
 	parser.addOption("-epdout", QVariant::String, 1, 1);
+	parser.addOption("-binout", QVariant::String, 1, 1);
+	parser.addOption("-outsync", QVariant::StringList);
 	parser.addOption("-repeat", QVariant::Int, 0, 1);
 	parser.addOption("-noswap", QVariant::Bool, 0, 0);
 	parser.addOption("-recover", QVariant::Bool, 0, 0);
@@ -319,6 +328,16 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 			if (ok)
 				manager->setConcurrency(value.toInt());
 		}
+		// Number of threads shared by the concurrent games
+		else if (name == "-shards")
+		{
+			ok = value.toInt() >= 0;
+			if (ok)
+				manager->setShardCount(value.toInt());
+		}
+		// Pin the engines to the CPUs
+		else if (name == "-pin")
+			manager->setCpuPinning(true);
 		// Threshold for draw adjudication
 		else if (name == "-draw")
 		{
@@ -512,7 +531,7 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		{
 			PgnGame::PgnMode mode = PgnGame::Verbose;
 			QStringList list = value.toStringList();
-			if (list.size() == 2 || list.size() == 3)
+			if (list.size() >= 2)
 			{
 				for (int i = 1; i < list.size(); i++)
 				{
@@ -520,6 +539,8 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 						mode = PgnGame::Minimal;
 					else if (list.at(i) == "fi")
 						tournament->setPgnWriteUnfinishedGames(false);
+					else if (list.at(i) == "unordered")
+						tournament->setPgnOrderEnabled(false);
 					else
 						ok = false;
 				}
@@ -533,6 +554,23 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 			QString fileName = value.toString();
 			tournament->setEpdOutput(fileName);
 		}
+		// Binary file where the games should be saved
+		else if (name == "-binout")
+			tournament->setBinaryOutput(value.toString());
+		// How often the PGN and EPD files are synced to disk
+		else if (name == "-outsync")
+		{
+			QMap<QString, QString> params =
+				option.toMap("interval=0|games=0");
+			bool intervalOk = false;
+			bool gamesOk = false;
+			int interval = params["interval"].toInt(&intervalOk);
+			int games = params["games"].toInt(&gamesOk);
+
+			ok = (intervalOk && gamesOk && interval >= 0 && games >= 0);
+			if (ok)
+				tournament->setOutputSyncInterval(interval, games);
+		}
 		// Play every opening twice (default), or multiple times
 		else if (name == "-repeat")
 		{
@@ -710,6 +748,76 @@ int main(int argc, char* argv[])
 
 			return 0;
 		}
+		else if (arg == "--compilebook" || arg == "-compilebook")
+		{
+			int i = arguments.indexOf(arg);
+			if (i + 2 >= arguments.size())
+			{
+				qWarning("Usage: -compilebook SQLITE_BOOK OUTPUT");
+				return 1;
+			}
+
+			QString error;
+			if (!CompiledBook::compile(arguments.at(i + 1),
+						   arguments.at(i + 2), &error))
+			{
+				qWarning("Cannot compile opening book %s: %s",
+					 qUtf8Printable(arguments.at(i + 1)),
+					 qUtf8Printable(error));
+				return 1;
+			}
+
+			return 0;
+		}
+		else if (arg == "--binpgn" || arg == "-binpgn")
+		{
+			int i = arguments.indexOf(arg);
+			if (i + 2 >= arguments.size())
+			{
+				qWarning("Usage: -binpgn BINARY_FILE PGN_FILE [min]");
+				return 1;
+			}
+			PgnGame::PgnMode mode = PgnGame::Verbose;
+			if (i + 3 < arguments.size() && arguments.at(i + 3) == "min")
+				mode = PgnGame::Minimal;
+
+			QFile input(arguments.at(i + 1));
+			if (!input.open(QIODevice::ReadOnly))
+			{
+				qWarning("Cannot open binary game file %s",
+					 qUtf8Printable(input.fileName()));
+				return 1;
+			}
+			QFile output(arguments.at(i + 2));
+			if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			{
+				qWarning("Cannot open PGN file %s",
+					 qUtf8Printable(output.fileName()));
+				return 1;
+			}
+
+			GameRecordStream stream(&input);
+			QTextStream pgnOut(&output);
+			GameRecord record;
+			PgnGame pgn;
+			int count = 0;
+			while (stream.readRecord(&record))
+			{
+				if (!record.toPgn(&pgn))
+					qWarning("Game %d has illegal moves", count + 1);
+				pgn.write(pgnOut, mode);
+				count++;
+			}
+			pgnOut.flush();
+			if (stream.status() != GameRecordStream::ReadPastEnd)
+			{
+				qWarning("Invalid binary game data after %d games in %s",
+					 count, qUtf8Printable(input.fileName()));
+				return 1;
+			}
+
+			return 0;
+		}
 		else if (arg == "--help" || arg == "-help")
 		{
 			QFile file(":/help.txt");
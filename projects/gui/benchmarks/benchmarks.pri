@@ -0,0 +1,11 @@
+TEMPLATE = app
+
+win32:config += CONSOLE
+QT += testlib
+
+INCLUDEPATH += $$PWD/../src
+DEPENDPATH += $$PWD/../src
+include(../opencv.pri)
+
+OBJECTS_DIR = .obj
+MOC_DIR = .moc
@@ -0,0 +1,11 @@
+include(../benchmarks.pri)
+include(../../../lib/lib.pri)
+include(../../src/boardview/boardview.pri)
+
+TARGET = tst_boardview
+QT += svg widgets
+
+# The piece pictures are read from the image directory next to the program
+DESTDIR = $$PWD/../..
+
+SOURCES += tst_boardview.cpp
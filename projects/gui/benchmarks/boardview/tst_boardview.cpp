@@ -0,0 +1,140 @@
+#include <QtTest/QtTest>
+#include <QPainter>
+#include <QPixmapCache>
+#include <QtMath>
+#include <board/board.h>
+#include <board/boardfactory.h>
+#include <boardview/boardscene.h>
+
+/*
+ * Frame time of a wall of animated boards.
+ *
+ * Every board makes a move each CUTECHESS_BOARDVIEW_MOVE_FRAMES frames
+ * (10), and every frame all the boards are painted into one image the
+ * way the game wall's views paint them. The animations advance in real
+ * time between the frames. CUTECHESS_BOARDVIEW_FRAMES sets the number
+ * of frames per row (300).
+ *
+ * The pieces are read from image/default.svg next to the program.
+ * Run with "-platform offscreen" on a machine without a display.
+ */
+
+namespace {
+
+// Size of one board on the wall, in pixels
+const QSize s_boardSize(270, 300);
+// Games are restarted after this many plies
+const int s_gameLength = 80;
+
+int environmentValue(const char* name, int defaultValue)
+{
+	bool ok = false;
+	int value = qEnvironmentVariableIntValue(name, &ok);
+	return ok && value > 0 ? value : defaultValue;
+}
+
+BoardScene* newScene()
+{
+	Chess::Board* board = Chess::BoardFactory::create("standard");
+	board->initialize();
+	board->setFenString(board->defaultFenString());
+
+	BoardScene* scene = new BoardScene;
+	scene->setBoard(board);
+	scene->populate();
+	return scene;
+}
+
+void makeMove(BoardScene* scene)
+{
+	Chess::Board* board = scene->board();
+	const QVector<Chess::Move> moves(board->legalMoves());
+	if (moves.isEmpty() || board->plyCount() >= s_gameLength)
+	{
+		scene->setFenString(board->defaultFenString());
+		return;
+	}
+
+	// Vary the moves to stay away from repetitions
+	scene->makeMove(moves.at(board->plyCount() * 7 % moves.size()));
+}
+
+} // anonymous namespace
+
+class tst_BoardView: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void frames_data() const;
+		void frames();
+};
+
+void tst_BoardView::frames_data() const
+{
+	QTest::addColumn<int>("boards");
+
+	const int counts[] = { 1, 4, 16, 32 };
+	for (int count : counts)
+		QTest::newRow(qPrintable(QString("%1 boards").arg(count))) << count;
+}
+
+void tst_BoardView::frames()
+{
+	QFETCH(int, boards);
+
+	const int frameCount = environmentValue("CUTECHESS_BOARDVIEW_FRAMES", 300);
+	const int moveFrames = environmentValue("CUTECHESS_BOARDVIEW_MOVE_FRAMES", 10);
+
+	QPixmapCache::clear();
+	QList<BoardScene*> scenes;
+	for (int i = 0; i < boards; i++)
+		scenes << newScene();
+
+	int columns = qCeil(qSqrt(boards));
+	int rows = (boards + columns - 1) / columns;
+	QImage wall(s_boardSize.width() * columns, s_boardSize.height() * rows,
+		    QImage::Format_ARGB32_Premultiplied);
+
+	qint64 nsecs = 0;
+	qint64 maxNsecs = 0;
+	QElapsedTimer timer;
+
+	QBENCHMARK_ONCE
+	{
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			if (frame % moveFrames == 0)
+			{
+				for (BoardScene* scene : qAsConst(scenes))
+					makeMove(scene);
+			}
+			QCoreApplication::processEvents();
+
+			timer.start();
+			wall.fill(Qt::white);
+			QPainter painter(&wall);
+			painter.setRenderHints(QPainter::Antialiasing
+					       | QPainter::SmoothPixmapTransform);
+			for (int i = 0; i < scenes.size(); i++)
+			{
+				QRectF target(QPointF((i % columns) * s_boardSize.width(),
+						      (i / columns) * s_boardSize.height()),
+					      s_boardSize);
+				scenes.at(i)->render(&painter, target);
+			}
+			painter.end();
+
+			qint64 elapsed = timer.nsecsElapsed();
+			nsecs += elapsed;
+			maxNsecs = qMax(maxNsecs, elapsed);
+		}
+	}
+
+	qInfo("%d boards: %.3f ms per frame, at most %.3f ms",
+	      boards, double(nsecs) / 1.0e6 / frameCount, double(maxNsecs) / 1.0e6);
+	qDeleteAll(scenes);
+}
+
+QTEST_MAIN(tst_BoardView)
+#include "tst_boardview.moc"
@@ -0,0 +1,7 @@
+include(../benchmarks.pri)
+
+TARGET = tst_capture
+DEFINES += CAPTURE_IMAGE_DIR=\\\"$$PWD/../../image\\\"
+HEADERS += $$PWD/../../src/gridrecognizer.h
+SOURCES += tst_capture.cpp \
+    $$PWD/../../src/gridrecognizer.cpp
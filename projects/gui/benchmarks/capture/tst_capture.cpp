@@ -0,0 +1,175 @@
+#include <QtTest/QtTest>
+#include <opencv2/imgcodecs.hpp>
+#include <gridrecognizer.h>
+
+/*
+ * Board recognition speed on saved screenshots.
+ *
+ * Every PNG file in the image directory is read as a screenshot of a
+ * board. The directory defaults to projects/gui/image and can be
+ * changed with the CUTECHESS_CAPTURE_DIR environment variable. The
+ * piece templates are read from the findchess/0 subdirectory, or from
+ * the catalog named by CUTECHESS_CAPTURE_CATALOG.
+ *
+ * The grid of a screenshot is found from its two black Che like
+ * Capture::GetLxInfo() does; screenshots without both of them on the
+ * top row are skipped. The grid read is compared with the full-frame
+ * search of every piece that Capture used before.
+ */
+
+namespace {
+
+// Capture's default matching precision
+const double s_threshold = 0.96;
+
+struct Screenshot
+{
+	QString name;
+	cv::Mat image;
+	Chess::GridRecognizer recognizer;
+};
+
+QString environmentValue(const char* name, const QString& defaultValue)
+{
+	QString value = QString::fromLocal8Bit(qgetenv(name));
+	return value.isEmpty() ? defaultValue : value;
+}
+
+QString boardString(const int* b90)
+{
+	static const char s_pieces[] = ".pbacnrkPBACNRK";
+
+	QString str;
+	for (int square = 0; square < Chess::GridRecognizer::SquareCount; square++)
+	{
+		if (square > 0 && square % 9 == 0)
+			str += '/';
+		str += QChar(s_pieces[b90[square]]);
+	}
+	return str;
+}
+
+void reportTime(const char* what, int reads, qint64 nsecs)
+{
+	if (reads <= 0)
+		return;
+	qInfo("%s: %d boards, %.3f ms per board",
+	      what, reads, double(nsecs) / 1.0e6 / reads);
+}
+
+} // anonymous namespace
+
+class tst_Capture: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+
+		void gridRead_data() const;
+		void gridRead();
+		void fullFrameRead_data() const;
+		void fullFrameRead();
+
+	private:
+		QVector<Screenshot> m_screenshots;
+};
+
+void tst_Capture::initTestCase()
+{
+	QDir dir(environmentValue("CUTECHESS_CAPTURE_DIR", CAPTURE_IMAGE_DIR));
+	QString catalog(environmentValue("CUTECHESS_CAPTURE_CATALOG", "0"));
+	QString templateDir(dir.filePath("findchess/" + catalog));
+
+	Chess::GridRecognizer recognizer;
+	recognizer.setThreshold(s_threshold);
+	QVERIFY2(recognizer.loadTemplates(templateDir), qPrintable(templateDir));
+
+	const QStringList files = dir.entryList(QStringList() << "*.png",
+						QDir::Files, QDir::Name);
+	for (const QString& file : files)
+	{
+		Screenshot shot;
+		shot.name = file;
+		shot.image = cv::imread(dir.filePath(file).toStdString());
+		shot.recognizer = recognizer;
+		if (shot.image.empty() || !shot.recognizer.locateGrid(shot.image))
+		{
+			qInfo("%s: no board found", qPrintable(file));
+			continue;
+		}
+
+		// Capture only keeps the board part of the window
+		shot.image = shot.image(shot.recognizer.boardRect(shot.image.size()));
+		m_screenshots << shot;
+	}
+
+	if (m_screenshots.isEmpty())
+		QSKIP("No screenshots with a board");
+}
+
+void tst_Capture::gridRead_data() const
+{
+	QTest::addColumn<int>("index");
+	QTest::addColumn<bool>("parallel");
+
+	for (int i = 0; i < m_screenshots.size(); i++)
+	{
+		const QString& name = m_screenshots.at(i).name;
+		QTest::newRow(qPrintable(name)) << i << true;
+		QTest::newRow(qPrintable(name + " serial")) << i << false;
+	}
+}
+
+void tst_Capture::gridRead()
+{
+	QFETCH(int, index);
+	QFETCH(bool, parallel);
+
+	const Screenshot& shot = m_screenshots.at(index);
+	Chess::GridRecognizer recognizer(shot.recognizer);
+	recognizer.setParallel(parallel);
+
+	int b90[Chess::GridRecognizer::SquareCount];
+	int reads = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		QVERIFY(recognizer.recognize(shot.image, b90));
+		reads++;
+	}
+	reportTime("grid read", reads, timer.nsecsElapsed());
+
+	int expected[Chess::GridRecognizer::SquareCount];
+	QVERIFY(recognizer.recognizeFullFrame(shot.image, expected));
+	QCOMPARE(boardString(b90), boardString(expected));
+}
+
+void tst_Capture::fullFrameRead_data() const
+{
+	QTest::addColumn<int>("index");
+
+	for (int i = 0; i < m_screenshots.size(); i++)
+		QTest::newRow(qPrintable(m_screenshots.at(i).name)) << i;
+}
+
+void tst_Capture::fullFrameRead()
+{
+	QFETCH(int, index);
+
+	const Screenshot& shot = m_screenshots.at(index);
+	int b90[Chess::GridRecognizer::SquareCount];
+	int reads = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		QVERIFY(shot.recognizer.recognizeFullFrame(shot.image, b90));
+		reads++;
+	}
+	reportTime("full-frame read", reads, timer.nsecsElapsed());
+}
+
+QTEST_MAIN(tst_Capture)
+#include "tst_capture.moc"
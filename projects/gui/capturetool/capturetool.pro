@@ -0,0 +1,20 @@
+TEMPLATE = app
+TARGET = cutechess-capture
+DESTDIR = $$PWD
+
+CONFIG += console
+CONFIG -= app_bundle
+QT += gui
+
+INCLUDEPATH += $$PWD/../src
+DEPENDPATH += $$PWD/../src
+include(../opencv.pri)
+
+OBJECTS_DIR = .obj
+MOC_DIR = .moc
+
+HEADERS += $$PWD/../src/framesource.h \
+    $$PWD/../src/gridrecognizer.h
+SOURCES += main.cpp \
+    $$PWD/../src/framesource.cpp \
+    $$PWD/../src/gridrecognizer.cpp
@@ -0,0 +1,292 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <utility>
+
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTextStream>
+
+#include <framesource.h>
+#include <gridrecognizer.h>
+
+/*
+ * cutechess-capture reads Xiangqi boards from screenshots the way the
+ * GUI's board capture does, without the GUI. It prints the FEN of every
+ * frame and the recognition speed, so recorded sessions can be used to
+ * check the accuracy and the frame rate of the recognizer.
+ */
+
+namespace {
+
+enum Mode
+{
+	GridMode,
+	DiffMode,
+	FullFrameMode
+};
+
+void printUsage(QTextStream& out)
+{
+	out << "Usage: cutechess-capture -templates DIR [options] SOURCE\n"
+	       "\n"
+	       "SOURCE is a directory of screenshots, a video file, or\n"
+	       "'screen' or 'screen:WINDOW' to grab the screen or a window.\n"
+	       "\n"
+	       "Options:\n"
+	       "  -templates DIR  Read the piece pictures from DIR\n"
+	       "  -grid X,Y,D     The top left intersection is at (X,Y) and the\n"
+	       "                  intersections are D pixels apart. By default\n"
+	       "                  the grid is found from the black Che\n"
+	       "  -mode MODE      'grid' reads every intersection of every frame,\n"
+	       "                  'diff' only the ones that changed and\n"
+	       "                  'fullframe' searches the whole frame for every\n"
+	       "                  piece. The default is 'grid'\n"
+	       "  -threshold N    Set the minimum matching score to N (0.96)\n"
+	       "  -frames N       Stop after N frames\n"
+	       "  -serial         Don't read the intersections in parallel\n"
+	       "\n"
+	       "A screenshot with a .fen file of the same name is checked against\n"
+	       "the board of that FEN, and the exit status is 1 if any differ.\n";
+	out.flush();
+}
+
+bool isScreenSource(const QString& source)
+{
+	return source == "screen" || source.startsWith("screen:");
+}
+
+// The board part of the FEN stored next to a screenshot
+QString expectedBoard(const QString& frameName)
+{
+	QFileInfo info(frameName);
+	QFile file(info.path() + "/" + info.completeBaseName() + ".fen");
+	if (frameName.isEmpty() || !file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return QString();
+
+	return QString::fromUtf8(file.readLine()).section(' ', 0, 0).trimmed();
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+	// Only grabbing the screen needs a display
+	bool useScreen = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (isScreenSource(QString::fromLocal8Bit(argv[i])))
+			useScreen = true;
+	}
+	QScopedPointer<QCoreApplication> app(useScreen
+		? new QGuiApplication(argc, argv)
+		: new QCoreApplication(argc, argv));
+
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	QString templateDir;
+	QString sourceName;
+	QString gridString;
+	Mode mode = GridMode;
+	double threshold = 0.96;
+	int maxFrames = -1;
+	bool parallel = true;
+
+	QStringList args = app->arguments();
+	args.removeFirst();
+	for (int i = 0; i < args.size(); i++)
+	{
+		const QString& arg = args.at(i);
+		bool hasValue = i + 1 < args.size();
+		bool ok = true;
+
+		if (arg == "-help" || arg == "--help")
+		{
+			printUsage(out);
+			return 0;
+		}
+		else if (arg == "-templates" && hasValue)
+			templateDir = args.at(++i);
+		else if (arg == "-grid" && hasValue)
+			gridString = args.at(++i);
+		else if (arg == "-mode" && hasValue)
+		{
+			QString value = args.at(++i);
+			if (value == "grid")
+				mode = GridMode;
+			else if (value == "diff")
+				mode = DiffMode;
+			else if (value == "fullframe")
+				mode = FullFrameMode;
+			else
+				ok = false;
+		}
+		else if (arg == "-threshold" && hasValue)
+			threshold = args.at(++i).toDouble(&ok);
+		else if (arg == "-frames" && hasValue)
+			maxFrames = args.at(++i).toInt(&ok);
+		else if (arg == "-serial")
+			parallel = false;
+		else if (!arg.startsWith('-') && sourceName.isEmpty())
+			sourceName = arg;
+		else
+			ok = false;
+
+		if (!ok)
+		{
+			err << "Invalid argument: " << arg << "\n";
+			printUsage(err);
+			return 1;
+		}
+	}
+
+	if (templateDir.isEmpty() || sourceName.isEmpty())
+	{
+		printUsage(err);
+		return 1;
+	}
+
+	Chess::GridRecognizer recognizer;
+	recognizer.setThreshold(threshold);
+	recognizer.setParallel(parallel);
+	if (!recognizer.loadTemplates(templateDir))
+	{
+		err << "Can't read the piece pictures in " << templateDir << "\n";
+		return 1;
+	}
+
+	if (!gridString.isEmpty())
+	{
+		const QStringList values = gridString.split(',');
+		float grid[3] = { 0.0f, 0.0f, 0.0f };
+		bool ok = values.size() == 3;
+		for (int i = 0; ok && i < 3; i++)
+			grid[i] = values.at(i).toFloat(&ok);
+		if (!ok || grid[2] <= 0.0f)
+		{
+			err << "Invalid grid: " << gridString << "\n";
+			return 1;
+		}
+		recognizer.setGrid(grid[0], grid[1], grid[2], grid[2]);
+	}
+
+	QScopedPointer<Chess::FrameSource> source;
+	if (isScreenSource(sourceName))
+	{
+		WId window = WId(sourceName.section(':', 1).toULongLong(nullptr, 0));
+		source.reset(new Chess::ScreenFrameSource(window));
+	}
+	else
+	{
+		Chess::ReplayFrameSource* replay = new Chess::ReplayFrameSource(sourceName);
+		source.reset(replay);
+		if (!replay->isOpen())
+		{
+			err << "Can't open " << sourceName << "\n";
+			return 1;
+		}
+	}
+
+	int b90[Chess::GridRecognizer::SquareCount];
+	cv::Mat frame;
+	cv::Mat signatures;
+	cv::Mat lastSignatures;
+	int frames = 0;
+	int checked = 0;
+	int correct = 0;
+	qint64 squaresRead = 0;
+	qint64 nsecs = 0;
+	QElapsedTimer timer;
+
+	while ((maxFrames < 0 || frames < maxFrames) && source->grab(frame))
+	{
+		if (!recognizer.hasGrid() && !recognizer.locateGrid(frame))
+		{
+			err << source->frameName() << ": no board found\n";
+			continue;
+		}
+
+		timer.start();
+		bool ok = true;
+		if (mode == FullFrameMode)
+		{
+			ok = recognizer.recognizeFullFrame(frame, b90);
+			squaresRead += Chess::GridRecognizer::SquareCount;
+		}
+		else if (mode == DiffMode && !lastSignatures.empty())
+		{
+			recognizer.signatures(frame, signatures);
+			const QVector<int> changed =
+				recognizer.changedSquares(lastSignatures, signatures);
+			for (int square : changed)
+				b90[square] = recognizer.classify(frame, square);
+			squaresRead += changed.size();
+		}
+		else
+		{
+			ok = recognizer.recognize(frame, b90);
+			if (mode == DiffMode)
+				recognizer.signatures(frame, signatures);
+			squaresRead += Chess::GridRecognizer::SquareCount;
+		}
+		std::swap(signatures, lastSignatures);
+		nsecs += timer.nsecsElapsed();
+		frames++;
+
+		if (!ok)
+		{
+			err << source->frameName() << ": recognition failed\n";
+			continue;
+		}
+
+		QString fen = Chess::GridRecognizer::fenString(
+			b90, Chess::GridRecognizer::isFlipped(b90));
+		out << source->frameName() << '\t' << fen;
+
+		QString expected = expectedBoard(source->frameName());
+		if (!expected.isEmpty())
+		{
+			checked++;
+			if (fen.section(' ', 0, 0) == expected)
+				correct++;
+			else
+				out << "\tMISMATCH " << expected;
+		}
+		out << "\n";
+	}
+
+	if (frames > 0)
+	{
+		double ms = double(nsecs) / 1.0e6 / frames;
+		out << frames << " frames, "
+		    << QString::number(ms, 'f', 3) << " ms per frame, "
+		    << QString::number(ms > 0.0 ? 1000.0 / ms : 0.0, 'f', 1) << " fps, "
+		    << QString::number(double(squaresRead) / frames, 'f', 1)
+		    << " intersections read per frame\n";
+	}
+	if (checked > 0)
+		out << correct << " of " << checked << " boards correct\n";
+	out.flush();
+
+	return correct == checked ? 0 : 1;
+}
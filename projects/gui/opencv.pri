@@ -0,0 +1,14 @@
+# OpenCV for the board capture code. On Windows OPENCV_DIR points to
+# the OpenCV build directory, elsewhere pkg-config finds it.
+win32 {
+    INCLUDEPATH += $$(OPENCV_DIR)/include
+    LIBS += -L$$(OPENCV_DIR)/x64/vc15/lib
+    CONFIG(debug, debug|release) {
+        LIBS += -lopencv_world410d
+    } else {
+        LIBS += -lopencv_world410
+    }
+} else {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += opencv4
+}
@@ -50,7 +50,7 @@ BoardScene::BoardScene(QObject* parent)
 	  m_anim(nullptr),
 	  //m_renderer(new QSvgRenderer(QString(":/default.svg"), this)),
 	  //QString pic = QCoreApplication::applicationDirPath() + "/image/default.svg";
-	  m_renderer(new QSvgRenderer((QCoreApplication::applicationDirPath() + "/image/default.svg"), this)),
+	  m_renderer(pieceRenderer()),
 	  m_highlightPiece(nullptr),
 	  m_moveArrows(nullptr)
 {
@@ -63,6 +63,16 @@ BoardScene::~BoardScene()
 	delete m_board;
 }
 
+QSvgRenderer* BoardScene::pieceRenderer()
+{
+	// All the scenes share one renderer, so the pieces of every
+	// board can use the same cached pictures.
+	static QSvgRenderer* s_renderer = new QSvgRenderer(
+		QCoreApplication::applicationDirPath() + "/image/default.svg",
+		QCoreApplication::instance());
+	return s_renderer;
+}
+
 Chess::Board* BoardScene::board() const
 {
 	return m_board;
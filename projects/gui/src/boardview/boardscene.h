@@ -74,6 +74,9 @@ class BoardScene : public QGraphicsScene
 		 */
 		void setBoard(Chess::Board* board);
 
+		/*! Returns the SVG renderer of the piece pictures. */
+		static QSvgRenderer* pieceRenderer();
+
 	public slots:
 		/*!
 		 * Clears the scene, creates a new board, and populates
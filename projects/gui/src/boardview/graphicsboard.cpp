@@ -22,7 +22,9 @@
 #include <QMargins>
 #include <QPainter>
 #include <QPalette>
+#include <QPixmapCache>
 #include <QPropertyAnimation>
+#include <QtMath>
 #include <board/square.h>
 #include "graphicspiece.h"
 
@@ -75,8 +77,6 @@ GraphicsBoard::GraphicsBoard(int files,
 	m_rect.setSize(QSizeF(squareSize * files, squareSize * ranks));
 	m_rect.moveCenter(QPointF(0, 0));
 	m_textColor = QApplication::palette().text().color();
-
-	setCacheMode(DeviceCoordinateCache);
 }
 
 GraphicsBoard::~GraphicsBoard()
@@ -104,6 +104,49 @@ void GraphicsBoard::paint(QPainter* painter,
 	Q_UNUSED(option);
 	Q_UNUSED(widget);
 
+	// The lines and labels are drawn into a pixmap of the board's
+	// size in device pixels. The pixmap is shared by all the boards
+	// of the same geometry and colors, so a new board reuses it.
+	// The device transform includes the device pixel ratio.
+	const QRectF rect(boundingRect());
+	const QTransform t(painter->deviceTransform());
+	const qreal scale = qSqrt(t.m11() * t.m11() + t.m12() * t.m12());
+	const QSize size((rect.size() * scale).toSize());
+	if (size.isEmpty())
+		return;
+
+	const QString key(QString("GraphicsBoard:%1x%2:%3:%4:%5:%6:%7:%8x%9")
+			  .arg(m_files)
+			  .arg(m_ranks)
+			  .arg(m_squareSize)
+			  .arg(m_coordSize)
+			  .arg(m_lightColor.rgba())
+			  .arg(m_darkColor.rgba())
+			  .arg(m_textColor.rgba())
+			  .arg(size.width())
+			  .arg(size.height()));
+	QPixmap background;
+	if (!QPixmapCache::find(key, &background))
+	{
+		background = QPixmap(size);
+		background.fill(Qt::transparent);
+
+		QPainter backgroundPainter(&background);
+		backgroundPainter.setRenderHints(painter->renderHints());
+		backgroundPainter.scale(size.width() / rect.width(),
+					size.height() / rect.height());
+		backgroundPainter.translate(-rect.topLeft());
+		paintBackground(&backgroundPainter);
+		backgroundPainter.end();
+
+		QPixmapCache::insert(key, background);
+	}
+
+	painter->drawPixmap(rect, background, QRectF(background.rect()));
+}
+
+void GraphicsBoard::paintBackground(QPainter* painter) const
+{
 	// ͼ
 	//QString picPath = QCoreApplication::applicationDirPath() + "/image/backgroud.jpg";	
 	//painter->drawPixmap(m_rect.left()-100,m_rect.top()-100, QPixmap(picPath));
@@ -136,6 +136,7 @@ class GraphicsBoard : public QGraphicsItem
 
 	private:
 		int squareIndex(const Chess::Square& square) const;
+		void paintBackground(QPainter* painter) const;
 
 		int m_files;
 		int m_ranks;
@@ -19,7 +19,10 @@
 #pragma execution_character_set("utf-8")
 
 #include "graphicspiece.h"
+#include <QPainter>
+#include <QPixmapCache>
 #include <QSvgRenderer>
+#include <QtMath>
 
 // 
 GraphicsPiece::GraphicsPiece(const Chess::Piece& piece,
@@ -36,7 +39,6 @@ GraphicsPiece::GraphicsPiece(const Chess::Piece& piece,
 	  m_container(nullptr)
 {
 	setAcceptedMouseButtons(Qt::LeftButton);
-	setCacheMode(DeviceCoordinateCache);
 }
 
 int GraphicsPiece::type() const
@@ -58,9 +60,17 @@ void GraphicsPiece::paint(QPainter* painter,
 	Q_UNUSED(option);
 	Q_UNUSED(widget);
 
-	QRectF bounds(m_renderer->boundsOnElement(m_elementId));
+	paintPicture(painter, m_renderer, m_elementId, m_rect);
+}
+
+void GraphicsPiece::paintPicture(QPainter* painter,
+				 QSvgRenderer* renderer,
+				 const QString& elementId,
+				 const QRectF& square)
+{
+	QRectF bounds(renderer->boundsOnElement(elementId));
 	qreal ar = bounds.width() / bounds.height();
-	qreal width = m_rect.width() * 0.95;  // was 0.8 Ըӵı
+	qreal width = square.width() * 0.95;  // was 0.8 Ըӵı
 
 	if (ar > 1.0)
 	{
@@ -72,9 +82,35 @@ void GraphicsPiece::paint(QPainter* painter,
 		bounds.setHeight(width);
 		bounds.setWidth(width * ar);
 	}
-	bounds.moveCenter(m_rect.center());
+	bounds.moveCenter(square.center());
+
+	// The device transform includes the device pixel ratio
+	const QTransform t(painter->deviceTransform());
+	const qreal scale = qSqrt(t.m11() * t.m11() + t.m12() * t.m12());
+	const QSize size((bounds.size() * scale).toSize());
+	if (size.isEmpty())
+		return;
+
+	const QString key(QString("GraphicsPiece:%1:%2:%3x%4")
+			  .arg(quintptr(renderer))
+			  .arg(elementId)
+			  .arg(size.width())
+			  .arg(size.height()));
+	QPixmap sprite;
+	if (!QPixmapCache::find(key, &sprite))
+	{
+		sprite = QPixmap(size);
+		sprite.fill(Qt::transparent);
+
+		QPainter spritePainter(&sprite);
+		spritePainter.setRenderHints(painter->renderHints());
+		renderer->render(&spritePainter, elementId, QRectF(sprite.rect()));
+		spritePainter.end();
+
+		QPixmapCache::insert(key, sprite);
+	}
 
-	m_renderer->render(painter, m_elementId, bounds);
+	painter->drawPixmap(bounds, sprite, QRectF(sprite.rect()));
 }
 
 Chess::Piece GraphicsPiece::pieceType() const
@@ -31,6 +31,10 @@ class QSvgRenderer;
  * Graphics (SVG) are used to ensure that the pieces look good
  * at any resolution, and a shared SVG renderer is used.
  *
+ * The SVG picture is rendered once for each size in device pixels
+ * and kept in QPixmapCache, so all the pieces of the same type and
+ * size, also on different boards, are painted from the same pixmap.
+ *
  * For convenience reasons the boundingRect() of a piece should
  * be equal to that of a square on the chessboard.
  */
@@ -63,6 +67,18 @@ class GraphicsPiece : public QGraphicsObject
 				   const QStyleOptionGraphicsItem* option,
 				   QWidget* widget = nullptr);
 
+		/*!
+		 * Paints the picture \a elementId of \a renderer in the
+		 * middle of \a square with \a painter.
+		 *
+		 * The picture is taken from the shared cache, or rendered
+		 * and added to it.
+		 */
+		static void paintPicture(QPainter* painter,
+					 QSvgRenderer* renderer,
+					 const QString& elementId,
+					 const QRectF& square);
+
 		/*! Returns the type of the chess piece. */
 		Chess::Piece pieceType() const;
 		/*!
@@ -56,6 +56,9 @@ namespace Chess {
 		m_chessWinOK = false;
 		
 		m_chessClip = 0.2f;
+		m_useGrid = true;
+		m_pollTimeMs = 40;
+		m_source = nullptr;
 		
 		this->m_board = Chess::BoardFactory::create("standard");
 		//this->m_board_second = Chess::BoardFactory::create("standard");
@@ -192,6 +195,10 @@ namespace Chess {
 		// ̸СһЩ
 
 		//
+		// The piece pictures are saved again, reload the templates
+		m_MatHash.clear();
+		m_grid.clearTemplates();
+
 		m_Ready_LXset = true;
 		return this->SaveAllPiecePicture();
 	}
@@ -280,44 +287,99 @@ namespace Chess {
 		fillB90(pList->b90, pList->BPawnList, eBPawn);
 		fillB90(pList->b90, pList->BKingList, eBKing);
 
-		// getFen from B90
-
 		bool flip = false;
 		if (pList->BKingList[0].y > pList->RKingList[0].y) {
 			flip = true;
 		}
 
-		QString fen;
-		QChar c;
+		return GetFenFromB90(pList, flip);
+	}
+
+	bool Capture::GetFenFromB90(stLxBoard* pList, bool flip)
+	{
+		pList->fen = GridRecognizer::fenString(pList->b90, flip);
 
-		for (int rank = 0; rank <= 9; rank++) {
-			for (int file = 0; file <= 8; ) {
-				int s90 = file + rank * 9;
-				int chess = pList->b90[s90];
+		return true;
+	}
 
-				if (chess == 0) {
-					int len = 0;
-					for (; file <= 8 && pList->b90[file + rank * 9] == 0; file++) {
-						len++;
-					}
-					c = '0' + len;
-				}
-				else {
-					c = Qpiece_to_char(chess);
-					file++;
+	bool Capture::isGridRecognition() const
+	{
+		return m_useGrid;
+	}
+
+	void Capture::setGridRecognition(bool enabled)
+	{
+		m_useGrid = enabled;
+	}
+
+	void Capture::setFrameSource(FrameSource* source)
+	{
+		m_source = source;
+		m_connectedBoard_OK = false;
+		m_prevSignatures = cv::Mat();
+	}
+
+	bool Capture::loadGridTemplates()
+	{
+		m_grid.clearTemplates();
+		m_grid.setThreshold(m_precision);
+
+		try {
+			for (int piece = eBPawn; piece <= eRKing; piece++) {
+				QString name = m_LxInfo.m_PieceCatlog + "/" + GridRecognizer::templateName(piece);
+				cv::Mat templ = getTemplate(name);
+				if (templ.empty()) {
+					qWarning("loadGridTemplates: %s not found", qUtf8Printable(name));
+					return false;
 				}
-				fen += c;
+				m_grid.setTemplate(piece, templ);
 			}
-			fen += (rank < 9 ? '/' : ' ');
 		}
-		fen += (flip == false ? "w " : "b ");
-		fen += "- - 0 1";
-
-		pList->fen = fen;
+		catch (...) {
+			qWarning("loadGridTemplates: invalid piece picture");
+			m_grid.clearTemplates();
+			return false;
+		}
 
 		return true;
 	}
 
+	// Read every intersection of one screenshot, no per-piece search
+	bool Capture::GetLxBoardGrid(stLxBoard* pList)
+	{
+		if (!m_grid.hasTemplates() && !loadGridTemplates()) {
+			return false;
+		}
+		m_grid.setGrid(m_LxInfo.offx, m_LxInfo.offy, m_LxInfo.m_dx, m_LxInfo.m_dy);
+
+		if (!captureOne(nullptr, m_hwnd)) {
+			return false;
+		}
+
+		try {
+			if (!m_grid.recognize(m_image_source, pList->b90)) {
+				return false;
+			}
+		}
+		catch (...) {
+			qWarning("GetLxBoardGrid: recognition failed");
+			return false;
+		}
+
+		int bk = -1;
+		int rk = -1;
+		for (int s90 = 0; s90 < 90; s90++) {
+			if (pList->b90[s90] == eBKing) bk = s90;
+			else if (pList->b90[s90] == eRKing) rk = s90;
+		}
+		if (bk < 0) {
+			return false;  // no black king
+		}
+
+		bool flip = (rk >= 0 && bk / 9 > rk / 9);
+		return GetFenFromB90(pList, flip);
+	}
+
 	// ߳
 	void Capture::run() {
 
@@ -329,9 +391,6 @@ namespace Chess {
 		//	return;
 		//}
 
-		return;
-
-		//this->GetMoveFromBoard();
 		if (!isSolutionReady()) {	
 
 			SendMessageToMain("", "߷û׼ã");
@@ -339,23 +398,112 @@ namespace Chess {
 			return;
 		}
 
-		while (true) {
-			if (GetLxBoardChess()) {
+		if (!m_useGrid) {
+			QString lastFen;
+			while (!isInterruptionRequested()) {
+				if (GetLxBoardChess() && m_LxBoard[0].fen != lastFen) {
+					lastFen = this->m_LxBoard[0].fen;
+					SendFenToMain(lastFen);
+				}
+				QThread::msleep(m_sleepTimeMs);
+			}
+			return;
+		}
 
-				QString fen = this->m_LxBoard[0].fen;
-				SendFenToMain(fen);
+		while (!isInterruptionRequested()) {
+			// Read the whole board once
+			if (!GetLxBoardChess()) {
+				QThread::msleep(m_sleepTimeMs);
+				continue;
+			}
+
+			QString fen = this->m_LxBoard[0].fen;
+			m_board->setFenString(fen);
+			SendFenToMain(fen);
+
+			m_LxBoard[1] = m_LxBoard[0];
+			m_grid.signatures(m_image_source, m_prevSignatures);
+
+			// Then only look at the intersections that change
+			while (!isInterruptionRequested()) {
+				QVector<int> changed;
+				if (!UpdateLxBoard(changed)) {
+					break;
+				}
+
+				// Wait until the pieces stop moving
+				if (!changed.isEmpty()
+				||  memcmp(m_LxBoard[0].b90, m_LxBoard[1].b90, sizeof(m_LxBoard[0].b90)) == 0) {
+					continue;
+				}
+
+				Chess::Move move = GetMoveFromBoard();
+				if (move.isNull()) {
+					break;  // not one legal move, read the board again
+				}
+
+				m_board->makeMove(move);
+				memcpy(m_LxBoard[0].b90, m_LxBoard[1].b90, sizeof(m_LxBoard[0].b90));
+				SendMoveToMain(move);
 			}
 		}
 	}
 
+	// Capture one frame and classify again the intersections that changed
+	bool Capture::UpdateLxBoard(QVector<int>& changed)
+	{
+		changed.clear();
+
+		if (!captureOne(nullptr, m_hwnd, false, m_pollTimeMs)) {
+			return false;
+		}
+
+		cv::Mat signatures;
+		try {
+			m_grid.signatures(m_image_source, signatures);
+			changed = m_grid.changedSquares(m_prevSignatures, signatures);
+
+			stLxBoard* pList = &m_LxBoard[1];
+			for (int s90 : changed) {
+				pList->b90[s90] = m_grid.classify(m_image_source, s90);
+			}
+		}
+		catch (...) {
+			qWarning("UpdateLxBoard: recognition failed");
+			return false;
+		}
+
+		m_prevSignatures = signatures;
+		return true;
+	}
+
+	// Square name in the FEN from GetFenFromB90, the top row is rank 9
+	QString Capture::squareName(int s90)
+	{
+		return QString("%1%2").arg(QChar('a' + s90 % 9)).arg(9 - s90 / 9);
+	}
+
+	// The move from the last sent board (m_LxBoard[0]) to the current one
 	Chess::Move Capture::GetMoveFromBoard()
 	{
-		//while (true)
-		//{
-		//	this->GetLxBoardChess();
-		//}
-		
-		return Chess::Move();
+		const int* before = m_LxBoard[0].b90;
+		const int* after = m_LxBoard[1].b90;
+
+		int from = -1;
+		int to = -1;
+		int count = 0;
+		for (int s90 = 0; s90 < 90; s90++) {
+			if (before[s90] == after[s90]) continue;
+			count++;
+			if (after[s90] == 0) from = s90;
+			else to = s90;
+		}
+
+		if (count != 2 || from < 0 || to < 0 || after[to] != before[from]) {
+			return Chess::Move();
+		}
+
+		return m_board->moveFromString(squareName(from) + squareName(to));
 	}
 
 	// ߳
@@ -388,6 +536,10 @@ namespace Chess {
 			pList = &m_LxBoard[0];
 		}
 
+		if (m_useGrid) {
+			return GetLxBoardGrid(pList);
+		}
+
 		if (!SearchOnChessList(m_hwnd, "bk.png", pList->BKingList, true)) {    // ڽ
 			return false;  // ҲԷĽ
 		}
@@ -512,27 +664,7 @@ namespace Chess {
 
 			//QString hashName = "aff"; // getHashName(findName);
 
-			if (this->m_MatHash.contains(findName)) {              // ڻ
-				image_template_scaled = this->m_MatHash.value(findName);
-			}
-			else {
-				QString fFile = this->getFindPath() + findName;
-				cv::Mat image_template = cv::imread(fFile.toStdString());   // ģͼ
-
-
-				cv::resize(image_template, image_template_scaled, cv::Size(), this->m_scaleX, this->m_scaleY);
-
-
-				// ٲһ£Ϊб߿		
-
-				int w = image_template_scaled.rows;
-				int h = image_template_scaled.cols;
-				float s = this->m_chessClip;
-				cv::Rect crect(w * s, h * s, w * (1 - 2 * s), h * (1 - 2 * s));
-				image_template_scaled = image_template_scaled(crect);
-
-				this->m_MatHash.insert(findName, image_template_scaled);
-			}
+			image_template_scaled = getTemplate(findName);
 
 
 			//QString fFile = this->getFindPath() + findName;
@@ -667,9 +799,21 @@ namespace Chess {
 
 			QThread::msleep(sleepTimeMS);
 
-			QScreen* screen = QGuiApplication::primaryScreen();
-
-			this->m_capPixmap = screen->grabWindow(WId(hw));
+			if (m_source != nullptr) {  // a recording instead of the window
+				if (!m_source->grab(this->m_image_source)) {
+					return false;
+				}
+				QImage image(m_image_source.data, m_image_source.cols, m_image_source.rows,
+					int(m_image_source.step), QImage::Format_RGB888);
+				this->m_capPixmap = QPixmap::fromImage(image.rgbSwapped());
+			}
+			else {
+				m_screen.setWindow(WId(hw));
+				if (!m_screen.grab(this->m_image_source)) {
+					return false;
+				}
+				this->m_capPixmap = m_screen.pixmap();
+			}
 
 			//fname = "tmp2.png";
 			if (fname != nullptr) {
@@ -686,7 +830,6 @@ namespace Chess {
 			cv::mixChannels(&mat, 1, &m_image_source, 1, from_to, 3);
 			*/
 
-			this->m_image_source = QPixmapToCvMat(this->m_capPixmap, true);
 
 			if (this->m_Ready_LXset) {  // ǰϢOK
 
@@ -714,6 +857,15 @@ namespace Chess {
 
 	bool Capture::getChessboardHwnd(bool onlyBChe)
 	{
+		if (m_source != nullptr) {  // a recording has no windows
+			if (!isChessBoardWindow(nullptr, &m_LxBoard[0], onlyBChe)) {
+				return false;
+			}
+			this->m_hwnd = nullptr;
+			this->m_connectedBoard_OK = true;
+			return true;
+		}
+
 		HWND hw = first_window();
 		while (hw != nullptr)
 		{
@@ -817,6 +969,33 @@ namespace Chess {
 		return searchImage(hwnd, chessFile, res, nullptr, isCap);
 	}
 
+	// Scaled and clipped piece template, cached by name
+	cv::Mat Capture::getTemplate(QString findName)
+	{
+		if (this->m_MatHash.contains(findName)) {
+			return this->m_MatHash.value(findName);
+		}
+
+		QString fFile = this->getFindPath() + findName;
+		cv::Mat image_template = cv::imread(fFile.toStdString());
+		if (image_template.empty()) {
+			return cv::Mat();
+		}
+
+		cv::Mat image_template_scaled;
+		cv::resize(image_template, image_template_scaled, cv::Size(), this->m_scaleX, this->m_scaleY);
+
+		// Clip the border of the piece
+		int w = image_template_scaled.rows;
+		int h = image_template_scaled.cols;
+		float s = this->m_chessClip;
+		cv::Rect crect(w * s, h * s, w * (1 - 2 * s), h * (1 - 2 * s));
+		image_template_scaled = image_template_scaled(crect);
+
+		this->m_MatHash.insert(findName, image_template_scaled);
+		return image_template_scaled;
+	}
+
 	bool Capture::isChessBoardWindow(HWND hwnd, stLxBoard* pieceList, bool onlyBche)
 	{
 		// +cname	Qt5QWindowIcon	QString
@@ -12,6 +12,8 @@
 #include <board/board.h>
 #include <board/boardfactory.h>
 #include <chessgame.h>
+#include "framesource.h"
+#include "gridrecognizer.h"
 
 struct stCaptureMsg {
 
@@ -105,6 +107,16 @@ namespace Chess {
 
 		bool GetFen(stLxBoard* pList);
 
+		// Read the board from the 90 intersections instead of searching
+		// the whole screenshot for every piece
+		bool isGridRecognition() const;
+		void setGridRecognition(bool enabled);
+
+		// Read frames from source (eg. a recording) instead of the
+		// chessboard window. The source is not owned, nullptr restores
+		// the window.
+		void setFrameSource(FrameSource* source);
+
 		Chess::Move GetMoveFromBoard();
 
 		void on_start();
@@ -125,6 +137,11 @@ namespace Chess {
 
 		int getB90(cv::Point p);
 		bool fillB90(int b90[], QVector<cv::Point>& plist, int chess);
+		bool GetFenFromB90(stLxBoard* pList, bool flip);
+		bool GetLxBoardGrid(stLxBoard* pList);
+		bool loadGridTemplates();
+		bool UpdateLxBoard(QVector<int>& changed);
+		QString squareName(int s90);
 
 		bool getChessboardHwnd(bool onlyBChe = false);
 		bool  SaveAllPiecePicture();  // õеϢ
@@ -161,6 +178,7 @@ namespace Chess {
 		void initBoard();
 
 		bool SearchOnChessList(HWND hwnd, QString chess, QVector<cv::Point>& res, bool IsCap = false);
+		cv::Mat getTemplate(QString findName);
 
 		//QImageתΪMat
 		cv::Mat QImageToCvMat(const QImage& inImage, bool inCloneImageData = true);
@@ -188,6 +206,12 @@ namespace Chess {
 		float m_chessClip;   // ӵı߲üһЩ
 
 		QHash<QString, cv::Mat> m_MatHash;
+		GridRecognizer m_grid;
+		bool m_useGrid;
+		cv::Mat m_prevSignatures;   // intersection thumbnails of the last frame
+		ScreenFrameSource m_screen;
+		FrameSource* m_source;
+		int m_pollTimeMs;           // frame interval while following a game
 		QPixmap m_capPixmap;      // ʱץͼ
 		cv::Mat m_image_source;   // תõͼ
 
@@ -20,16 +20,32 @@
 
 #include "evalhistory.h"
 #include <QVBoxLayout>
+#include <QTimer>
 #include <QtGlobal>
+#include <algorithm>
 #include <qcustomplot.h>
 #include <chessgame.h>
 #include <moveevaluation.h>
 
+namespace {
+
+// Minimum time between two replots of new scores, in milliseconds
+const int s_replotInterval = 100;
+
+} // anonymous namespace
+
 EvalHistory::EvalHistory(QWidget *parent)
 	: QWidget(parent),
 	  m_plot(new QCustomPlot(this)),
-	  m_game(nullptr)
+	  m_game(nullptr),
+	  m_replotTimer(new QTimer(this)),
+	  m_maxPly(-1),
+	  m_buckets(0)
 {
+	m_replotTimer->setSingleShot(true);
+	m_replotTimer->setInterval(s_replotInterval);
+	connect(m_replotTimer, SIGNAL(timeout()), this, SLOT(updatePlot()));
+
 	auto x = m_plot->xAxis;
 	auto y = m_plot->yAxis;
 	auto ticker = new QCPAxisTickerFixed;
@@ -66,7 +82,14 @@ void EvalHistory::setGame(ChessGame* game)
 	if (m_game)
 		m_game->disconnect(this);
 	m_game = game;
+	m_replotTimer->stop();
 	m_plot->clearGraphs();
+	for (int i = 0; i < 2; i++)
+	{
+		m_keys[i].clear();
+		m_values[i].clear();
+	}
+	m_maxPly = -1;
 	if (!game)
 	{
 		replot(0);
@@ -117,14 +140,23 @@ void EvalHistory::setScores(const QMap< int, int >& scores)
 	cBlack.setAlpha(100);
 	m_plot->graph(1)->setBrush(QBrush(cBlack));
 
-	int ply = -1;
+	for (int i = 0; i < 2; i++)
+	{
+		m_keys[i].clear();
+		m_values[i].clear();
+		m_keys[i].reserve(scores.size() / 2 + 1);
+		m_values[i].reserve(scores.size() / 2 + 1);
+	}
+	m_maxPly = -1;
 
 	for (auto it = scores.constBegin(); it != scores.constEnd(); ++it)
 	{
-		ply = it.key();
-		addData(ply, it.value());
+		m_maxPly = it.key();
+		addData(m_maxPly, it.value());
 	}
-	replot(ply);
+
+	m_replotTimer->stop();
+	updatePlot();
 }
 
 void EvalHistory::addData(int ply, int score)
@@ -138,7 +170,111 @@ void EvalHistory::addData(int ply, int score)
 	if (side == 1)
 		y = -y;
 
-	m_plot->graph(side)->addData(x, y);
+	// The scores usually come in order, but a ply may be scored again
+	QVector<double>& keys = m_keys[side];
+	QVector<double>& values = m_values[side];
+	if (keys.isEmpty() || keys.last() < x)
+	{
+		keys.append(x);
+		values.append(y);
+		return;
+	}
+
+	auto it = std::lower_bound(keys.begin(), keys.end(), x);
+	int index = int(it - keys.begin());
+	if (*it == x)
+		values[index] = y;
+	else
+	{
+		keys.insert(index, x);
+		values.insert(index, y);
+	}
+}
+
+void EvalHistory::decimate(const QVector<double>& keys,
+			   const QVector<double>& values,
+			   int buckets,
+			   QVector<double>* decimatedKeys,
+			   QVector<double>* decimatedValues)
+{
+	Q_ASSERT(keys.size() == values.size());
+	Q_ASSERT(decimatedKeys != nullptr);
+	Q_ASSERT(decimatedValues != nullptr);
+
+	const int count = keys.size();
+	buckets = qMax(buckets, 1);
+	if (count <= 2 * buckets)
+	{
+		*decimatedKeys = keys;
+		*decimatedValues = values;
+		return;
+	}
+
+	decimatedKeys->clear();
+	decimatedValues->clear();
+	decimatedKeys->reserve(2 * buckets);
+	decimatedValues->reserve(2 * buckets);
+
+	for (int bucket = 0; bucket < buckets; bucket++)
+	{
+		const int begin = int(qint64(count) * bucket / buckets);
+		const int end = int(qint64(count) * (bucket + 1) / buckets);
+		int min = begin;
+		int max = begin;
+		for (int i = begin + 1; i < end; i++)
+		{
+			if (values.at(i) < values.at(min))
+				min = i;
+			if (values.at(i) > values.at(max))
+				max = i;
+		}
+
+		const int first = qMin(min, max);
+		const int second = qMax(min, max);
+		decimatedKeys->append(keys.at(first));
+		decimatedValues->append(values.at(first));
+		if (second != first)
+		{
+			decimatedKeys->append(keys.at(second));
+			decimatedValues->append(values.at(second));
+		}
+	}
+}
+
+void EvalHistory::updateGraphs()
+{
+	if (m_plot->graphCount() < 2)
+		return;
+
+	// One bucket per pixel
+	const int buckets = qMax(1, m_plot->width());
+	m_buckets = buckets;
+	QVector<double> keys;
+	QVector<double> values;
+	for (int i = 0; i < 2; i++)
+	{
+		decimate(m_keys[i], m_values[i], buckets, &keys, &values);
+		m_plot->graph(i)->setData(keys, values, true);
+	}
+}
+
+void EvalHistory::updatePlot()
+{
+	updateGraphs();
+	replot(m_maxPly);
+}
+
+void EvalHistory::resizeEvent(QResizeEvent* event)
+{
+	QWidget::resizeEvent(event);
+
+	// The decimation changes if a series is longer than two points
+	// per bucket at either the old or the new width
+	const int buckets = qMax(1, m_plot->width());
+	const int count = qMax(m_keys[0].size(), m_keys[1].size());
+	if (buckets != m_buckets && count > 2 * qMin(buckets, m_buckets)
+	&&  !m_replotTimer->isActive())
+		m_replotTimer->start();
 }
 
 void EvalHistory::replot(int maxPly)
@@ -163,6 +299,11 @@ void EvalHistory::replot(int maxPly)
 
 void EvalHistory::onScore(int ply, int score)
 {
+	if (m_plot->graphCount() < 2)
+		return;
+
 	addData(ply, score);
-	replot(ply);
+	m_maxPly = qMax(m_maxPly, ply);
+	if (!m_replotTimer->isActive())
+		m_replotTimer->start();
 }
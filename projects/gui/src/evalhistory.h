@@ -21,8 +21,10 @@
 
 #include <QWidget>
 #include <QPointer>
+#include <QVector>
 
 class QCustomPlot;
+class QTimer;
 class ChessGame;
 class PgnGame;
 
@@ -31,6 +33,10 @@ class PgnGame;
  *
  * The fullmove number is on the X axis and score (from white's
  * perspective) is on the Y axis.
+ *
+ * New scores are collected and plotted at most a few times per
+ * second, and a series with more points than the plot is wide is
+ * decimated before plotting.
  */
 class EvalHistory : public QWidget
 {
@@ -47,16 +53,45 @@ class EvalHistory : public QWidget
 		/*! Sets evaluation history from PGN game (pointer) \a pgn */
 		void setPgnGame(PgnGame *pgn);
 
+		/*!
+		 * Decimates the series of \a keys and \a values to at most
+		 * two points per bucket.
+		 *
+		 * The points are split into \a buckets runs of consecutive
+		 * points, and the lowest and the highest value of each run
+		 * are kept in their original order, so peaks aren't lost.
+		 * If there are at most two points per bucket, the series is
+		 * copied as is. The keys must be in ascending order.
+		 */
+		static void decimate(const QVector<double>& keys,
+				     const QVector<double>& values,
+				     int buckets,
+				     QVector<double>* decimatedKeys,
+				     QVector<double>* decimatedValues);
+
+	protected:
+		// Inherited from QWidget
+		virtual void resizeEvent(QResizeEvent* event);
+
 	private slots:
 		void onScore(int ply, int score);
+		void updatePlot();
 
 	private:
 		void addData(int ply, int score);
 		void replot(int maxPly);
 		void setScores(const QMap<int, int> &scores);
+		void updateGraphs();
 
 		QCustomPlot* m_plot;
 		QPointer<ChessGame> m_game;
+		QTimer* m_replotTimer;
+		// Every score of both sides, the graphs may be decimated
+		QVector<double> m_keys[2];
+		QVector<double> m_values[2];
+		int m_maxPly;
+		// The bucket count of the last decimation
+		int m_buckets;
 };
 
 #endif // EVALHISTORY_H
@@ -0,0 +1,150 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "framesource.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QScreen>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+namespace Chess {
+
+FrameSource::~FrameSource()
+{
+}
+
+QString FrameSource::frameName() const
+{
+	return QString();
+}
+
+cv::Mat FrameSource::imageToMat(const QImage& image)
+{
+	if (image.isNull())
+		return cv::Mat();
+
+	QImage rgb(image.convertToFormat(QImage::Format_RGB888));
+	cv::Mat mat(rgb.height(), rgb.width(), CV_8UC3,
+		    const_cast<uchar*>(rgb.constBits()),
+		    static_cast<size_t>(rgb.bytesPerLine()));
+
+	cv::Mat bgr;
+	cv::cvtColor(mat, bgr, cv::COLOR_RGB2BGR);
+	return bgr;
+}
+
+
+ScreenFrameSource::ScreenFrameSource(WId window)
+	: m_window(window)
+{
+}
+
+WId ScreenFrameSource::window() const
+{
+	return m_window;
+}
+
+void ScreenFrameSource::setWindow(WId window)
+{
+	m_window = window;
+}
+
+QPixmap ScreenFrameSource::pixmap() const
+{
+	return m_pixmap;
+}
+
+bool ScreenFrameSource::grab(cv::Mat& frame)
+{
+	QScreen* screen = QGuiApplication::primaryScreen();
+	if (screen == nullptr)
+		return false;
+
+	m_pixmap = screen->grabWindow(m_window);
+	frame = imageToMat(m_pixmap.toImage());
+	return !frame.empty();
+}
+
+
+ReplayFrameSource::ReplayFrameSource(const QString& path)
+	: m_path(path),
+	  m_video(nullptr),
+	  m_frame(-1)
+{
+	QFileInfo info(path);
+	if (info.isDir())
+	{
+		QDir dir(path);
+		const QStringList files = dir.entryList(
+			QStringList() << "*.png" << "*.bmp" << "*.jpg",
+			QDir::Files, QDir::Name);
+		for (const QString& file : files)
+			m_files << dir.filePath(file);
+	}
+	else
+		m_video = new cv::VideoCapture(path.toStdString());
+}
+
+ReplayFrameSource::~ReplayFrameSource()
+{
+	delete m_video;
+}
+
+bool ReplayFrameSource::isOpen() const
+{
+	if (m_video != nullptr)
+		return m_video->isOpened();
+	return !m_files.isEmpty();
+}
+
+void ReplayFrameSource::rewind()
+{
+	m_frame = -1;
+	if (m_video != nullptr)
+		m_video->set(cv::CAP_PROP_POS_FRAMES, 0);
+}
+
+bool ReplayFrameSource::grab(cv::Mat& frame)
+{
+	if (m_video != nullptr)
+	{
+		if (!m_video->read(frame))
+			return false;
+		m_frame++;
+		return true;
+	}
+
+	if (m_frame + 1 >= m_files.size())
+		return false;
+	m_frame++;
+	frame = cv::imread(m_files.at(m_frame).toStdString());
+	return !frame.empty();
+}
+
+QString ReplayFrameSource::frameName() const
+{
+	if (m_frame < 0)
+		return QString();
+	if (m_video != nullptr)
+		return QString("%1:%2").arg(QFileInfo(m_path).fileName()).arg(m_frame);
+	return m_files.at(m_frame);
+}
+
+} // namespace Chess
@@ -0,0 +1,120 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FRAMESOURCE_H
+#define FRAMESOURCE_H
+
+#include <QString>
+#include <QStringList>
+#include <QPixmap>
+#include <QWindow>
+#include <opencv2/core.hpp>
+
+namespace cv { class VideoCapture; }
+
+namespace Chess {
+
+/*!
+ * \brief A source of board screenshots
+ *
+ * Capture reads the board from the frames of a FrameSource, so the
+ * recognition works the same on a live window and on a recording.
+ * Frames are 8-bit BGR images like the ones cv::imread() returns.
+ */
+class FrameSource
+{
+	public:
+		/*! Destroys the frame source. */
+		virtual ~FrameSource();
+
+		/*!
+		 * Stores the next frame in \a frame.
+		 *
+		 * Returns false if there are no more frames or the frame
+		 * can't be read.
+		 */
+		virtual bool grab(cv::Mat& frame) = 0;
+		/*! Returns a name for the last grabbed frame. */
+		virtual QString frameName() const;
+
+		/*! Returns \a image as an 8-bit BGR image. */
+		static cv::Mat imageToMat(const QImage& image);
+};
+
+/*!
+ * \brief Frames from a window on the screen
+ *
+ * Uses QScreen::grabWindow(), which works with the Windows and X11
+ * (xcb) platform plugins. Wayland doesn't let applications grab the
+ * screen.
+ */
+class ScreenFrameSource : public FrameSource
+{
+	public:
+		/*!
+		 * Creates a source for \a window, or for the whole primary
+		 * screen if \a window is 0.
+		 */
+		explicit ScreenFrameSource(WId window = 0);
+
+		/*! Returns the grabbed window. */
+		WId window() const;
+		/*! Sets the grabbed window to \a window. */
+		void setWindow(WId window);
+		/*! Returns the last grabbed frame as a pixmap. */
+		QPixmap pixmap() const;
+
+		// Inherited from FrameSource
+		virtual bool grab(cv::Mat& frame);
+
+	private:
+		WId m_window;
+		QPixmap m_pixmap;
+};
+
+/*!
+ * \brief Frames from a recording
+ *
+ * A recording is either a directory of screenshots, read in file name
+ * order, or a video file read with cv::VideoCapture.
+ */
+class ReplayFrameSource : public FrameSource
+{
+	public:
+		/*! Creates a source for the recording at \a path. */
+		explicit ReplayFrameSource(const QString& path);
+		/*! Destroys the source. */
+		virtual ~ReplayFrameSource();
+
+		/*! Returns true if the recording could be opened. */
+		bool isOpen() const;
+		/*! Starts again from the first frame. */
+		void rewind();
+
+		// Inherited from FrameSource
+		virtual bool grab(cv::Mat& frame);
+		virtual QString frameName() const;
+
+	private:
+		QString m_path;
+		QStringList m_files;
+		cv::VideoCapture* m_video;
+		int m_frame;
+};
+
+} // namespace Chess
+#endif // FRAMESOURCE_H
@@ -32,6 +32,13 @@
 #include "boardview/boardview.h"
 #include "chessclock.h"
 
+namespace {
+
+// Plies between the saved positions that jumps start from
+const int s_keyframeInterval = 16;
+
+} // anonymous namespace
+
 GameViewer::GameViewer(Qt::Orientation orientation,
                        QWidget* parent,
                        bool addChessClock)
@@ -41,7 +48,10 @@ GameViewer::GameViewer(Qt::Orientation orientation,
 	  m_viewPreviousMoveBtn(new QToolButton),
 	  m_viewNextMoveBtn(new QToolButton),
 	  m_viewLastMoveBtn(new QToolButton),
-	  m_moveIndex(0)
+	  m_moveIndex(0),
+	  m_sceneStartIndex(0),
+	  m_boardStartIndex(0),
+	  m_capturedPosition(false)
 {
 	#ifdef Q_OS_MAC
 	setStyleSheet("QToolButton:!hover { border: none; }");
@@ -147,6 +157,55 @@ void GameViewer::viewPreviousMove2(Chess::Board* orgBoard)
 	//orgBoard->initialize();
 	m_boardScene->setBoard(orgBoard->copy());
 	m_boardScene->populate();
+
+	// The scene has no history to undo
+	m_sceneStartIndex = m_moveIndex;
+	m_capturedPosition = true;
+	updateControls();
+}
+
+bool GameViewer::syncCapturedFen(Chess::Board* board, const QString& fen)
+{
+	Q_ASSERT(board != nullptr);
+
+	// The captured FEN only tells the placement of the pieces
+	const QString placement(fen.section(' ', 0, 0));
+	const QString oldPlacement(board->fenString().section(' ', 0, 0));
+
+	// Look for the legal move that leads to the new placement
+	Chess::Move move;
+	const auto moves = board->legalMoves();
+	for (const Chess::Move& legalMove : moves)
+	{
+		board->makeMove(legalMove);
+		bool found = board->fenString().section(' ', 0, 0) == placement;
+		board->undoMove();
+		if (found)
+		{
+			move = legalMove;
+			break;
+		}
+	}
+
+	// The move is animated if the scene shows the old position
+	Chess::Board* sceneBoard = m_boardScene->board();
+	if (!move.isNull() && sceneBoard != nullptr
+	&&  sceneBoard->fenString().section(' ', 0, 0) == oldPlacement)
+	{
+		Chess::GenericMove genericMove(board->genericMove(move));
+		board->makeMove(move);
+		m_boardScene->makeMove(genericMove);
+
+		// Undoing the captured move would leave the game's moves
+		m_sceneStartIndex = m_moveIndex;
+		m_capturedPosition = true;
+		updateControls();
+		return true;
+	}
+
+	board->setFenString(fen);
+	viewPreviousMove2(board);
+	return false;
 }
 
 //void GameViewer::copyBoard(Chess::Board* orgBoard)
@@ -164,8 +223,12 @@ void GameViewer::setGame(ChessGame* game)
 {
 	Q_ASSERT(game != nullptr);
 
-	setGame(game->pgn());
+	// The game must be set before jumping to the last position,
+	// which is replayed from the start of a game in progress
+	disconnectGame();
 	m_game = game;
+	loadGame(game->pgn());
+	viewLastMove();
 
 	connect(m_game, SIGNAL(fenChanged(QString)),
 		this, SLOT(onFenChanged(QString)));
@@ -193,10 +256,17 @@ void GameViewer::setGame(const PgnGame* pgn)
 	Q_ASSERT(pgn != nullptr);
 
 	disconnectGame();
+	loadGame(pgn);
+	viewLastMove();
+}
 
+void GameViewer::loadGame(const PgnGame* pgn)
+{
+	m_keyframes.clear();
 	auto board = pgn->createBoard();
 	if (board)
 	{
+		m_keyframes << board->fenString();
 		m_boardScene->setBoard(board);
 		m_boardScene->populate();
 	}
@@ -207,6 +277,9 @@ void GameViewer::setGame(const PgnGame* pgn)
 			tr("This game is incompatible with Cute Chess and cannot be shown."));
 	}
 	m_moveIndex = 0;
+	m_sceneStartIndex = 0;
+	m_boardStartIndex = 0;
+	m_capturedPosition = false;
 
 	m_moves.clear();
 	for (const PgnGame::MoveData& md : pgn->moves())
@@ -220,8 +293,6 @@ void GameViewer::setGame(const PgnGame* pgn)
 	m_moveNumberSlider->setEnabled(!m_moves.isEmpty());
 	m_moveNumberSlider->setMaximum(m_moves.count());
 	m_moveNumberSlider->setValue(0);
-
-	viewLastMove();
 }
 
 void GameViewer::disconnectGame()
@@ -262,8 +333,7 @@ void GameViewer::viewFirstMoveClicked()
 
 void GameViewer::viewFirstMove()
 {
-	while (m_moveIndex > 0)
-		viewPreviousMove();
+	viewPosition(0);
 }
 
 void GameViewer::viewPreviousMoveClicked()
@@ -274,21 +344,23 @@ void GameViewer::viewPreviousMoveClicked()
 
 void GameViewer::viewPreviousMove()
 {
-	m_moveIndex--;
+	// The captured position follows the game's current position
+	if (m_capturedPosition)
+	{
+		jumpToPosition(m_moveIndex);
+		return;
+	}
 
-	if (m_moveIndex == 0)
+	// The scene can't undo moves made before its last repopulation
+	if (m_moveIndex <= m_sceneStartIndex)
 	{
-		m_viewPreviousMoveBtn->setEnabled(false);
-		m_viewFirstMoveBtn->setEnabled(false);
+		jumpToPosition(m_moveIndex - 1);
+		return;
 	}
 
+	m_moveIndex--;
 	m_boardScene->undoMove();
-
-	m_viewNextMoveBtn->setEnabled(true);
-	m_viewLastMoveBtn->setEnabled(true);
-	m_boardView->setEnabled(false);
-
-	m_moveNumberSlider->setSliderPosition(m_moveIndex);
+	updateControls();
 }
 
 void GameViewer::viewNextMoveClicked()
@@ -299,22 +371,23 @@ void GameViewer::viewNextMoveClicked()
 
 void GameViewer::viewNextMove()
 {
-	m_boardScene->makeMove(m_moves.at(m_moveIndex++));
-
-	m_viewPreviousMoveBtn->setEnabled(true);
-	m_viewFirstMoveBtn->setEnabled(true);
-
-	if (m_moveIndex >= m_moves.count())
+	// The game's next move can't be made in a captured position
+	if (m_capturedPosition)
 	{
-		m_viewNextMoveBtn->setEnabled(false);
-		m_viewLastMoveBtn->setEnabled(false);
+		jumpToPosition(qMin(m_moveIndex + 1, m_moves.count()));
+		return;
+	}
 
-		if (!m_game.isNull()
-		&&  !m_game->isFinished() && m_game->playerToMove()->isHuman())
-			m_boardView->setEnabled(true);
+	// The last position of a game in progress needs the whole history
+	if (m_moveIndex + 1 == m_moves.count() && m_boardStartIndex > 0
+	&&  !m_game.isNull() && !m_game->isFinished())
+	{
+		jumpToPosition(m_moveIndex + 1);
+		return;
 	}
 
-	m_moveNumberSlider->setSliderPosition(m_moveIndex);
+	m_boardScene->makeMove(m_moves.at(m_moveIndex++));
+	updateControls();
 }
 
 void GameViewer::viewLastMoveClicked()
@@ -325,8 +398,7 @@ void GameViewer::viewLastMoveClicked()
 
 void GameViewer::viewLastMove()
 {
-	while (m_moveIndex < m_moves.count())
-		viewNextMove();
+	viewPosition(m_moves.count());
 }
 
 void GameViewer::viewPositionClicked(int index)
@@ -337,13 +409,82 @@ void GameViewer::viewPositionClicked(int index)
 
 void GameViewer::viewPosition(int index)
 {
-	if (m_moves.isEmpty())
+	// A captured position is left by jumping to the game's position
+	if (m_capturedPosition)
+	{
+		jumpToPosition(index);
+		return;
+	}
+	if (m_moves.isEmpty() || index == m_moveIndex)
 		return;
 
-	while (index < m_moveIndex)
-		viewPreviousMove();
-	while (index > m_moveIndex)
+	// Single steps are animated, longer ones jump
+	if (index == m_moveIndex + 1)
 		viewNextMove();
+	else if (index == m_moveIndex - 1)
+		viewPreviousMove();
+	else
+		jumpToPosition(index);
+}
+
+void GameViewer::jumpToPosition(int index)
+{
+	Q_ASSERT(index >= 0 && index <= m_moves.count());
+
+	Chess::Board* board = m_boardScene->board();
+	if (board == nullptr || m_keyframes.isEmpty())
+		return;
+
+	// A human player needs the whole history of the game, eg. to
+	// tell repetitions, so the last position is replayed from the
+	// start of a game in progress
+	int keyframe = index / s_keyframeInterval;
+	if (index == m_moves.count()
+	&&  !m_game.isNull() && !m_game->isFinished())
+		keyframe = 0;
+	else
+		updateKeyframes(index);
+
+	board->setFenString(m_keyframes.at(keyframe));
+	for (int i = keyframe * s_keyframeInterval; i < index; i++)
+		board->makeMove(board->moveFromGenericMove(m_moves.at(i)));
+	m_boardScene->populate();
+
+	m_moveIndex = index;
+	m_sceneStartIndex = index;
+	m_boardStartIndex = keyframe * s_keyframeInterval;
+	m_capturedPosition = false;
+	updateControls();
+}
+
+void GameViewer::updateKeyframes(int index)
+{
+	Chess::Board* board = m_boardScene->board();
+	while (m_keyframes.size() <= index / s_keyframeInterval)
+	{
+		int start = (m_keyframes.size() - 1) * s_keyframeInterval;
+		board->setFenString(m_keyframes.last());
+		for (int i = start; i < start + s_keyframeInterval; i++)
+			board->makeMove(board->moveFromGenericMove(m_moves.at(i)));
+		m_keyframes << board->fenString();
+	}
+}
+
+void GameViewer::updateControls()
+{
+	bool atStart = m_moveIndex <= 0;
+	bool atEnd = m_moveIndex >= m_moves.count();
+
+	m_viewFirstMoveBtn->setEnabled(!atStart || m_capturedPosition);
+	m_viewPreviousMoveBtn->setEnabled(!atStart || m_capturedPosition);
+	m_viewNextMoveBtn->setEnabled(!atEnd || m_capturedPosition);
+	m_viewLastMoveBtn->setEnabled(!atEnd || m_capturedPosition);
+
+	m_boardView->setEnabled(atEnd && !m_game.isNull()
+				&& !m_game->isFinished()
+				&& m_game->playerToMove()->isHuman());
+
+	m_moveNumberSlider->setSliderPosition(m_moveIndex);
 }
 
 void GameViewer::viewMove(int index, bool keyLeft)
@@ -351,20 +492,15 @@ void GameViewer::viewMove(int index, bool keyLeft)
 	Q_ASSERT(index >= 0);
 	Q_ASSERT(!m_moves.isEmpty());
 
-	if (keyLeft && index == m_moveIndex - 2)
+	if (keyLeft && index == m_moveIndex - 2 && !m_capturedPosition)
 		viewPreviousMove();
-	else if (index < m_moveIndex)
-	{
-		// We backtrack one move too far and then make one
-		// move forward to highlight the correct move
-		while (index < m_moveIndex)
-			viewPreviousMove();
-		viewNextMove();
-	}
 	else
 	{
-		while (index + 1 > m_moveIndex)
-			viewNextMove();
+		// We go to the position before the move and then make
+		// the move to highlight it
+		if (index != m_moveIndex)
+			viewPosition(index);
+		viewNextMove();
 	}
 }
 
@@ -372,6 +508,10 @@ void GameViewer::onFenChanged(const QString& fen)
 {
 	m_moves.clear();
 	m_moveIndex = 0;
+	m_sceneStartIndex = 0;
+	m_boardStartIndex = 0;
+	m_capturedPosition = false;
+	m_keyframes = QStringList() << fen;
 
 	m_viewFirstMoveBtn->setEnabled(false);
 	m_viewPreviousMoveBtn->setEnabled(false);
@@ -21,6 +21,7 @@
 
 #include <QWidget>
 #include <QVector>
+#include <QStringList>
 #include <QPointer>
 #include <board/side.h>
 #include <board/genericmove.h>
@@ -55,6 +56,17 @@ class GameViewer : public QWidget
 		//void copyBoard(Chess::Board* orgBoard);   // Ӹƹ
 
 		void viewPreviousMove2(Chess::Board* orgBoard);
+		/*!
+		 * Updates \a board, the board of the game in progress, to
+		 * the captured position \a fen and shows it.
+		 *
+		 * The captured position isn't one of the game's moves, so
+		 * the move buttons leave it by jumping to a game position.
+		 * Returns true if the position was reached with a legal
+		 * move, which is animated; otherwise the board is
+		 * repopulated.
+		 */
+		bool syncCapturedFen(Chess::Board* board, const QString& fen);
 
 	public slots:
 		void viewMove(int index, bool keyLeft = false);
@@ -78,6 +90,10 @@ class GameViewer : public QWidget
 		void viewNextMove();
 		void viewLastMove();
 		void viewPosition(int index);
+		void jumpToPosition(int index);
+		void loadGame(const PgnGame* pgn);
+		void updateKeyframes(int index);
+		void updateControls();
 
 		BoardScene* m_boardScene;
 		BoardView* m_boardView;
@@ -92,6 +108,14 @@ class GameViewer : public QWidget
 		QPointer<ChessGame> m_game;
 		QVector<Chess::GenericMove> m_moves;
 		int m_moveIndex;
+		// FEN strings of the positions every s_keyframeInterval plies
+		QStringList m_keyframes;
+		// The position where the scene's undo history begins
+		int m_sceneStartIndex;
+		// The position where the board's move history begins
+		int m_boardStartIndex;
+		// True if the scene shows a captured position
+		bool m_capturedPosition;
 };
 
 #endif // GAMEVIEWER_H
@@ -5,17 +5,46 @@
 #include "gamewall.h"
 
 #include <QPointer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollArea>
+#include <QSettings>
+#include <QTime>
+#include <QTimer>
+#include <QVBoxLayout>
 
 #include <chessplayer.h>
 #include <chessgame.h>
 #include <gamemanager.h>
+#include <pgngame.h>
+#include <timecontrol.h>
+#include <board/board.h>
 
 #include "tilelayout.h"
 #include "boardview/boardscene.h"
 #include "boardview/boardview.h"
+#include "boardview/graphicsboard.h"
+#include "boardview/graphicspiece.h"
 #include "chessclock.h"
 #include "cutechessapp.h"
 
+namespace {
+
+// The board views are used for up to this many concurrent games
+const int s_maxWidgetGames = 8;
+// Time between the frames of the painted wall, in milliseconds
+const int s_frameInterval = 50;
+// Minimum width of a board on the painted wall
+const int s_minTileWidth = 180;
+// Height of the names and clocks above a board
+const int s_clockHeight = 18;
+// Square size of the board item that paints the wall's boards
+const qreal s_squareSize = 50;
+
+} // anonymous namespace
+
 
 class GameWallWidget : public QWidget
 {
@@ -122,12 +151,380 @@ void GameWallWidget::setGame(ChessGame* game)
 }
 
 
+/*
+ * Paints the boards of all the games in one widget.
+ *
+ * The game manager reports the moves of all the games in batches,
+ * which are applied to the boards as they arrive. The boards that
+ * changed are repainted once per frame, and only if they're visible.
+ */
+class GameWallCanvas : public QWidget
+{
+	Q_OBJECT
+
+	public:
+		GameWallCanvas(GameManager* manager, QWidget* parent);
+		virtual ~GameWallCanvas();
+
+		void addGame(ChessGame* game);
+		void removeGame(ChessGame* game);
+
+	protected:
+		// Inherited from QWidget
+		virtual void paintEvent(QPaintEvent* event);
+		virtual void resizeEvent(QResizeEvent* event);
+
+	private slots:
+		void onGameEvents(const QVector<GameManager::GameEvent>& events);
+		void onFrame();
+
+	private:
+		struct Tile
+		{
+			// The game on the board, or null if the board is free
+			ChessGame* key;
+			QPointer<ChessGame> game;
+			Chess::Board* board;
+			int ply;
+			bool flipped;
+			QString names[2];
+			bool infinite[2];
+			int timeLeft[2];
+			qint64 time;
+			QString result;
+			bool dirty;
+		};
+
+		void syncTile(Tile& tile);
+		void updateLayout();
+		QRect tileRect(int index) const;
+		QString clockText(const Tile& tile, int side) const;
+		void paintTile(QPainter* painter, const Tile& tile, const QRect& rect);
+
+		QVector<Tile> m_tiles;
+		QHash<ChessGame*, int> m_tileIndex;
+		QElapsedTimer m_clock;
+		qint64 m_lastClockTick;
+		QTimer* m_timer;
+		GraphicsBoard m_boardItem;
+		int m_columns;
+		QSize m_tileSize;
+};
+
+GameWallCanvas::GameWallCanvas(GameManager* manager, QWidget* parent)
+	: QWidget(parent),
+	  m_lastClockTick(0),
+	  m_timer(new QTimer(this)),
+	  m_boardItem(9, 10, s_squareSize),
+	  m_columns(1)
+{
+	setAttribute(Qt::WA_OpaquePaintEvent);
+	m_clock.start();
+
+	connect(manager, &GameManager::gameEvents,
+		this, &GameWallCanvas::onGameEvents);
+	connect(m_timer, SIGNAL(timeout()), this, SLOT(onFrame()));
+	m_timer->start(s_frameInterval);
+}
+
+GameWallCanvas::~GameWallCanvas()
+{
+	for (Tile& tile : m_tiles)
+		delete tile.board;
+}
+
+void GameWallCanvas::addGame(ChessGame* game)
+{
+	if (m_tileIndex.contains(game))
+		return;
+
+	// Reuse the board of a game that was removed
+	int index = 0;
+	while (index < m_tiles.size() && m_tiles.at(index).key != nullptr)
+		index++;
+	if (index == m_tiles.size())
+	{
+		Tile tile;
+		tile.board = nullptr;
+		m_tiles.append(tile);
+	}
+
+	Tile& tile = m_tiles[index];
+	tile.key = game;
+	tile.game = game;
+	m_tileIndex[game] = index;
+
+	// The game manager already reports the game's events, and the
+	// ones that happened before the snapshot are skipped
+	syncTile(tile);
+	updateLayout();
+}
+
+void GameWallCanvas::removeGame(ChessGame* game)
+{
+	int index = m_tileIndex.value(game, -1);
+	if (index == -1)
+		return;
+
+	// The last position stays on the wall until the board
+	// is taken by a new game
+	m_tileIndex.remove(game);
+	m_tiles[index].key = nullptr;
+	m_tiles[index].game = nullptr;
+}
+
+void GameWallCanvas::syncTile(Tile& tile)
+{
+	tile.dirty = true;
+	ChessGame* game = tile.game;
+	if (game == nullptr)
+		return;
+
+	game->lockThread();
+
+	delete tile.board;
+	tile.board = game->pgn()->createBoard();
+	if (tile.board != nullptr)
+	{
+		for (const Chess::Move& move : game->moves())
+			tile.board->makeMove(move);
+	}
+	tile.ply = game->moves().size();
+	tile.flipped = game->boardShouldBeFlipped();
+
+	for (int i = 0; i < 2; i++)
+	{
+		ChessPlayer* player = game->player(Chess::Side::Type(i));
+		tile.names[i] = player ? player->name() : QString();
+		tile.infinite[i] = !player || player->timeControl()->isInfinite();
+		tile.timeLeft[i] = 0;
+		if (player && player->state() == ChessPlayer::Thinking)
+			tile.timeLeft[i] = player->timeControl()->activeTimeLeft();
+		else if (player)
+			tile.timeLeft[i] = player->timeControl()->timeLeft();
+	}
+	tile.time = m_clock.elapsed();
+	tile.result = game->isFinished() ? game->result().toShortString()
+					 : QString();
+
+	game->unlockThread();
+}
+
+void GameWallCanvas::onGameEvents(const QVector<GameManager::GameEvent>& events)
+{
+	typedef GameManager::GameEvent GameEvent;
+
+	for (const GameEvent& event : events)
+	{
+		int index = m_tileIndex.value(event.game, -1);
+		if (index == -1)
+			continue;
+
+		Tile& tile = m_tiles[index];
+		tile.dirty = true;
+		if (event.type == GameEvent::MoveMade)
+		{
+			// The move is already in the tile's snapshot
+			if (event.ply <= tile.ply)
+				continue;
+
+			if (tile.board == nullptr || event.ply != tile.ply + 1)
+			{
+				syncTile(tile);
+				continue;
+			}
+			Chess::Move move(tile.board->moveFromGenericMove(event.move));
+			if (!tile.board->isLegalMove(move))
+			{
+				syncTile(tile);
+				continue;
+			}
+			tile.board->makeMove(move);
+			tile.ply = event.ply;
+			tile.timeLeft[0] = event.timeLeft[0];
+			tile.timeLeft[1] = event.timeLeft[1];
+			tile.time = event.time - m_clock.msecsSinceReference();
+		}
+		else if (event.type == GameEvent::PositionReset)
+			syncTile(tile);
+		else if (event.type == GameEvent::GameEnded)
+			tile.result = event.result;
+	}
+}
+
+void GameWallCanvas::onFrame()
+{
+	// The clocks are repainted once per second
+	bool tickClocks = m_clock.elapsed() - m_lastClockTick >= 1000;
+	if (tickClocks)
+		m_lastClockTick = m_clock.elapsed();
+
+	// Boards that aren't visible are painted when they're exposed
+	const QRect visible(visibleRegion().boundingRect());
+	for (int i = 0; i < m_tiles.size(); i++)
+	{
+		Tile& tile = m_tiles[i];
+		bool running = tile.key != nullptr && tile.result.isEmpty();
+		if (!tile.dirty && !(tickClocks && running))
+			continue;
+
+		const QRect rect(tileRect(i));
+		if (rect.intersects(visible))
+			update(tile.dirty ? rect : rect.adjusted(0, 0, 0,
+				s_clockHeight - rect.height()));
+		tile.dirty = false;
+	}
+}
+
+void GameWallCanvas::updateLayout()
+{
+	const QRectF bounds(m_boardItem.boundingRect());
+	const int count = qMax(1, m_tiles.size());
+
+	m_columns = qBound(1, width() / s_minTileWidth, count);
+	int tileWidth = qMax(s_minTileWidth, width() / m_columns);
+	int boardHeight = int(tileWidth * bounds.height() / bounds.width());
+	m_tileSize = QSize(tileWidth, s_clockHeight + boardHeight);
+
+	int rows = (count + m_columns - 1) / m_columns;
+	setMinimumHeight(rows * m_tileSize.height());
+	update();
+}
+
+QRect GameWallCanvas::tileRect(int index) const
+{
+	return QRect(QPoint((index % m_columns) * m_tileSize.width(),
+			    (index / m_columns) * m_tileSize.height()),
+		     m_tileSize);
+}
+
+QString GameWallCanvas::clockText(const Tile& tile, int side) const
+{
+	if (tile.infinite[side])
+		return QString::fromUtf8("\xE2\x88\x9E");
+
+	int msecs = tile.timeLeft[side];
+	if (tile.key != nullptr && tile.result.isEmpty()
+	&&  tile.board != nullptr && tile.board->sideToMove() == side)
+		msecs -= int(m_clock.elapsed() - tile.time);
+
+	QTime time(QTime(0, 0).addMSecs(qMax(msecs, 0)));
+	return time.toString(msecs >= 3600000 ? "hh:mm:ss" : "mm:ss");
+}
+
+void GameWallCanvas::paintTile(QPainter* painter,
+			       const Tile& tile,
+			       const QRect& rect)
+{
+	painter->fillRect(rect, palette().window());
+	if (tile.board == nullptr)
+		return;
+
+	// Names and clocks
+	const int half = rect.width() / 2;
+	for (int i = 0; i < 2; i++)
+	{
+		QRect textRect(rect.left() + i * half + 4, rect.top(),
+			       half - 8, s_clockHeight);
+		QString clock(clockText(tile, i));
+		painter->drawText(textRect, Qt::AlignVCenter | Qt::AlignRight, clock);
+		textRect.setRight(textRect.right() - painter->fontMetrics().width(clock) - 6);
+		painter->drawText(textRect, Qt::AlignVCenter | Qt::AlignLeft,
+				  painter->fontMetrics().elidedText(
+					tile.names[i], Qt::ElideRight, textRect.width()));
+	}
+
+	// The board and the pieces in the board item's coordinates
+	const QRectF bounds(m_boardItem.boundingRect());
+	const qreal scale = rect.width() / bounds.width();
+	painter->save();
+	painter->translate(rect.left(), rect.top() + s_clockHeight);
+	painter->scale(scale, scale);
+	painter->translate(-bounds.topLeft());
+	m_boardItem.paint(painter, nullptr);
+
+	QSvgRenderer* renderer = BoardScene::pieceRenderer();
+	const QSizeF squareSize(s_squareSize, s_squareSize);
+	for (int file = 0; file < 9; file++)
+	{
+		for (int rank = 0; rank < 10; rank++)
+		{
+			const Chess::Piece piece(tile.board->pieceAt(
+				Chess::Square(file, rank)));
+			if (!piece.isValid())
+				continue;
+
+			QRectF square(QPointF(), squareSize);
+			square.moveCenter(tile.flipped
+				? m_boardItem.squarePos(Chess::Square(8 - file, 9 - rank))
+				: m_boardItem.squarePos(Chess::Square(file, rank)));
+			GraphicsPiece::paintPicture(painter, renderer,
+						    tile.board->representation(piece),
+						    square);
+		}
+	}
+	painter->restore();
+
+	if (!tile.result.isEmpty())
+	{
+		QFont font(painter->font());
+		font.setBold(true);
+		font.setPixelSize(rect.width() / 8);
+		painter->save();
+		painter->setFont(font);
+		painter->drawText(rect.adjusted(0, s_clockHeight, 0, 0),
+				  Qt::AlignCenter, tile.result);
+		painter->restore();
+	}
+}
+
+void GameWallCanvas::paintEvent(QPaintEvent* event)
+{
+	QPainter painter(this);
+	painter.setRenderHints(QPainter::Antialiasing
+			       | QPainter::SmoothPixmapTransform);
+	painter.fillRect(event->rect(), palette().window());
+
+	for (int i = 0; i < m_tiles.size(); i++)
+	{
+		const QRect rect(tileRect(i));
+		if (event->rect().intersects(rect))
+			paintTile(&painter, m_tiles.at(i), rect);
+	}
+}
+
+void GameWallCanvas::resizeEvent(QResizeEvent* event)
+{
+	QWidget::resizeEvent(event);
+	updateLayout();
+}
+
+
 GameWall::GameWall(GameManager* manager, QWidget *parent)
 	: QWidget(parent)
 {
 	Q_ASSERT(manager != nullptr);
 
-	setLayout(new TileLayout());
+	const QString mode = QSettings().value("ui/game_wall_mode", "auto").toString();
+	if (mode == "painted"
+	||  (mode == "auto" && manager->concurrency() > s_maxWidgetGames))
+	{
+		m_canvas = new GameWallCanvas(manager, this);
+
+		QScrollArea* scrollArea = new QScrollArea();
+		scrollArea->setWidgetResizable(true);
+		scrollArea->setWidget(m_canvas);
+
+		QVBoxLayout* layout = new QVBoxLayout();
+		layout->setContentsMargins(0, 0, 0, 0);
+		layout->addWidget(scrollArea);
+		setLayout(layout);
+	}
+	else
+	{
+		m_canvas = nullptr;
+		setLayout(new TileLayout());
+	}
 
 	const auto activeGames = manager->activeGames();
 	for (ChessGame* game : activeGames)
@@ -157,6 +554,11 @@ void GameWall::addGame(ChessGame* game)
 {
 	Q_ASSERT(game != nullptr);
 
+	if (m_canvas != nullptr)
+	{
+		m_canvas->addGame(game);
+		return;
+	}
 	if (m_games.contains(game))
 		return;
 
@@ -168,6 +570,11 @@ void GameWall::addGame(ChessGame* game)
 
 void GameWall::removeGame(ChessGame* game)
 {
+	if (m_canvas != nullptr)
+	{
+		m_canvas->removeGame(game);
+		return;
+	}
 	if (!m_games.contains(game))
 		return;
 	m_gamesToRemove.append(m_games.take(game));
@@ -26,7 +26,18 @@
 class ChessGame;
 class GameManager;
 class GameWallWidget;
-
+class GameWallCanvas;
+
+/*!
+ * \brief A window that shows all the games being played.
+ *
+ * With only a few games each game gets its own board view and
+ * chess clocks. With more games than that, or if the "ui/game_wall_mode"
+ * setting is "painted", all the boards are painted by one widget at a
+ * fixed frame rate without move animations. The setting "widgets"
+ * always uses the board views, and "auto" (default) picks by the
+ * game manager's concurrency.
+ */
 class GameWall : public QWidget
 {
 	Q_OBJECT
@@ -44,6 +55,7 @@ class GameWall : public QWidget
 
 		QMap<ChessGame*, GameWallWidget*> m_games;
 		QList<GameWallWidget*> m_gamesToRemove;
+		GameWallCanvas* m_canvas;
 };
 
 #endif // GAMEWALL_H
@@ -0,0 +1,376 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gridrecognizer.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+
+namespace Chess {
+
+namespace {
+
+// How far a piece may be off its intersection, in grid spacings
+const float s_maxOffset = 0.15f;
+
+} // anonymous namespace
+
+GridRecognizer::GridRecognizer()
+	: m_offx(0.0f),
+	  m_offy(0.0f),
+	  m_dx(0.0f),
+	  m_dy(0.0f),
+	  m_threshold(0.96),
+	  m_changeThreshold(8.0),
+	  m_parallel(true)
+{
+}
+
+void GridRecognizer::setGrid(float offx, float offy, float dx, float dy)
+{
+	m_offx = offx;
+	m_offy = offy;
+	m_dx = dx;
+	m_dy = dy;
+}
+
+bool GridRecognizer::hasGrid() const
+{
+	return m_dx > 0.0f && m_dy > 0.0f;
+}
+
+void GridRecognizer::setTemplate(int piece, const cv::Mat& image)
+{
+	Q_ASSERT(piece > 0 && piece < PieceCount);
+
+	m_templates[piece] = image;
+
+	m_templateSize = cv::Size();
+	for (int i = 1; i < PieceCount; i++)
+	{
+		m_templateSize.width = qMax(m_templateSize.width, m_templates[i].cols);
+		m_templateSize.height = qMax(m_templateSize.height, m_templates[i].rows);
+	}
+}
+
+bool GridRecognizer::hasTemplates() const
+{
+	for (int i = 1; i < PieceCount; i++)
+	{
+		if (m_templates[i].empty())
+			return false;
+	}
+	return true;
+}
+
+void GridRecognizer::clearTemplates()
+{
+	for (int i = 0; i < PieceCount; i++)
+		m_templates[i] = cv::Mat();
+	m_templateSize = cv::Size();
+}
+
+bool GridRecognizer::loadTemplates(const QString& dir, double clip)
+{
+	clearTemplates();
+
+	for (int piece = 1; piece < PieceCount; piece++)
+	{
+		cv::Mat templ = loadTemplate(dir + "/" + templateName(piece), clip);
+		if (templ.empty())
+		{
+			clearTemplates();
+			return false;
+		}
+		setTemplate(piece, templ);
+	}
+
+	return true;
+}
+
+QString GridRecognizer::templateName(int piece)
+{
+	Q_ASSERT(piece > 0 && piece < PieceCount);
+
+	static const char s_types[] = "pbacnrk";
+	return QString("%1%2.png")
+		.arg(piece < 8 ? 'b' : 'r')
+		.arg(QChar(s_types[(piece - 1) % 7]));
+}
+
+cv::Mat GridRecognizer::loadTemplate(const QString& fileName, double clip)
+{
+	cv::Mat image = cv::imread(fileName.toStdString());
+	if (image.empty())
+		return image;
+
+	int w = image.cols;
+	int h = image.rows;
+	return image(cv::Rect(int(w * clip), int(h * clip),
+			      int(w * (1 - 2 * clip)), int(h * (1 - 2 * clip))));
+}
+
+double GridRecognizer::threshold() const
+{
+	return m_threshold;
+}
+
+void GridRecognizer::setThreshold(double threshold)
+{
+	m_threshold = threshold;
+}
+
+bool GridRecognizer::isParallel() const
+{
+	return m_parallel;
+}
+
+void GridRecognizer::setParallel(bool parallel)
+{
+	m_parallel = parallel;
+}
+
+double GridRecognizer::changeThreshold() const
+{
+	return m_changeThreshold;
+}
+
+void GridRecognizer::setChangeThreshold(double threshold)
+{
+	m_changeThreshold = threshold;
+}
+
+cv::Rect GridRecognizer::boardRect(const cv::Size& imageSize) const
+{
+	cv::Rect board(0, 0, int(m_offx + m_dx * 8.8f), int(m_offy + m_dy * 9.8f));
+	return board & cv::Rect(0, 0, imageSize.width, imageSize.height);
+}
+
+cv::Rect GridRecognizer::patchRect(int square, const cv::Size& imageSize) const
+{
+	int x = int(m_offx + (square % 9) * m_dx + 0.5f);
+	int y = int(m_offy + (square / 9) * m_dy + 0.5f);
+	int w = m_templateSize.width / 2 + int(m_dx * s_maxOffset + 0.5f) + 1;
+	int h = m_templateSize.height / 2 + int(m_dy * s_maxOffset + 0.5f) + 1;
+
+	return cv::Rect(x - w, y - h, 2 * w + 1, 2 * h + 1)
+	     & cv::Rect(0, 0, imageSize.width, imageSize.height);
+}
+
+int GridRecognizer::classify(const cv::Mat& image, int square) const
+{
+	const cv::Mat patch(image(patchRect(square, image.size())));
+
+	cv::Mat matched;
+	double best = m_threshold;
+	int piece = 0;
+
+	for (int i = 1; i < PieceCount; i++)
+	{
+		const cv::Mat& templ = m_templates[i];
+		if (templ.cols > patch.cols || templ.rows > patch.rows)
+			continue;
+
+		double maxVal = 0.0;
+		cv::matchTemplate(patch, templ, matched, cv::TM_CCOEFF_NORMED);
+		cv::minMaxLoc(matched, nullptr, &maxVal);
+		if (maxVal > best)
+		{
+			best = maxVal;
+			piece = i;
+		}
+	}
+
+	return piece;
+}
+
+bool GridRecognizer::recognize(const cv::Mat& image, int b90[SquareCount]) const
+{
+	if (!hasGrid() || !hasTemplates() || image.empty())
+		return false;
+
+	auto classifyRange = [&](const cv::Range& range)
+	{
+		for (int square = range.start; square < range.end; square++)
+			b90[square] = classify(image, square);
+	};
+
+	if (m_parallel)
+		cv::parallel_for_(cv::Range(0, SquareCount), classifyRange);
+	else
+		classifyRange(cv::Range(0, SquareCount));
+
+	return true;
+}
+
+QVector<cv::Point> GridRecognizer::findAll(const cv::Mat& image, int piece) const
+{
+	Q_ASSERT(piece > 0 && piece < PieceCount);
+
+	QVector<cv::Point> points;
+	const cv::Mat& templ = m_templates[piece];
+	if (templ.empty() || templ.cols > image.cols || templ.rows > image.rows)
+		return points;
+
+	cv::Mat matched;
+	cv::matchTemplate(image, templ, matched, cv::TM_CCOEFF_NORMED);
+
+	while (true)
+	{
+		double maxVal = 0.0;
+		cv::Point maxLoc;
+		cv::minMaxLoc(matched, nullptr, &maxVal, nullptr, &maxLoc);
+		if (maxVal <= m_threshold)
+			break;
+
+		points << cv::Point(maxLoc.x + templ.cols / 2,
+				    maxLoc.y + templ.rows / 2);
+		cv::floodFill(matched, maxLoc, cv::Scalar(0));
+	}
+
+	return points;
+}
+
+bool GridRecognizer::recognizeFullFrame(const cv::Mat& image,
+					int b90[SquareCount]) const
+{
+	if (!hasGrid() || !hasTemplates() || image.empty())
+		return false;
+
+	std::fill(b90, b90 + SquareCount, 0);
+	for (int piece = 1; piece < PieceCount; piece++)
+	{
+		const QVector<cv::Point> points = findAll(image, piece);
+		for (const cv::Point& p : points)
+		{
+			int file = int((p.x - m_offx) / m_dx + 0.5f);
+			int row = int((p.y - m_offy) / m_dy + 0.5f);
+			b90[qBound(0, file + 9 * row, SquareCount - 1)] = piece;
+		}
+	}
+
+	return true;
+}
+
+bool GridRecognizer::locateGrid(const cv::Mat& image)
+{
+	// Black Che, see templateName()
+	QVector<cv::Point> che = findAll(image, 6);
+	if (che.size() != 2)
+		return false;
+	if (che[0].x > che[1].x)
+		std::swap(che[0], che[1]);
+
+	float dx = (che[1].x - che[0].x) / 8.0f;
+	if (dx < 10.0f)
+		return false;
+
+	setGrid(che[0].x, che[0].y, dx, dx);
+	return true;
+}
+
+bool GridRecognizer::isFlipped(const int b90[SquareCount])
+{
+	int blackKing = -1;
+	int redKing = -1;
+	for (int square = 0; square < SquareCount; square++)
+	{
+		if (b90[square] == 7)
+			blackKing = square;
+		else if (b90[square] == 14)
+			redKing = square;
+	}
+
+	return blackKing >= 0 && redKing >= 0 && blackKing / 9 > redKing / 9;
+}
+
+QString GridRecognizer::fenString(const int b90[SquareCount], bool flip)
+{
+	static const char s_pieces[] = "0pbacnrkPBACNRK";
+
+	QString fen;
+	for (int row = 0; row < 10; row++)
+	{
+		int empty = 0;
+		for (int file = 0; file < 9; file++)
+		{
+			int piece = b90[file + row * 9];
+			if (piece == 0)
+			{
+				empty++;
+				continue;
+			}
+			if (empty > 0)
+				fen += QChar('0' + empty);
+			empty = 0;
+			fen += QChar(s_pieces[piece]);
+		}
+		if (empty > 0)
+			fen += QChar('0' + empty);
+		fen += (row < 9 ? '/' : ' ');
+	}
+	fen += (flip ? "b " : "w ");
+	fen += "- - 0 1";
+
+	return fen;
+}
+
+void GridRecognizer::signatures(const cv::Mat& image, cv::Mat& signatures) const
+{
+	const cv::Size side(SignatureSide, SignatureSide);
+	signatures.create(SquareCount,
+			  SignatureSide * SignatureSide * image.channels(), CV_8U);
+
+	cv::Mat thumbnail;
+	for (int square = 0; square < SquareCount; square++)
+	{
+		const cv::Mat patch(image(patchRect(square, image.size())));
+		if (patch.empty())
+		{
+			signatures.row(square).setTo(0);
+			continue;
+		}
+
+		cv::resize(patch, thumbnail, side, 0, 0, cv::INTER_AREA);
+		thumbnail.reshape(1, 1).copyTo(signatures.row(square));
+	}
+}
+
+QVector<int> GridRecognizer::changedSquares(const cv::Mat& before,
+					     const cv::Mat& after) const
+{
+	QVector<int> squares;
+	bool comparable = !before.empty()
+		       && before.size() == after.size()
+		       && before.type() == after.type();
+
+	for (int square = 0; square < SquareCount; square++)
+	{
+		if (comparable)
+		{
+			double diff = cv::norm(before.row(square), after.row(square),
+					       cv::NORM_L1) / after.cols;
+			if (diff <= m_changeThreshold)
+				continue;
+		}
+		squares << square;
+	}
+
+	return squares;
+}
+
+} // namespace Chess
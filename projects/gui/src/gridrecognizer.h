@@ -0,0 +1,196 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRIDRECOGNIZER_H
+#define GRIDRECOGNIZER_H
+
+#include <QString>
+#include <QVector>
+#include <opencv2/core.hpp>
+
+namespace Chess {
+
+/*!
+ * \brief Reads the pieces of a Xiangqi board from a screenshot
+ *
+ * GridRecognizer knows where the 90 intersections of the board are in
+ * the screenshot, so instead of searching the whole image for every
+ * piece it only looks at a small patch around each intersection. Every
+ * patch is matched against all piece templates and gets the piece with
+ * the best score above the threshold, or no piece.
+ *
+ * Pieces are numbered like Capture's piece codes: 1 to 7 are the black
+ * Pawn, Xiang, Shi, Pao, Ma, Che and King, 8 to 14 the red ones, and 0
+ * is an empty intersection. Intersection \a square is at file
+ * square % 9 and row square / 9, counted from the top left corner of
+ * the screenshot.
+ *
+ * To follow a game without reading the whole board for every frame,
+ * signatures() summarizes each intersection as a small thumbnail of
+ * its patch, and changedSquares() tells which intersections differ
+ * between two frames so that only those are classified again.
+ */
+class GridRecognizer
+{
+	public:
+		/*! Number of intersections. */
+		enum { SquareCount = 90 };
+		/*! Number of piece codes, including the empty code 0. */
+		enum { PieceCount = 15 };
+		/*! Width and height of an intersection thumbnail. */
+		enum { SignatureSide = 4 };
+
+		/*! Creates a recognizer without a grid or templates. */
+		GridRecognizer();
+
+		/*!
+		 * Sets the grid: the top left intersection is at
+		 * (\a offx, \a offy) and the intersections are \a dx apart
+		 * horizontally and \a dy apart vertically.
+		 */
+		void setGrid(float offx, float offy, float dx, float dy);
+		/*! Returns true if the grid has been set. */
+		bool hasGrid() const;
+
+		/*!
+		 * Sets the template of \a piece to \a image.
+		 *
+		 * The template should be centered on the intersection and
+		 * have the same pixel format as the screenshots.
+		 */
+		void setTemplate(int piece, const cv::Mat& image);
+		/*! Returns true if every piece has a template. */
+		bool hasTemplates() const;
+		/*! Removes all templates. */
+		void clearTemplates();
+		/*!
+		 * Loads the templates of all pieces from the piece pictures
+		 * in \a dir. \a clip is the part of each picture's width and
+		 * height that is cut from every side.
+		 *
+		 * Returns false if any picture can't be read.
+		 */
+		bool loadTemplates(const QString& dir, double clip = 0.2);
+		/*! Returns the template file name of \a piece, eg. "br.png". */
+		static QString templateName(int piece);
+		/*!
+		 * Returns the picture in \a fileName with \a clip of its
+		 * size cut from every side, or an empty image on error.
+		 */
+		static cv::Mat loadTemplate(const QString& fileName, double clip);
+
+		/*! Returns the minimum matching score. */
+		double threshold() const;
+		/*! Sets the minimum matching score to \a threshold. */
+		void setThreshold(double threshold);
+		/*! Returns true if the patches are classified in parallel. */
+		bool isParallel() const;
+		/*!
+		 * If \a parallel is true the patches are classified with
+		 * cv::parallel_for_, otherwise one by one.
+		 */
+		void setParallel(bool parallel);
+		/*!
+		 * Returns the mean difference per thumbnail value above
+		 * which an intersection has changed.
+		 */
+		double changeThreshold() const;
+		/*! Sets the change threshold to \a threshold. */
+		void setChangeThreshold(double threshold);
+
+		/*!
+		 * Returns the part of an image of \a imageSize that covers
+		 * the board, from the top left corner of the image.
+		 */
+		cv::Rect boardRect(const cv::Size& imageSize) const;
+		/*!
+		 * Returns the part of an image of \a imageSize that is
+		 * searched for the piece on \a square.
+		 */
+		cv::Rect patchRect(int square, const cv::Size& imageSize) const;
+		/*! Returns the piece on \a square in \a image. */
+		int classify(const cv::Mat& image, int square) const;
+		/*!
+		 * Reads the piece of every intersection in \a image into
+		 * \a b90.
+		 *
+		 * Returns false if the grid or any template is missing.
+		 */
+		bool recognize(const cv::Mat& image, int b90[SquareCount]) const;
+
+		/*!
+		 * Returns the centers of all matches of the template of
+		 * \a piece in the whole \a image, best match first.
+		 */
+		QVector<cv::Point> findAll(const cv::Mat& image, int piece) const;
+		/*!
+		 * Reads the piece of every intersection in \a image into
+		 * \a b90 by searching the whole image for every piece.
+		 *
+		 * This is how Capture read boards before recognize(), and
+		 * is much slower.
+		 */
+		bool recognizeFullFrame(const cv::Mat& image,
+					int b90[SquareCount]) const;
+		/*!
+		 * Sets the grid from the two black Che on the top row of
+		 * \a image, as in the starting position.
+		 *
+		 * Returns false if they are not found.
+		 */
+		bool locateGrid(const cv::Mat& image);
+
+		/*!
+		 * Returns true if the black King is below the red King in
+		 * \a b90.
+		 */
+		static bool isFlipped(const int b90[SquareCount]);
+		/*!
+		 * Returns the FEN string of \a b90, with the top row as
+		 * rank 9. Black is to move if \a flip is true.
+		 */
+		static QString fenString(const int b90[SquareCount], bool flip);
+
+		/*!
+		 * Stores the signatures of all intersections of \a image in
+		 * \a signatures, one row per intersection.
+		 *
+		 * \a image must have 8-bit channels.
+		 */
+		void signatures(const cv::Mat& image, cv::Mat& signatures) const;
+		/*!
+		 * Returns the intersections whose signatures differ between
+		 * \a before and \a after, or all of them if the signatures
+		 * can't be compared.
+		 */
+		QVector<int> changedSquares(const cv::Mat& before,
+					    const cv::Mat& after) const;
+
+	private:
+		float m_offx;
+		float m_offy;
+		float m_dx;
+		float m_dy;
+		double m_threshold;
+		double m_changeThreshold;
+		bool m_parallel;
+		cv::Size m_templateSize;
+		cv::Mat m_templates[PieceCount];
+};
+
+} // namespace Chess
+#endif // GRIDRECOGNIZER_H
@@ -34,6 +34,7 @@
 #include <QWindow>
 #include <QSettings>
 #include <QDesktopWidget>
+#include <QElapsedTimer>
 
 #include <board/boardfactory.h>
 #include <chessgame.h>
@@ -84,8 +85,14 @@ MainWindow::MainWindow(ChessGame* game)
 	: m_game(nullptr),
 	  m_closing(false),
 	  m_readyToClose(false),
-	  m_firstTabAutoCloseEnabled(true)
+	  m_firstTabAutoCloseEnabled(true),
+	  m_captureNsecs(0),
+	  m_captureStatsEnabled(QSettings().value("debug/capture_sync_stats",
+						   false).toBool())
 {
+	for (int i = 0; i < CaptureUpdateCount; i++)
+		m_captureUpdates[i] = 0;
+
 	setAttribute(Qt::WA_DeleteOnClose, true);
 	setDockNestingEnabled(true);
 
@@ -1415,19 +1422,45 @@ void MainWindow::processCapMsg(stCaptureMsg msg)
 	case stCaptureMsg::eMove:
 		msg.pGame->PlayerMakeBookMove(msg.m);
 		break;
-	case stCaptureMsg::eSetFen: 
-	{
-		//msg.pGame->stop(false);
-		msg.pGame->board()->setFenString(msg.text);                  // һboard ChessGame, GameViewer
-		this->m_gameViewer->viewPreviousMove2(msg.pGame->board());
-	
-	}
+	case stCaptureMsg::eSetFen:
+		syncCapturedFen(msg.pGame, msg.text);
 		break;
 	default:
 		break;
 	}
 }
 
+void MainWindow::syncCapturedFen(ChessGame* game, const QString& fen)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	// The captured FEN only tells the placement of the pieces
+	Chess::Board* board = game->board();
+	const QString placement(fen.section(' ', 0, 0));
+	const QString oldPlacement(board->fenString().section(' ', 0, 0));
+	CaptureUpdate update = CaptureUnchanged;
+	if (placement != oldPlacement)
+		update = m_gameViewer->syncCapturedFen(board, fen)
+		       ? CaptureMove : CaptureRepopulate;
+
+	m_captureUpdates[update]++;
+	m_captureNsecs += timer.nsecsElapsed();
+
+	int count = 0;
+	for (int i = 0; i < CaptureUpdateCount; i++)
+		count += m_captureUpdates[i];
+	if (m_captureStatsEnabled && count % 100 == 0)
+	{
+		qDebug("Capture sync: %d unchanged, %d moves, %d repopulations, "
+		       "%.3f ms per message",
+		       m_captureUpdates[CaptureUnchanged],
+		       m_captureUpdates[CaptureMove],
+		       m_captureUpdates[CaptureRepopulate],
+		       double(m_captureNsecs) / 1.0e6 / count);
+	}
+}
+
 void MainWindow::onLXchessboard()
 {
 	//Capture cap;
@@ -136,6 +136,7 @@ class MainWindow : public QMainWindow
 		int tabIndex(Tournament* tournament, bool freeTab = false) const;
 		void addDefaultWindowMenu();
 		void adjudicateGame(Chess::Side winner);
+		void syncCapturedFen(ChessGame* game, const QString& fen);
 
 		QMenu* m_gameMenu;
 		QMenu* m_tournamentMenu;
@@ -197,6 +198,17 @@ class MainWindow : public QMainWindow
 		bool m_readyToClose;
 
 		bool m_firstTabAutoCloseEnabled;
+
+		enum CaptureUpdate
+		{
+			CaptureUnchanged,
+			CaptureMove,
+			CaptureRepopulate,
+			CaptureUpdateCount
+		};
+		int m_captureUpdates[CaptureUpdateCount];
+		qint64 m_captureNsecs;
+		bool m_captureStatsEnabled;
 };
 
 #endif // MAINWINDOW_H
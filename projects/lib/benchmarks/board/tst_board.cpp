@@ -0,0 +1,402 @@
+#include <QtTest/QtTest>
+#include <board/standardboard.h>
+
+/*
+ * Xiangqi move generator throughput.
+ *
+ * Every position is first checked against its reference perft node
+ * counts, then each board operation is timed separately over the
+ * positions of the perft tree. The perft depth defaults to 3 and can
+ * be changed with the CUTECHESS_PERFT_DEPTH environment variable; node
+ * counts are only compared for the depths listed below.
+ */
+
+namespace {
+
+class BenchBoard : public Chess::StandardBoard
+{
+	public:
+		virtual Chess::Board* copy() const
+		{
+			return new BenchBoard(*this);
+		}
+
+		using Chess::Board::generateMoves;
+};
+
+struct Position
+{
+	const char* name;
+	const char* fen;
+	// LAN moves played from fen so that the history has repetitions
+	const char* moves;
+	// Perft node counts for depths 1, 2, 3, ... (0 terminates)
+	quint64 nodes[5];
+};
+
+const Position s_positions[] =
+{
+	{
+		"opening",
+		"rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1",
+		"",
+		{ 44, 1920, 79666, Q_UINT64_C(3290240), 0 }
+	},
+	{
+		"middlegame",
+		"r1bakabr1/9/1cn3nc1/p1p1p1p1p/9/9/P1P1P1P1P/1CN3NC1/9/R1BAKAB1R w - - 4 3",
+		"",
+		{ 37, 1216, 45939, 0 }
+	},
+	{
+		"endgame",
+		"3k5/4a4/4b4/9/2n6/9/6R2/4B4/4A4/3AK4 w - - 0 1",
+		"",
+		{ 25, 373, 8302, 115007, 0 }
+	},
+	{
+		"knight shuffle",
+		"rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1",
+		"b0c2 b9c7 c2b0 c7b9 b0c2 b9c7 c2b0 c7b9",
+		{ 44, 1920, 79666, 0 }
+	},
+	{
+		// The next check from d1 is a banned perpetual check
+		"perpetual check",
+		"3k5/9/9/9/9/9/9/9/R8/5K3 w - - 0 1",
+		"a1d1 d9e9 d1e1 e9d9 e1d1 d9e9 d1e1 e9d9",
+		{ 18, 25, 435, 943, 0 }
+	}
+};
+
+const int s_positionCount = int(sizeof(s_positions) / sizeof(s_positions[0]));
+
+// Positions deeper than this in the perft tree aren't sampled
+const int s_maxSamplePly = 2;
+
+int perftDepth()
+{
+	bool ok = false;
+	int depth = qEnvironmentVariableIntValue("CUTECHESS_PERFT_DEPTH", &ok);
+	return ok && depth > 0 ? depth : 3;
+}
+
+quint64 referenceNodes(const Position& position, int depth)
+{
+	for (int i = 0; i < depth; i++)
+	{
+		if (i >= 5 || position.nodes[i] == 0)
+			return 0;
+	}
+	return position.nodes[depth - 1];
+}
+
+quint64 perft(Chess::Board* board, int depth)
+{
+	const QVector<Chess::Move> moves = board->legalMoves();
+	if (depth <= 1)
+		return moves.size();
+
+	quint64 nodeCount = 0;
+	for (const Chess::Move& move : moves)
+	{
+		board->makeMove(move);
+		nodeCount += perft(board, depth - 1);
+		board->undoMove();
+	}
+
+	return nodeCount;
+}
+
+void collectSamples(BenchBoard* board, int depth, QVector<BenchBoard*>& samples)
+{
+	samples << static_cast<BenchBoard*>(board->copy());
+	if (depth <= 0)
+		return;
+
+	const QVector<Chess::Move> moves = board->legalMoves();
+	for (const Chess::Move& move : moves)
+	{
+		board->makeMove(move);
+		collectSamples(board, depth - 1, samples);
+		board->undoMove();
+	}
+}
+
+void reportRate(const char* what, quint64 nodes, qint64 nsecs)
+{
+	if (nsecs <= 0)
+		return;
+	qInfo("%s: %llu nodes, %.0f nodes/s",
+	      what, nodes, double(nodes) * 1.0e9 / double(nsecs));
+}
+
+} // anonymous namespace
+
+class tst_Board: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+
+		void perft_data() const;
+		void perft();
+		void generateMoves_data() const;
+		void generateMoves();
+		void legalMoves_data() const;
+		void legalMoves();
+		void makeUndo_data() const;
+		void makeUndo();
+		void result_data() const;
+		void result();
+		void fenString_data() const;
+		void fenString();
+
+		void cleanupTestCase();
+
+	private:
+		BenchBoard* createBoard(const Position& position) const;
+		void positions_data() const;
+
+		int m_depth;
+		QVector<QVector<BenchBoard*>> m_samples;
+};
+
+BenchBoard* tst_Board::createBoard(const Position& position) const
+{
+	BenchBoard* board = new BenchBoard;
+	board->initialize();
+	if (!board->setFenString(position.fen))
+	{
+		delete board;
+		return nullptr;
+	}
+
+	const QStringList moves = QString(position.moves).split(' ', QString::SkipEmptyParts);
+	for (const QString& str : moves)
+	{
+		Chess::Move move = board->moveFromString(str);
+		if (move.isNull())
+		{
+			delete board;
+			return nullptr;
+		}
+		board->makeMove(move);
+	}
+
+	return board;
+}
+
+void tst_Board::initTestCase()
+{
+	m_depth = perftDepth();
+	qInfo("Perft depth %d", m_depth);
+
+	for (int i = 0; i < s_positionCount; i++)
+	{
+		BenchBoard* board = createBoard(s_positions[i]);
+		QVERIFY2(board != nullptr, s_positions[i].name);
+
+		QVector<BenchBoard*> samples;
+		collectSamples(board, qMin(m_depth - 1, s_maxSamplePly), samples);
+		m_samples << samples;
+		delete board;
+	}
+}
+
+void tst_Board::positions_data() const
+{
+	QTest::addColumn<int>("index");
+
+	for (int i = 0; i < s_positionCount; i++)
+		QTest::newRow(s_positions[i].name) << i;
+}
+
+void tst_Board::perft_data() const
+{
+	positions_data();
+}
+
+void tst_Board::perft()
+{
+	QFETCH(int, index);
+
+	const Position& position = s_positions[index];
+	QScopedPointer<BenchBoard> board(createBoard(position));
+	QVERIFY(board != nullptr);
+
+	quint64 nodes = 0;
+	quint64 nodeCount = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		nodeCount = ::perft(board.data(), m_depth);
+		nodes += nodeCount;
+	}
+	reportRate("perft", nodes, timer.nsecsElapsed());
+
+	quint64 expected = referenceNodes(position, m_depth);
+	if (expected != 0)
+		QCOMPARE(nodeCount, expected);
+}
+
+void tst_Board::generateMoves_data() const
+{
+	positions_data();
+}
+
+void tst_Board::generateMoves()
+{
+	QFETCH(int, index);
+
+	const QVector<BenchBoard*>& samples = m_samples.at(index);
+	QVarLengthArray<Chess::Move> moves;
+
+	quint64 nodes = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		for (BenchBoard* board : samples)
+		{
+			moves.clear();
+			board->generateMoves(moves);
+			nodes += moves.size();
+		}
+	}
+	reportRate("generateMoves", nodes, timer.nsecsElapsed());
+}
+
+void tst_Board::legalMoves_data() const
+{
+	positions_data();
+}
+
+void tst_Board::legalMoves()
+{
+	QFETCH(int, index);
+
+	const QVector<BenchBoard*>& samples = m_samples.at(index);
+
+	quint64 nodes = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		for (BenchBoard* board : samples)
+			nodes += board->legalMoves().size();
+	}
+	reportRate("legalMoves", nodes, timer.nsecsElapsed());
+}
+
+void tst_Board::makeUndo_data() const
+{
+	positions_data();
+}
+
+void tst_Board::makeUndo()
+{
+	QFETCH(int, index);
+
+	const QVector<BenchBoard*>& samples = m_samples.at(index);
+	QVector<QVector<Chess::Move>> moves;
+	for (BenchBoard* board : samples)
+		moves << board->legalMoves();
+
+	quint64 nodes = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		for (int i = 0; i < samples.size(); i++)
+		{
+			BenchBoard* board = samples.at(i);
+			for (const Chess::Move& move : moves.at(i))
+			{
+				board->makeMove(move);
+				board->undoMove();
+			}
+			nodes += moves.at(i).size();
+		}
+	}
+	reportRate("makeMove/undoMove", nodes, timer.nsecsElapsed());
+}
+
+void tst_Board::result_data() const
+{
+	QTest::addColumn<int>("index");
+	QTest::addColumn<bool>("bitboard");
+
+	for (int i = 0; i < s_positionCount; i++)
+	{
+		QString name(s_positions[i].name);
+		QTest::newRow(qPrintable(name)) << i << true;
+		QTest::newRow(qPrintable(name + " square array")) << i << false;
+	}
+}
+
+void tst_Board::result()
+{
+	QFETCH(int, index);
+	QFETCH(bool, bitboard);
+
+	const QVector<BenchBoard*>& samples = m_samples.at(index);
+	for (BenchBoard* board : samples)
+		board->setBitboardEnabled(bitboard);
+
+	quint64 nodes = 0;
+	int decisive = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		for (BenchBoard* board : samples)
+		{
+			if (!board->result().isNone())
+				decisive++;
+		}
+		nodes += samples.size();
+	}
+	reportRate("result", nodes, timer.nsecsElapsed());
+	qInfo("%d decisive results", decisive);
+
+	for (BenchBoard* board : samples)
+		board->setBitboardEnabled(true);
+}
+
+void tst_Board::fenString_data() const
+{
+	positions_data();
+}
+
+void tst_Board::fenString()
+{
+	QFETCH(int, index);
+
+	const QVector<BenchBoard*>& samples = m_samples.at(index);
+
+	quint64 nodes = 0;
+	int length = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		for (BenchBoard* board : samples)
+			length += board->fenString().size();
+		nodes += samples.size();
+	}
+	reportRate("fenString", nodes, timer.nsecsElapsed());
+	QVERIFY(length > 0);
+}
+
+void tst_Board::cleanupTestCase()
+{
+	for (const QVector<BenchBoard*>& samples : qAsConst(m_samples))
+		qDeleteAll(samples);
+	m_samples.clear();
+}
+
+QTEST_MAIN(tst_Board)
+#include "tst_board.moc"
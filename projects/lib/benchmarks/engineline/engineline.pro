@@ -0,0 +1,4 @@
+include(../benchmarks.pri)
+
+TARGET = tst_engineline
+SOURCES += tst_engineline.cpp
@@ -0,0 +1,319 @@
+#include <QtTest/QtTest>
+#include <uciengine.h>
+#include <humanplayer.h>
+#include <board/boardfactory.h>
+
+/*
+ * Engine output parsing speed.
+ *
+ * A transcript of UCI engine output is replayed through
+ * ChessEngine::onReadyRead() and UciEngine's line parser. The transcript
+ * is read from the file named by the CUTECHESS_ENGINE_TRANSCRIPT
+ * environment variable, or generated to look like a long search. The
+ * same lines are also parsed the way the engine did before it read
+ * them as bytes: as a QString per line, split into QStringRef tokens
+ * and converted to numbers through temporary strings.
+ */
+
+namespace {
+
+// PV moves, never converted to Chinese notation by the benchmark
+const char s_pv[] =
+	"b2a2 b9c7 i0i1 e6e5 i1a1 d9e8 i3i4 h7h4 h0i2 e8f7 e3e4 c7e8 h2d2 "
+	"h9g7 d2d6 h4g4 a3a4 e8f6 f0e1 g4h4 a2a3 i6i5 a3b3 f6d7 g3g4 b7a7";
+
+const int s_depths = 40;
+
+class BenchEngine : public UciEngine
+{
+	public:
+		using ChessEngine::firstToken;
+		using ChessEngine::nextToken;
+		using ChessEngine::onReadyRead;
+		using UciEngine::parseLine;
+};
+
+// Reads the transcript and throws away what the engine writes
+class TranscriptDevice : public QBuffer
+{
+	protected:
+		virtual qint64 writeData(const char* data, qint64 len)
+		{
+			Q_UNUSED(data);
+			return len;
+		}
+};
+
+QByteArray generatedTranscript()
+{
+	const QList<QByteArray> pv = QByteArray(s_pv).split(' ');
+	QByteArray transcript;
+	quint64 nodes = 0;
+
+	for (int depth = 1; depth <= s_depths; depth++)
+	{
+		for (int move = 1; move <= 8; move++)
+		{
+			transcript += "info depth " + QByteArray::number(depth)
+				   + " currmove " + pv.at(move % pv.size())
+				   + " currmovenumber " + QByteArray::number(move)
+				   + "\n";
+		}
+
+		nodes += quint64(depth) * depth * 1000;
+		QByteArray line = "info depth " + QByteArray::number(depth)
+				+ " seldepth " + QByteArray::number(depth + 6)
+				+ " multipv 1 score cp " + QByteArray::number(20 - depth % 7)
+				+ " nodes " + QByteArray::number(nodes)
+				+ " nps 2500000 hashfull " + QByteArray::number(depth * 20)
+				+ " tbhits 0 time " + QByteArray::number(nodes / 2500)
+				+ " pv";
+		for (int i = 0; i < qMin(depth, pv.size()); i++)
+			line += ' ' + pv.at(i);
+		transcript += line + "\n";
+	}
+
+	return transcript;
+}
+
+int lineCount(const QByteArray& transcript)
+{
+	return transcript.count('\n');
+}
+
+void reportRate(const char* what, quint64 lines, qint64 nsecs)
+{
+	if (nsecs <= 0)
+		return;
+	qInfo("%s: %llu lines, %.0f lines/s",
+	      what, lines, double(lines) * 1.0e9 / double(nsecs));
+}
+
+// UciEngine::parseUciTokens() before the byte reader
+QStringRef legacyTokens(const QStringRef& first,
+			const QString* types,
+			int typeCount,
+			QVarLengthArray<QStringRef>& tokens,
+			int& type)
+{
+	QStringRef token(first);
+	type = -1;
+	tokens.clear();
+
+	do
+	{
+		bool newType = false;
+		for (int i = 0; i < typeCount; i++)
+		{
+			if (token == types[i])
+			{
+				if (type != -1)
+					return token;
+				type = i;
+				newType = true;
+				break;
+			}
+		}
+		if (!newType && type != -1)
+			tokens.append(token);
+	}
+	while (!(token = BenchEngine::nextToken(token)).isNull());
+
+	return token;
+}
+
+// How the engine read and parsed an info line before the byte reader
+void legacyParseLine(QIODevice* device, MoveEvaluation* eval)
+{
+	static const QString types[] =
+	{
+		"depth", "seldepth", "time", "nodes", "score", "pv",
+		"multipv", "currmove", "currmovenumber", "hashfull", "nps",
+		"tbhits", "cpuload", "string", "refutation", "currline"
+	};
+
+	QString line = QString(device->readLine());
+	if (line.endsWith('\n'))
+		line.chop(1);
+	if (line.endsWith('\r'))
+		line.chop(1);
+
+	QStringRef command(BenchEngine::firstToken(line));
+	if (command != "info")
+		return;
+
+	int type = -1;
+	QStringRef token(BenchEngine::nextToken(command));
+	QVarLengthArray<QStringRef> tokens;
+	while (!token.isNull())
+	{
+		token = legacyTokens(token, types, 16, tokens, type);
+		if (tokens.isEmpty())
+			continue;
+
+		switch (type)
+		{
+		case 0:
+			eval->setDepth(tokens[0].toString().toInt());
+			break;
+		case 1:
+			eval->setSelectiveDepth(tokens[0].toString().toInt());
+			break;
+		case 2:
+			eval->setTime(tokens[0].toString().toInt());
+			break;
+		case 3:
+			eval->setNodeCount(tokens[0].toString().toULongLong());
+			break;
+		case 4:
+			if (tokens.size() > 1)
+				eval->setScore(tokens[1].toString().toInt());
+			break;
+		case 5:
+			{
+				QString pv;
+				for (const QStringRef& move : qAsConst(tokens))
+				{
+					if (!pv.isEmpty())
+						pv += " ";
+					pv += move.toString();
+				}
+				eval->setPv(pv);
+			}
+			break;
+		case 6:
+			eval->setPvNumber(tokens[0].toString().toInt());
+			break;
+		case 9:
+			eval->setHashUsage(tokens[0].toString().toInt());
+			break;
+		case 10:
+			eval->setNps(tokens[0].toString().toULongLong());
+			break;
+		case 11:
+			eval->setTbHits(tokens[0].toString().toULongLong());
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+} // anonymous namespace
+
+class tst_EngineLine: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void cleanupTestCase();
+
+		void tokens();
+		void legacyParser();
+		void byteParser();
+
+	private:
+		QByteArray m_transcript;
+		bool m_generated;
+		BenchEngine* m_engine;
+		TranscriptDevice* m_device;
+		HumanPlayer* m_opponent;
+		Chess::Board* m_board;
+};
+
+void tst_EngineLine::initTestCase()
+{
+	QString fileName(QString::fromLocal8Bit(qgetenv("CUTECHESS_ENGINE_TRANSCRIPT")));
+	if (!fileName.isEmpty())
+	{
+		QFile file(fileName);
+		QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(fileName));
+		m_transcript = file.readAll();
+	}
+	else
+		m_transcript = generatedTranscript();
+	m_generated = fileName.isEmpty();
+
+	// Start the protocol and a game without a real engine
+	m_device = new TranscriptDevice;
+	m_device->open(QIODevice::ReadWrite);
+	m_engine = new BenchEngine;
+	m_engine->setDevice(m_device);
+	m_engine->start();
+	m_engine->parseLine("uciok");
+	m_engine->parseLine("readyok");
+	QVERIFY(m_engine->isReady());
+
+	m_board = Chess::BoardFactory::create("standard");
+	QVERIFY(m_board != nullptr);
+	m_board->initialize();
+	m_board->setFenString(m_board->defaultFenString());
+
+	m_opponent = new HumanPlayer;
+	m_engine->newGame(Chess::Side::White, m_opponent, m_board);
+}
+
+void tst_EngineLine::cleanupTestCase()
+{
+	delete m_engine;
+	delete m_opponent;
+	delete m_board;
+}
+
+void tst_EngineLine::tokens()
+{
+	EngineLineReader reader;
+	const QByteArray line("info  depth 12 score cp -35 pv h2e2\th9g7 \r");
+	reader.setLine(line.constData(), line.size());
+
+	EngineToken token(reader.firstToken());
+	QVERIFY(token == "info");
+	QVERIFY((token = reader.nextToken(token)) == "depth");
+	QCOMPARE((token = reader.nextToken(token)).toInt(), 12);
+	token = reader.nextToken(reader.nextToken(token));
+	QVERIFY(token == "cp");
+	QCOMPARE((token = reader.nextToken(token)).toInt(), -35);
+	QCOMPARE(reader.rest(token).toString(), QString("pv h2e2\th9g7"));
+
+	bool ok = true;
+	QCOMPARE(EngineToken(line.constData(), line.constData() + 4).toInt(&ok), 0);
+	QVERIFY(!ok);
+}
+
+void tst_EngineLine::legacyParser()
+{
+	MoveEvaluation eval;
+	quint64 lines = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		m_device->buffer() = m_transcript;
+		m_device->seek(0);
+		while (m_device->canReadLine())
+			legacyParseLine(m_device, &eval);
+		lines += lineCount(m_transcript);
+	}
+	reportRate("QString lines", lines, timer.nsecsElapsed());
+}
+
+void tst_EngineLine::byteParser()
+{
+	quint64 lines = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		m_device->buffer() = m_transcript;
+		m_device->seek(0);
+		m_engine->onReadyRead();
+		lines += lineCount(m_transcript);
+	}
+	reportRate("byte lines", lines, timer.nsecsElapsed());
+	if (m_generated)
+		QCOMPARE(m_engine->evaluation().depth(), s_depths);
+}
+
+QTEST_MAIN(tst_EngineLine)
+#include "tst_engineline.moc"
@@ -0,0 +1,4 @@
+include(../benchmarks.pri)
+
+TARGET = tst_enginestress
+SOURCES += tst_enginestress.cpp
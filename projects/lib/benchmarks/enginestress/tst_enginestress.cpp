@@ -0,0 +1,208 @@
+#include <QtTest/QtTest>
+#include <iostream>
+#include <string>
+#include <chessgame.h>
+#include <enginebuilder.h>
+#include <engineconfiguration.h>
+#include <gameadjudicator.h>
+#include <gamemanager.h>
+#include <pgngame.h>
+#include <timecontrol.h>
+#include <board/boardfactory.h>
+
+/*
+ * Sustained games per second with many concurrent engines.
+ *
+ * Games are played between stub engines that answer every "go" at
+ * once, so the time goes to starting the games, passing the moves
+ * between the engines and the games, and adjudicating. The stub engine
+ * is this program started with the -stub argument.
+ *
+ * CUTECHESS_STRESS_GAMES sets the number of games per row (200) and
+ * CUTECHESS_STRESS_CONCURRENCY the highest concurrency (64).
+ */
+
+namespace {
+
+// Games are adjudicated as draws after this many moves
+const int s_gameLength = 40;
+
+int environmentValue(const char* name, int defaultValue)
+{
+	bool ok = false;
+	int value = qEnvironmentVariableIntValue(name, &ok);
+	return ok && value > 0 ? value : defaultValue;
+}
+
+void reply(const QString& str)
+{
+	std::cout << str.toStdString() << std::endl;
+}
+
+void setPosition(Chess::Board* board, QString str)
+{
+	if (str.startsWith("position "))
+		str.remove(0, 9);
+
+	int movesPos = str.indexOf(" moves");
+	QString fen(str.left(movesPos));
+	if (fen == "startpos")
+		fen = board->defaultFenString();
+	else if (fen.startsWith("fen "))
+		fen.remove(0, 4);
+	if (!board->setFenString(fen))
+		return;
+	if (movesPos == -1)
+		return;
+
+	const QStringList moves(str.mid(movesPos + 6).split(' ', QString::SkipEmptyParts));
+	for (const QString& moveString : moves)
+	{
+		Chess::Move move(board->moveFromString(moveString));
+		if (move.isNull())
+			break;
+		board->makeMove(move);
+	}
+}
+
+// A UCI engine that plays one of its legal moves without thinking
+int runStubEngine()
+{
+	Chess::Board* board = Chess::BoardFactory::create("standard");
+	board->initialize();
+	board->setFenString(board->defaultFenString());
+
+	std::string line;
+	while (std::getline(std::cin, line))
+	{
+		const QString command(QString::fromStdString(line).trimmed());
+		if (command == "uci")
+			reply("id name stub\nuciok");
+		else if (command == "isready")
+			reply("readyok");
+		else if (command == "quit")
+			break;
+		else if (command.startsWith("go"))
+		{
+			const QVector<Chess::Move> moves(board->legalMoves());
+			if (moves.isEmpty())
+			{
+				reply("bestmove 0000");
+				continue;
+			}
+
+			// Vary the moves to stay away from repetitions
+			const Chess::Move& move = moves.at(board->plyCount() * 7 % moves.size());
+			QString str(board->moveString(move, Chess::Board::LongAlgebraic));
+			reply("info depth 1 score cp 0 nodes 1 pv " + str
+			      + "\nbestmove " + str);
+		}
+		else if (command.startsWith("position ")
+		     ||  command.startsWith("fen ")
+		     ||  command.startsWith("startpos"))
+			setPosition(board, command);
+	}
+
+	delete board;
+	return 0;
+}
+
+} // anonymous namespace
+
+class tst_EngineStress: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void games_data() const;
+		void games();
+};
+
+void tst_EngineStress::games_data() const
+{
+	QTest::addColumn<int>("concurrency");
+
+	int maxConcurrency = environmentValue("CUTECHESS_STRESS_CONCURRENCY", 64);
+	for (int i = 1; i < maxConcurrency; i *= 4)
+		QTest::newRow(qPrintable(QString("concurrency %1").arg(i))) << i;
+	QTest::newRow(qPrintable(QString("concurrency %1").arg(maxConcurrency)))
+		<< maxConcurrency;
+}
+
+void tst_EngineStress::games()
+{
+	QFETCH(int, concurrency);
+
+	const int gameCount = qMax(environmentValue("CUTECHESS_STRESS_GAMES", 200),
+				   concurrency);
+
+	EngineConfiguration config("stub", QCoreApplication::applicationFilePath(), "uci");
+	config.setArguments(QStringList() << "-stub");
+	EngineBuilder white(config);
+	EngineBuilder black(config);
+
+	GameAdjudicator adjudicator;
+	adjudicator.setMaximumGameLength(s_gameLength);
+
+	GameManager manager;
+	manager.setConcurrency(concurrency);
+
+	int finished = 0;
+	qint64 plies = 0;
+	qint64 lag = 0;
+	int maxLag = 0;
+	QEventLoop loop;
+	connect(&manager, SIGNAL(finished()), &loop, SLOT(quit()));
+
+	QElapsedTimer timer;
+	QBENCHMARK_ONCE
+	{
+		timer.start();
+		for (int i = 0; i < gameCount; i++)
+		{
+			Chess::Board* board = Chess::BoardFactory::create("standard");
+			ChessGame* game = new ChessGame(board, new PgnGame());
+			game->setTimeControl(TimeControl("40/10"));
+			game->setAdjudicator(adjudicator);
+
+			connect(game, &ChessGame::finished, &loop, [&](ChessGame* finishedGame)
+			{
+				plies += finishedGame->moves().size();
+				for (int side = 0; side < 2; side++)
+				{
+					Chess::Side s = Chess::Side::Type(side);
+					lag += finishedGame->clockLag(s);
+					maxLag = qMax(maxLag, finishedGame->maxClockLag(s));
+				}
+				delete finishedGame->pgn();
+				finishedGame->deleteLater();
+
+				if (++finished == gameCount)
+					manager.finish();
+			});
+			manager.newGame(game, &white, &black,
+					GameManager::Enqueue,
+					GameManager::ReusePlayers);
+		}
+		loop.exec();
+	}
+
+	qint64 msecs = qMax(timer.elapsed(), qint64(1));
+	qInfo("%d games in %lld ms: %.1f games/s, %.0f moves/s",
+	      finished, msecs, finished * 1000.0 / msecs, plies * 1000.0 / msecs);
+	qInfo("clock lag %.3f ms per move, at most %d ms",
+	      plies > 0 ? double(lag) / plies : 0.0, maxLag);
+	QCOMPARE(finished, gameCount);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && qstrcmp(argv[1], "-stub") == 0)
+		return runStubEngine();
+
+	QCoreApplication app(argc, argv);
+	tst_EngineStress test;
+	return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_enginestress.moc"
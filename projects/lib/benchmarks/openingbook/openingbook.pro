@@ -0,0 +1,5 @@
+include(../benchmarks.pri)
+
+QT += sql
+TARGET = tst_openingbook
+SOURCES += tst_openingbook.cpp
@@ -0,0 +1,196 @@
+#include <QtTest/QtTest>
+#include <QtSql>
+#include <QTemporaryDir>
+#include <polyglotbook.h>
+#include <compiledbook.h>
+
+
+class tst_OpeningBook: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+
+		void probe_data() const;
+		void probe();
+		void probeCompiled_data() const;
+		void probeCompiled();
+		void probeReopen_data() const;
+		void probeReopen();
+
+	private:
+		QList<quint64> probeKeys(bool hits) const;
+
+		QTemporaryDir m_dir;
+		QString m_fileName;
+		QString m_compiledFileName;
+		QList<quint64> m_keys;
+};
+
+namespace {
+
+const int s_positions = 20000;
+const int s_probes = 1000;
+
+quint64 nextKey(quint64& state)
+{
+	state = state * Q_UINT64_C(6364136223846793005)
+	      + Q_UINT64_C(1442695040888963407);
+	// Stay positive; the book binds negative keys differently
+	return state >> 1;
+}
+
+// Encodes a move the way bhobk.vmove does (16x16 board, files from 3)
+int encodeSquare(int file, int rank)
+{
+	return (12 - rank) * 16 + file + 3;
+}
+
+} // anonymous namespace
+
+void tst_OpeningBook::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+	m_fileName = m_dir.filePath("bench_book.db");
+
+	{
+		QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "bench_create");
+		db.setDatabaseName(m_fileName);
+		QVERIFY(db.open());
+
+		QSqlQuery query(db);
+		QVERIFY(query.exec("create table bhobk (vkey integer, vmove integer, "
+				   "vscore integer, vvalid integer)"));
+		QVERIFY(query.exec("create index bhobk_vkey on bhobk (vkey)"));
+
+		QVERIFY(db.transaction());
+		QVERIFY(query.prepare("insert into bhobk values (?, ?, ?, ?)"));
+		quint64 state = 1;
+		for (int i = 0; i < s_positions; i++)
+		{
+			quint64 key = nextKey(state);
+			m_keys << key;
+			for (int j = 0; j < 1 + i % 4; j++)
+			{
+				int from = encodeSquare(j, 0);
+				int to = encodeSquare(j, 2);
+				query.bindValue(0, key);
+				query.bindValue(1, (from << 8) | to);
+				query.bindValue(2, 10 + j);
+				query.bindValue(3, 1);
+				QVERIFY(query.exec());
+			}
+		}
+		QVERIFY(db.commit());
+		db.close();
+	}
+	QSqlDatabase::removeDatabase("bench_create");
+
+	m_compiledFileName = m_dir.filePath("bench_book.bin");
+	QVERIFY(CompiledBook::compile(m_fileName, m_compiledFileName));
+}
+
+QList<quint64> tst_OpeningBook::probeKeys(bool hits) const
+{
+	QList<quint64> keys;
+	quint64 state = 12345;
+	for (int i = 0; i < s_probes; i++)
+	{
+		if (hits)
+			keys << m_keys.at(int(nextKey(state) % m_keys.size()));
+		else
+			keys << nextKey(state);
+	}
+
+	return keys;
+}
+
+void tst_OpeningBook::probe_data() const
+{
+	QTest::addColumn<bool>("hits");
+
+	QTest::newRow("hits") << true;
+	QTest::newRow("misses") << false;
+}
+
+void tst_OpeningBook::probe()
+{
+	QFETCH(bool, hits);
+
+	PolyglotBook book;
+	QVERIFY(book.read(m_fileName));
+	const QList<quint64> keys = probeKeys(hits);
+	QCOMPARE(book.entries(m_keys.first()).size(), 1);
+
+	int found = 0;
+	QBENCHMARK
+	{
+		for (quint64 key : keys)
+			found += book.entries(key).size();
+	}
+	QVERIFY(!hits || found > 0);
+}
+
+void tst_OpeningBook::probeCompiled_data() const
+{
+	probe_data();
+}
+
+void tst_OpeningBook::probeCompiled()
+{
+	QFETCH(bool, hits);
+
+	PolyglotBook book;
+	QVERIFY(book.read(m_compiledFileName));
+	const QList<quint64> keys = probeKeys(hits);
+	QCOMPARE(book.entries(m_keys.first()).size(), 1);
+
+	int found = 0;
+	QBENCHMARK
+	{
+		for (quint64 key : keys)
+			found += book.entries(key).size();
+	}
+	QVERIFY(!hits || found > 0);
+}
+
+void tst_OpeningBook::probeReopen_data() const
+{
+	probe_data();
+}
+
+// Reference: a fresh connection and statement per probe, which is
+// what every book lookup used to cost.
+void tst_OpeningBook::probeReopen()
+{
+	QFETCH(bool, hits);
+
+	const QList<quint64> keys = probeKeys(hits);
+
+	int found = 0;
+	QBENCHMARK
+	{
+		for (quint64 key : keys)
+		{
+			{
+				QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "bench_reopen");
+				db.setDatabaseName(m_fileName);
+				QVERIFY(db.open());
+
+				QSqlQuery query(db);
+				query.prepare("select * from bhobk where vkey = ?");
+				query.bindValue(0, key);
+				QVERIFY(query.exec());
+				while (query.next())
+					found++;
+				db.close();
+			}
+			QSqlDatabase::removeDatabase("bench_reopen");
+		}
+	}
+	QVERIFY(!hits || found > 0);
+}
+
+QTEST_MAIN(tst_OpeningBook)
+#include "tst_openingbook.moc"
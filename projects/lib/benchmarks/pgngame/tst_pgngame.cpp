@@ -1,7 +1,98 @@
 #include <QtTest/QtTest>
 #include <pgnstream.h>
 #include <pgngame.h>
+#include <board/standardboard.h>
 
+namespace {
+
+// A random Xiangqi game in coordinate notation
+const char s_xiangqiGame[] =
+	"b2a2 b9c7 i0i1 e6e5 i1a1 d9e8 i3i4 h7h4 h0i2 e8f7 e3e4 c7e8 h2d2 "
+	"h9g7 d2d6 h4g4 a3a4 e8f6 f0e1 g4h4 a2a3 i6i5 a3b3 f6d7 g3g4 b7a7 "
+	"i2g3 g7i6 c3c4 f9e8 g3h1 e8f9 e1d2 h4h2 b0a2 g6g5 b3i3 h2g2 d6d4 "
+	"g2a2 d4d3 i6g7 h1f0 a7b7 i3i0 f7e8 d3a3 e8f7 a3d3 d7f8 g0e2 b7b1 "
+	"d3c3 i5i4 c3e3 g7f5 a0b0 i9h9 e3b3 h9h4 i0i2 f5e7 b3b6 h4h9 e2g0 "
+	"b1g1 f0e2 c9a7 e0f0 e7f5 b0b5 a9a8 d2e1 h9h6 b5a5 a2a3 b6b2 i4h4 "
+	"b2d2 f8d9 i2i8 f5e3 a1a2 h6h5 c4c5 g9i7 d2d1 a8f8 a2b2 a3a1 f0e0 "
+	"a1a3 c5d5 h5h6 b2b6 c6c5 e0f0 h6h7 b6i6 a3a2";
+
+const int s_importGameCount = 200;
+
+class XiangqiBoard : public Chess::StandardBoard
+{
+	public:
+		using Chess::Board::generateMoves;
+		using Chess::WesternBoard::vIsLegalMove;
+
+		// How moveFromStringCN() used to find moves: by formatting
+		// every pseudo-legal move and comparing the strings
+		Chess::Move moveFromFormattedString(const QString& str)
+		{
+			QVarLengthArray<Chess::Move> moves;
+			generateMoves(moves);
+			for (const Chess::Move& move : moves)
+			{
+				if (moveString(move, StandardChinese) == str
+				&&  vIsLegalMove(move))
+					return move;
+			}
+			return Chess::Move();
+		}
+};
+
+QStringList xiangqiMoves()
+{
+	XiangqiBoard board;
+	board.initialize();
+	board.setFenString(board.defaultFenString());
+
+	QStringList moves;
+	const QStringList lanMoves = QString(s_xiangqiGame).split(' ');
+	for (const QString& lan : lanMoves)
+	{
+		Chess::Move move = board.moveFromString(lan);
+		if (move.isNull())
+			return QStringList();
+		moves << board.moveString(move, Chess::Board::StandardChinese);
+		board.makeMove(move);
+	}
+	return moves;
+}
+
+QByteArray xiangqiPgn(const QStringList& moves, int gameCount)
+{
+	QByteArray moveText;
+	for (int i = 0; i < moves.size(); i++)
+	{
+		if (i % 2 == 0)
+			moveText += QByteArray::number(i / 2 + 1) + ". ";
+		moveText += moves.at(i).toLocal8Bit() + ' ';
+	}
+
+	QByteArray pgn;
+	for (int i = 0; i < gameCount; i++)
+	{
+		pgn += "[Event \"?\"]\n"
+		       "[Site \"?\"]\n"
+		       "[Date \"?\"]\n"
+		       "[Round \"" + QByteArray::number(i + 1) + "\"]\n"
+		       "[White \"?\"]\n"
+		       "[Black \"?\"]\n"
+		       "[Result \"*\"]\n\n"
+		       + moveText + "*\n\n";
+	}
+	return pgn;
+}
+
+void reportRate(const char* what, quint64 moves, qint64 nsecs)
+{
+	if (nsecs <= 0)
+		return;
+	qInfo("%s: %llu moves, %.0f moves/s",
+	      what, moves, double(moves) * 1.0e9 / double(nsecs));
+}
+
+} // anonymous namespace
 
 class tst_PgnGame: public QObject
 {
@@ -10,6 +101,9 @@ class tst_PgnGame: public QObject
 	private slots:
 		void parser_data() const;
 		void parser();
+		void chineseMoves_data() const;
+		void chineseMoves();
+		void xiangqiImport();
 };
 
 void tst_PgnGame::parser_data() const
@@ -99,5 +193,66 @@ void tst_PgnGame::parser()
 	}
 }
 
+void tst_PgnGame::chineseMoves_data() const
+{
+	QTest::addColumn<bool>("direct");
+
+	QTest::newRow("direct") << true;
+	QTest::newRow("format every move") << false;
+}
+
+void tst_PgnGame::chineseMoves()
+{
+	QFETCH(bool, direct);
+
+	const QStringList moves = xiangqiMoves();
+	QVERIFY(!moves.isEmpty());
+
+	XiangqiBoard board;
+	board.initialize();
+
+	quint64 moveCount = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		board.setFenString(board.defaultFenString());
+		for (const QString& str : moves)
+		{
+			Chess::Move move = direct ? board.moveFromStringCN(str)
+						  : board.moveFromFormattedString(str);
+			QVERIFY2(!move.isNull(), qUtf8Printable(str));
+			board.makeMove(move);
+		}
+		moveCount += moves.size();
+	}
+	reportRate("moveFromStringCN", moveCount, timer.nsecsElapsed());
+}
+
+void tst_PgnGame::xiangqiImport()
+{
+	const QStringList moves = xiangqiMoves();
+	QVERIFY(!moves.isEmpty());
+	const QByteArray pgn = xiangqiPgn(moves, s_importGameCount);
+
+	quint64 moveCount = 0;
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK
+	{
+		PgnStream stream(&pgn);
+		PgnGame game;
+		int games = 0;
+		while (game.read(stream))
+		{
+			QCOMPARE(game.moves().size(), moves.size());
+			games++;
+		}
+		QCOMPARE(games, s_importGameCount);
+		moveCount += quint64(games) * moves.size();
+	}
+	reportRate("PGN import", moveCount, timer.nsecsElapsed());
+}
+
 QTEST_MAIN(tst_PgnGame)
 #include "tst_pgngame.moc"
@@ -1,6 +1,7 @@
 #include "databasemanager.h"
 
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QMutexLocker>
 #include <QThread>
 #include <QSqlError>
@@ -9,30 +10,45 @@
 
 QMutex DatabaseManager::s_databaseMutex;
 QMap<QString, QMap<QString, QSqlDatabase> > DatabaseManager::s_instances;
+QMap<QString, QHash<QString, QSqlQuery*> > DatabaseManager::s_queries;
 
-QSqlDatabase DatabaseManager::database(const QString& connectionName, const QString dbName)
+QString DatabaseManager::threadKey(QThread* thread)
+{
+	return QString::number(quintptr(thread), 16);
+}
+
+QString DatabaseManager::sqlConnectionName(const QString& connectionName,
+					   const QString& threadKey)
+{
+	return QString("%1_%2").arg(connectionName).arg(threadKey);
+}
+
+QSqlDatabase DatabaseManager::database(const QString& connectionName, const QString dbName, bool readOnly)
 {
 	QMutexLocker locker(&s_databaseMutex);
 	QThread* thread = QThread::currentThread();
-
-	if (!thread->objectName().isEmpty()) {
-		QString objectname = QString::number((long long)QThread::currentThread(), 16);
-		// if we have a connection for this thread, return it
-		QMap<QString, QMap<QString, QSqlDatabase> >::Iterator it_thread = s_instances.find(objectname);
-		if (it_thread != s_instances.end()) {
-			QMap<QString, QSqlDatabase>::iterator it_conn = it_thread.value().find(connectionName);
-			if (it_conn != it_thread.value().end()) {
-				QSqlDatabase connection = it_conn.value();
-				qDebug() << "Function Name: " << Q_FUNC_INFO << " found SQL connection instances Thread: " << thread << " Name: " << connectionName;
-				if (connection.isValid())
-					return it_conn.value();
-			}
+	QString objectname = threadKey(thread);
+
+	// if we have a connection for this thread, return it
+	QMap<QString, QMap<QString, QSqlDatabase> >::Iterator it_thread = s_instances.find(objectname);
+	if (it_thread != s_instances.end()) {
+		QMap<QString, QSqlDatabase>::iterator it_conn = it_thread.value().find(connectionName);
+		if (it_conn != it_thread.value().end()) {
+			QSqlDatabase connection = it_conn.value();
+			if (connection.isValid() && connection.isOpen())
+				return connection;
 		}
 	}
+	else {
+		// First connection of this thread: release everything the
+		// thread opened when it finishes. The functor runs in the
+		// finishing thread, which is the only one allowed to close
+		// its connections.
+		QObject::connect(thread, &QThread::finished, [objectname]() {
+			DatabaseManager::removeThread(objectname);
+		});
+	}
 
-	QString objectname = QString::number((long long)QThread::currentThread(), 16);
-
-	thread->setObjectName(objectname);
 	// otherwise, create a new connection for this thread
 
 	// cloneDatabase will not work with QT 5.11
@@ -43,7 +59,10 @@ QSqlDatabase DatabaseManager::database(const QString& connectionName, const QStr
 
 	//QJsonObject connectionDefinition = Database::getConnectionDefinition();
 	//QString dbtype = connectionDefinition.value("dbtype").toString();
-	QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", QString("%1_%2").arg(connectionName).arg(objectname));
+	QString sqlName = sqlConnectionName(connectionName, objectname);
+	QSqlDatabase connection = QSqlDatabase::contains(sqlName)
+		? QSqlDatabase::database(sqlName, false)
+		: QSqlDatabase::addDatabase("QSQLITE", sqlName);
 
 	//if (dbtype == "QMYSQL") {
 	//	connection.setHostName(connectionDefinition.value("databasehost").toString());
@@ -56,6 +75,8 @@ QSqlDatabase DatabaseManager::database(const QString& connectionName, const QStr
 	//}
 
 	connection.setDatabaseName(dbName);
+	if (readOnly)
+		connection.setConnectOptions("QSQLITE_OPEN_READONLY");
 
 	// open the database connection
 	// initialize the database connection
@@ -65,31 +86,99 @@ QSqlDatabase DatabaseManager::database(const QString& connectionName, const QStr
 		return connection;
 	}
 
-	qDebug() << "Function Name: " << Q_FUNC_INFO << " new SQL connection instances Thread: " << thread->currentThread() << " Name: " << connectionName;
+	qDebug() << "Function Name: " << Q_FUNC_INFO << " new SQL connection instances Thread: " << thread << " Name: " << connectionName;
 
 	s_instances[objectname][connectionName] = connection;
-	qDebug() << "Function Name: " << Q_FUNC_INFO << " connection instances used: " << s_instances.size();
 
 	return connection;
 }
 
+QSqlQuery* DatabaseManager::preparedQuery(const QString& connectionName,
+					  const QString& dbName,
+					  const QString& sql,
+					  bool readOnly)
+{
+	QString objectname = threadKey(QThread::currentThread());
+	QString queryKey = connectionName + QLatin1Char('\n') + sql;
+
+	{
+		QMutexLocker locker(&s_databaseMutex);
+		QSqlQuery* query = s_queries.value(objectname).value(queryKey);
+		if (query != nullptr)
+			return query;
+	}
+
+	QSqlDatabase connection = database(connectionName, dbName, readOnly);
+	if (!connection.isOpen())
+		return nullptr;
+
+	QSqlQuery* query = new QSqlQuery(connection);
+	query->setForwardOnly(true);
+	if (!query->prepare(sql)) {
+		qCritical() << "Function Name: " << Q_FUNC_INFO << query->lastError().text();
+		delete query;
+		return nullptr;
+	}
+
+	QMutexLocker locker(&s_databaseMutex);
+	s_queries[objectname].insert(queryKey, query);
+
+	return query;
+}
+
 void DatabaseManager::clear()
 {
+	QMutexLocker locker(&s_databaseMutex);
+	for (const auto& queries : qAsConst(s_queries))
+		qDeleteAll(queries);
+	s_queries.clear();
 	s_instances.clear();
 }
 
 void DatabaseManager::removeCurrentThread(QString connectionName)
 {
-	QString objectname = QString::number((long long)QThread::currentThread(), 16);
-	if (s_instances.contains(objectname)) {
-		QMap<QString, QSqlDatabase> map = s_instances.value(objectname);
-		QSqlDatabase connection = map.value(connectionName);
-		connection.close();
-		if (!connection.isOpen()) {
-			s_instances.remove(objectname);
-			qDebug() << "Function Name: " << Q_FUNC_INFO << " remove connection instance: " << objectname;
+	QMutexLocker locker(&s_databaseMutex);
+	QString objectname = threadKey(QThread::currentThread());
+
+	// Prepared statements must go before their connection
+	auto it_queries = s_queries.find(objectname);
+	if (it_queries != s_queries.end()) {
+		QString prefix = connectionName + QLatin1Char('\n');
+		auto it = it_queries.value().begin();
+		while (it != it_queries.value().end()) {
+			if (it.key().startsWith(prefix)) {
+				delete it.value();
+				it = it_queries.value().erase(it);
+			}
+			else
+				++it;
 		}
 	}
 
+	auto it_thread = s_instances.find(objectname);
+	if (it_thread != s_instances.end() && it_thread.value().contains(connectionName)) {
+		it_thread.value().take(connectionName).close();
+		if (it_thread.value().isEmpty())
+			s_instances.erase(it_thread);
+		QSqlDatabase::removeDatabase(sqlConnectionName(connectionName, objectname));
+		qDebug() << "Function Name: " << Q_FUNC_INFO << " remove connection instance: " << objectname;
+	}
+
 	qDebug() << "Function Name: " << Q_FUNC_INFO << " connection instances used: " << s_instances.size();
-}
\ No newline at end of file
+}
+
+void DatabaseManager::removeThread(const QString& threadKey)
+{
+	QMutexLocker locker(&s_databaseMutex);
+
+	qDeleteAll(s_queries.take(threadKey));
+
+	const QStringList names = s_instances.value(threadKey).keys();
+	{
+		QMap<QString, QSqlDatabase> connections = s_instances.take(threadKey);
+		for (QSqlDatabase& connection : connections)
+			connection.close();
+	}
+	for (const QString& name : names)
+		QSqlDatabase::removeDatabase(sqlConnectionName(name, threadKey));
+}
@@ -9,18 +9,57 @@
 #include <QMap>
 
 class QThread;
+class QSqlQuery;
 
+/*!
+ * \brief Per-thread SQL connection manager.
+ *
+ * A QSqlDatabase connection may only be used by the thread that
+ * created it, so DatabaseManager keeps one connection per
+ * (thread, connection name) pair and hands the same connection back
+ * on every later call from that thread. Connections and their cached
+ * prepared statements are released automatically when the owning
+ * thread finishes.
+ */
 class DatabaseManager
 {
 public:
-	static QSqlDatabase database(const QString& connectionName = QLatin1String(QSqlDatabase::defaultConnection), const QString dbName=nullptr);
+	/*!
+	 * Returns the calling thread's connection named \a connectionName
+	 * to the SQLite database \a dbName, opening it on first use.
+	 *
+	 * If \a readOnly is true the database file is opened read-only,
+	 * which lets any number of threads read it concurrently.
+	 */
+	static QSqlDatabase database(const QString& connectionName = QLatin1String(QSqlDatabase::defaultConnection),
+				     const QString dbName = nullptr,
+				     bool readOnly = false);
+	/*!
+	 * Returns a prepared statement for \a sql on the calling thread's
+	 * connection \a connectionName, or nullptr if the database can't
+	 * be opened or \a sql can't be prepared.
+	 *
+	 * The statement is prepared only once per thread and connection;
+	 * later calls return the cached query, ready for new bind values.
+	 * The query is owned by DatabaseManager.
+	 */
+	static QSqlQuery* preparedQuery(const QString& connectionName,
+					const QString& dbName,
+					const QString& sql,
+					bool readOnly = true);
 	static void clear();
 	static void removeCurrentThread(QString);
 	//static QString DBName;
 
 private:
+	static QString threadKey(QThread* thread);
+	static QString sqlConnectionName(const QString& connectionName,
+					 const QString& threadKey);
+	static void removeThread(const QString& threadKey);
+
 	static QMutex s_databaseMutex;
 	static QMap<QString, QMap<QString, QSqlDatabase>> s_instances;
-	
+	static QMap<QString, QHash<QString, QSqlQuery*>> s_queries;
+
 
 };
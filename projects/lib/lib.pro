@@ -1,6 +1,6 @@
 TEMPLATE = lib
 TARGET = cutechess
-QT = core
+QT = core sql
 DESTDIR = $$PWD
 
 !win32-msvc* {
@@ -13,6 +13,12 @@ include(components/json/src/json.pri)
 include(3rdparty/fathom/src/tb.pri)
 include(res/res.pri)
 
+INCLUDEPATH += $$PWD
+HEADERS += $$PWD/ConnectionPool.h \
+    $$PWD/databasemanager.h
+SOURCES += $$PWD/ConnectionPool.cpp \
+    $$PWD/databasemanager.cpp
+
 OBJECTS_DIR = .obj
 MOC_DIR = .moc
 RCC_DIR = .rcc
@@ -17,6 +17,7 @@
 */
 
 #include "board.h"
+#include <cstring>
 #include <QStringList>
 #include "zobrist.h"
 
@@ -65,6 +66,7 @@ Board::Board(Zobrist* zobrist)
 {
 	Q_ASSERT(zobrist != nullptr);
 
+	memset(m_repetitionFilter, 0, sizeof(m_repetitionFilter));
 	setPieceType(Piece::NoPiece, QString(), QString());
 }
 
@@ -649,6 +651,7 @@ bool Board::setFenString(const QString& fen)
 		return false;
 
 	m_moveHistory.clear();
+	memset(m_repetitionFilter, 0, sizeof(m_repetitionFilter));
 
 	//m_startingFen = fen;				// by LGL
 	QStringList stFList = fen.split("moves");
@@ -711,13 +714,14 @@ void Board::makeMove(const Move& move, BoardTransition* transition)
 	Q_ASSERT(!m_side.isNull());
 	Q_ASSERT(!move.isNull());
 
-	MoveData md = { move, m_key };
+	MoveData md = { move, m_key, -1 };
 
 	vMakeMove(move, transition);
 
 	xorKey(m_zobrist->side());
 	m_side = m_side.opposite();
 	m_moveHistory << md;
+	m_repetitionFilter[md.key & (RepetitionFilterSize - 1)]++;
 }
 
 void Board::undoMove()
@@ -729,6 +733,7 @@ void Board::undoMove()
 	vUndoMove(m_moveHistory.last().move);
 
 	m_key = m_moveHistory.last().key;
+	m_repetitionFilter[m_key & (RepetitionFilterSize - 1)]--;
 	m_moveHistory.pop_back();
 }
 
@@ -861,79 +866,117 @@ int Board::captureType(const Move& move) const
 	return Piece::NoPiece;
 }
 
-// ĲҪunmakeboard  ׽ж
-bool Board::vIsBan(const Move& move) {
-	
-	bool isBan = false;
-
-	int n = 0;
-	int moCheck[2] = { 1,1 };
-	int moCap[2] = { 0, 0 };
+int Board::firstRepeatablePly() const
+{
+	// A position from before the last irreversible move can't recur
+	int reversible = reversibleMoveCount();
+	if (reversible < 0 || reversible >= plyCount())
+		return 0;
+	return plyCount() - reversible;
+}
 
-	quint64 last_key = m_key;
+bool Board::moveGaveCheck(int ply)
+{
+	Q_ASSERT(ply >= 0 && ply < plyCount());
 
-	for (int i = plyCount() - 1; i >= 0; i--)
+	if (ply == plyCount() - 1 && m_moveHistory.at(ply).check < 0)
+		m_moveHistory.last().check = inCheck(m_side) ? 1 : 0;
+	else if (m_moveHistory.at(ply).check < 0)
 	{
-
-		Side side = sideToMove();
-		if (!inCheck(side)) {
-			moCheck[1 & n] = 0;
+		// Rewind to the position after the move, filling in the
+		// missing check flags on the way, and replay the moves.
+		QVarLengthArray<MoveData, 32> undone;
+		while (plyCount() > ply)
+		{
+			MoveData md = m_moveHistory.last();
+			if (md.check < 0)
+				md.check = inCheck(m_side) ? 1 : 0;
+			undone.append(md);
+			undoMove();
+		}
+		for (int i = undone.size() - 1; i >= 0; i--)
+		{
+			makeMove(undone.at(i).move);
+			m_moveHistory.last().check = undone.at(i).check;
 		}
+	}
 
-		// 
-		undoMove();		
+	return m_moveHistory.at(ply).check > 0;
+}
 
-		if (m_key == last_key) {
+bool Board::vIsBan(const Move& move)
+{
+	Q_UNUSED(move);
+
+	// The moves made since the previous occurrence of the current
+	// position form the cycle.
+	int start = -1;
+	for (int i = plyCount() - 2; i >= firstRepeatablePly(); i -= 2)
+	{
+		if (m_moveHistory.at(i).key == m_key)
+		{
+			start = i;
 			break;
 		}
+	}
+	if (start < 0)
+		return false;
 
-		if ((moCheck[0] + moCheck[1] + moCap[0] + moCap[1]) == 0) {
+	// moCheck[0]: every move of the side that just moved gave check
+	// moCheck[1]: every move of the opponent gave check
+	bool moCheck[2] = { true, true };
+	for (int i = plyCount() - 1, n = 0; i >= start; i--, n++)
+	{
+		if (moveGaveCheck(i))
+			continue;
+
+		moCheck[n & 1] = false;
+		if (!moCheck[0] && !moCheck[1])
 			return false;
-		}
-		n++;
 	}
 
-	n--;
-	if ((moCheck[1] + moCheck[0]) == 2) {
-		return false;  // ˫
-	}
-	if (moCheck[1 & n]) {
-		return true;   // ҷ
-	}	
-	return isBan;
+	// Perpetual check by both sides is allowed
+	return moCheck[0] && !moCheck[1];
 }
 
 bool Board::vIsLegalMove(const Move& move)
 {
 	Q_ASSERT(!move.isNull());
 
-	int repcount = 0;
+	// The check flag of the last move is needed for perpetual check
+	// rulings; it's cheap to get here because every candidate move in
+	// this position shares it.
+	sideToMoveInCheck();
 
 	bool isBan = false;
 
-
 	makeMove(move);
 	bool isLegal = isLegalPosition();
 
+	// Third occurrence of the position: was it reached by perpetual check?
+	if (isLegal && repeatCount() >= 2)
+		isBan = vIsBan(move);
 
-	if (isLegal == true) {
+	undoMove();
 
-		repcount = this->repeatCount();
+	return isLegal && !isBan;
+}
 
-		if (repcount >= 2) {  // ظҪжǲǷ
-			Board* newB = this->copy();
-			isBan = newB->vIsBan(move);
-			delete newB;
-		}
-	}
+bool Board::sideToMoveInCheck()
+{
+	if (m_moveHistory.isEmpty())
+		return inCheck(m_side);
 
-	undoMove();
+	MoveData& md = m_moveHistory.last();
+	if (md.check < 0)
+		md.check = inCheck(m_side) ? 1 : 0;
+	return md.check > 0;
+}
 
-	if (isBan) {
-		return false;
-	}	
-	
-	return isLegal;
+bool Board::isRepetitionCandidate(quint64 key) const
+{
+	return plyCount() >= 3
+	    && m_repetitionFilter[key & (RepetitionFilterSize - 1)] != 0;
 }
 
 bool Board::isLegalMove(const Move& move)
@@ -943,11 +986,13 @@ bool Board::isLegalMove(const Move& move)
 
 int Board::repeatCount() const
 {
-	if (plyCount() < 4)
+	if (plyCount() < 4
+	||  m_repetitionFilter[m_key & (RepetitionFilterSize - 1)] == 0)
 		return 0;
 
+	// Positions with the same key have the same side to move
 	int repeatCount = 0;
-	for (int i = plyCount() - 1; i >= 0; i--)
+	for (int i = plyCount() - 2; i >= firstRepeatablePly(); i -= 2)
 	{
 		if (m_moveHistory.at(i).key == m_key)
 			repeatCount++;
@@ -972,18 +1017,29 @@ bool Board::isRepetition(const Chess::Move& move)
 	return isRepeat;
 }
 
-bool Board::canMove()
+void Board::generateLegalMoves(QVarLengthArray<Move>& moves, bool firstOnly)
 {
-	QVarLengthArray<Move> moves;
-	generateMoves(moves);
+	QVarLengthArray<Move> pseudoMoves;
+	generateMoves(pseudoMoves);
 
-	for (int i = 0; i < moves.size(); i++)
+	moves.clear();
+	for (int i = 0; i < pseudoMoves.size(); i++)
 	{
-		if (vIsLegalMove(moves[i]))
-			return true;
+		if (!vIsLegalMove(pseudoMoves[i]))
+			continue;
+
+		moves.append(pseudoMoves[i]);
+		if (firstOnly)
+			break;
 	}
+}
 
-	return false;
+bool Board::canMove()
+{
+	QVarLengthArray<Move> moves;
+	generateLegalMoves(moves, true);
+
+	return !moves.isEmpty();
 }
 
 QVector<Move> Board::legalMoves()
@@ -991,16 +1047,11 @@ QVector<Move> Board::legalMoves()
 	QVarLengthArray<Move> moves;
 	QVector<Move> legalMoves;
 
-	generateMoves(moves);
+	generateLegalMoves(moves);
 	legalMoves.reserve(moves.size());
 
 	for (int i = moves.size() - 1; i >= 0; i--)
-	{
-		Move m = moves[i];
-
-		if (vIsLegalMove(m))
-			legalMoves << m;
-	}
+		legalMoves << moves[i];
 
 	return legalMoves;
 }
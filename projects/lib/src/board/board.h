@@ -466,9 +466,42 @@ class LIB_EXPORT Board
 		 * after \a move is legal.
 		 */
 		virtual bool vIsLegalMove(const Move& move);
+		/*!
+		 * Generates the legal moves of the side to move into
+		 * \a moves, in generateMoves() order.
+		 *
+		 * If \a firstOnly is true the generation stops at the
+		 * first legal move.
+		 *
+		 * The default implementation filters pseudo-legal moves
+		 * with vIsLegalMove().
+		 */
+		virtual void generateLegalMoves(QVarLengthArray<Move>& moves,
+						bool firstOnly = false);
 
 		virtual bool inCheck(Side side /*, int square = 0*/) const = 0;
+		/*!
+		 * Returns true if the side to move is in check.
+		 *
+		 * The answer is remembered in the move history, where
+		 * vIsBan() needs it.
+		 */
+		bool sideToMoveInCheck();
+		/*!
+		 * Returns true if a position with key \a key, reached with
+		 * the next move, could be a repetition. If this returns false
+		 * the move can't be banned by vIsBan().
+		 */
+		bool isRepetitionCandidate(quint64 key) const;
 
+		/*!
+		 * Returns true if \a move, which was just made and
+		 * repeated the position, completes a perpetual check.
+		 *
+		 * The board is left as it was. The default implementation
+		 * bans the move if every move of its side in the repetition
+		 * cycle gave check and not every move of the opponent did.
+		 */
 		virtual bool vIsBan(const Move& move);
 
 		//virtual bool vIsIncheck(const Side side) = 0;      // side ǲǱ
@@ -530,7 +563,13 @@ class LIB_EXPORT Board
 		{
 			Move move;
 			quint64 key;
+			/*! 1 if the move gave check, 0 if not, -1 if unknown. */
+			qint8 check;
 		};
+		enum { RepetitionFilterSize = 4096 };
+
+		int firstRepeatablePly() const;
+		bool moveGaveCheck(int ply);
 		friend LIB_EXPORT QDebug operator<<(QDebug dbg, const Board* board);
 
 		bool m_initialized;
@@ -546,6 +585,11 @@ class LIB_EXPORT Board
 		QVarLengthArray<PieceData> m_pieceData;
 		QVarLengthArray<Piece> m_squares;
 		QVector<MoveData> m_moveHistory;
+		/*!
+		 * Number of history keys per (key % RepetitionFilterSize);
+		 * a zero means the current position can't be a repetition.
+		 */
+		quint16 m_repetitionFilter[RepetitionFilterSize];
 		//QVector<int> m_reserve[2];
 };
 
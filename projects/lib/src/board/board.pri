@@ -1,6 +1,7 @@
 DEPENDPATH += $$PWD
 SOURCES += $$PWD/board.cpp \
     $$PWD/westernboard.cpp \
+    $$PWD/xiangqibitboard.cpp \
     $$PWD/square.cpp \
     $$PWD/standardboard.cpp \
     $$PWD/ncheckboard.cpp \
@@ -66,6 +67,7 @@ HEADERS += $$PWD/board.h \
     $$PWD/move.h \
     $$PWD/piece.h \
     $$PWD/westernboard.h \
+    $$PWD/xiangqibitboard.h \
     $$PWD/square.h \
     $$PWD/standardboard.h \
     $$PWD/ncheckboard.h \
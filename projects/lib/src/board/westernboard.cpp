@@ -16,9 +16,11 @@ WesternBoard::WesternBoard(WesternZobrist* zobrist)
 	  m_sign(1),
 	  m_plyOffset(0),
 	  m_reversibleMoveCount(0),
+	  m_material(0),
 	  //m_kingCanCapture(true),
 	  //m_multiDigitNotation(false),
-	  m_zobrist(zobrist)
+	  m_zobrist(zobrist),
+	  m_useBitboard(true)
 {
 	setPieceType(Pawn, tr("pawn"), "P"); // , PawnMovement);                    // 
 	setPieceType(Ma, tr("knight"), "N"); // , MaMovement);                      // 
@@ -62,6 +64,20 @@ void WesternBoard::vInitialize()
 	m_kingSquare[Side::White] = 0;
 	m_kingSquare[Side::Black] = 0;
 
+	// Bitboard intersections count ranks from Red's side
+	m_bitIndex.resize(arraySize());
+	m_squareIndex.resize(Bitboard::SquareCount);
+	for (int i = 0; i < arraySize(); i++)
+	{
+		m_bitIndex[i] = -1;
+		Square square = chessSquare(i);
+		if (!isValidSquare(square))
+			continue;
+		int bit = square.rank() * width() + square.file();
+		m_bitIndex[i] = bit;
+		m_squareIndex[bit] = i;
+	}
+
 	
 
 	m_BPawnOffsets.resize(3);
@@ -191,29 +207,185 @@ int WesternBoard::captureType(const Move& move) const
 
 Move WesternBoard::moveFromStringCN(const QString& str)
 {
+	/*
+	 * "<piece><file><direction><number>" or, if another piece of the
+	 * same type is on the file, "<front/rear><piece><direction><number>".
+	 * The token is decoded directly and only the pieces it can refer to
+	 * are looked at, in the order of generateMoves().
+	 */
+	const Side side = sideToMove();
+	const bool red = (side == Side::White);
+	const QString front("ǰ");
+	const QString rear("");
+	const QString forward("");
+	const QString backward("");
+	const QString sideways("ƽ");
+	int pos = 0;
+
+	FileQualifier qualifier = NoQualifier;
+	if (str.startsWith(front))
+	{
+		qualifier = Front;
+		pos += front.size();
+	}
+	else if (str.startsWith(rear))
+	{
+		qualifier = Rear;
+		pos += rear.size();
+	}
 
-	QVarLengthArray<Move> moves;
-	generateMoves(moves);
+	// Accept the other side's piece names too, eg.  for a black pawn
+	int type = matchGlyph(str, pos, strnumName, red ? 1 : 8, red ? 7 : 14);
+	if (type == 0)
+		type = matchGlyph(str, pos, strnumName, red ? 8 : 1, red ? 14 : 7);
+	if (type == 0)
+		return Move();
+	if (type > King)
+		type -= King;
+
+	int sourceFile = -1;
+	if (qualifier == NoQualifier)
+	{
+		int number = matchNumber(str, pos);
+		if (number == 0)
+			return Move();
+		sourceFile = red ? 9 - number : number - 1;
+	}
 
-	//QString s4 = str.split("x")[0];   // ȥx
+	int direction;
+	if (str.midRef(pos, forward.size()) == forward)
+	{
+		direction = 1;
+		pos += forward.size();
+	}
+	else if (str.midRef(pos, backward.size()) == backward)
+	{
+		direction = -1;
+		pos += backward.size();
+	}
+	else if (str.midRef(pos, sideways.size()) == sideways)
+	{
+		direction = 0;
+		pos += sideways.size();
+	}
+	else
+		return Move();
 
-	for (int i = 0; i < moves.size(); i++)
+	int number = matchNumber(str, pos);
+	if (number == 0 || pos != str.size())
+		return Move();
+
+	// Ma, Xiang and Shi name their target file instead of a distance
+	const bool diagonal = (type == Ma || type == Xiang || type == Shi);
+	if (direction == 0 && diagonal)
+		return Move();
+	const int targetFile = red ? 9 - number : number - 1;
+	const int up = red ? 1 : -1;
+
+	QVarLengthArray<Move> moves;
+	for (int rank = height() - 1; rank >= 0; rank--)
 	{
-		const auto m = moves[i];
-		// õ߲ƣ
-		QString cn = ChineseMoveString(m);
+		for (int file = 0; file < width(); file++)
+		{
+			if (sourceFile != -1 && file != sourceFile)
+				continue;
 
-		if (str == cn) {
-			if (vIsLegalMove(m)) {
-				return m;
+			const int source = squareIndex(Square(file, rank));
+			const Piece piece = pieceAt(source);
+			if (piece.side() != side || piece.type() != type
+			||  fileQualifier(source) != qualifier)
+				continue;
+
+			int toFile = file;
+			int toRank = rank;
+			if (direction == 0)
+				toFile = targetFile;
+			else if (diagonal)
+			{
+				toFile = targetFile;
+				int df = qAbs(toFile - file);
+				int dr = 0;
+				if (type == Ma)
+					dr = (df == 1) ? 2 : (df == 2) ? 1 : 0;
+				else if (type == Xiang)
+					dr = (df == 2) ? 2 : 0;
+				else
+					dr = (df == 1) ? 1 : 0;
+				if (dr == 0)
+					continue;
+				toRank = rank + direction * up * dr;
+			}
+			else
+				toRank = rank + direction * up * number;
+
+			const Square target(toFile, toRank);
+			if (!isValidSquare(target))
+				continue;
+
+			const Move move(source, squareIndex(target));
+			moves.clear();
+			generateMovesForPiece(moves, type, source);
+			for (const Move& m : moves)
+			{
+				if (m == move && vIsLegalMove(move))
+					return move;
 			}
 		}
 	}
-	
-	
+
 	return Move();
 }
 
+WesternBoard::FileQualifier WesternBoard::fileQualifier(int square) const
+{
+	const Piece piece = pieceAt(square);
+	const int type = piece.type();
+	if (type == Xiang || type == Shi || type == King)
+		return NoQualifier;
+
+	// Same scan as ChineseMoveString(): look up the board first
+	const Side side = piece.side();
+	for (int sq = square - m_arwidth; !pieceAt(sq).isWall(); sq -= m_arwidth)
+	{
+		if (pieceAt(sq) == piece)
+			return side == Side::White ? Rear : Front;
+	}
+	for (int sq = square + m_arwidth; !pieceAt(sq).isWall(); sq += m_arwidth)
+	{
+		if (pieceAt(sq) == piece)
+			return side == Side::White ? Front : Rear;
+	}
+
+	return NoQualifier;
+}
+
+int WesternBoard::matchGlyph(const QString& str,
+			     int& pos,
+			     const QVarLengthArray<QString>& glyphs,
+			     int first,
+			     int last) const
+{
+	for (int i = first; i <= last; i++)
+	{
+		const QString& glyph = glyphs.at(i);
+		if (str.midRef(pos, glyph.size()) == glyph)
+		{
+			pos += glyph.size();
+			return i;
+		}
+	}
+
+	return 0;
+}
+
+int WesternBoard::matchNumber(const QString& str, int& pos) const
+{
+	int number = matchGlyph(str, pos, strnumCn, 1, 9);
+	if (number == 0)
+		number = matchGlyph(str, pos, strnumEn, 1, 9);
+	return number;
+}
+
 
 
 QString WesternBoard::lanMoveString(const Move& move)
@@ -928,6 +1100,17 @@ bool WesternBoard::vSetFenString(const QStringList& fen)
 		m_plyOffset++;
 
 	m_history.clear();
+	if (m_useBitboard)
+		syncBitboard();
+
+	m_material = 0;
+	for (int sq = 0; sq < arraySize(); sq++)
+	{
+		const Piece& piece = pieceAt(sq);
+		if (piece.isValid())
+			m_material += materialValue(piece.type());
+	}
+
 	return true;
 }
 
@@ -969,6 +1152,7 @@ void WesternBoard::vMakeMove(const Move& move, BoardTransition* transition)
 	{
 		//removeCastlingRights(target);
 		isReversible = false;
+		m_material -= materialValue(capture.type());
 	}
 
 	//if (promotionType != Piece::NoPiece)
@@ -984,6 +1168,15 @@ void WesternBoard::vMakeMove(const Move& move, BoardTransition* transition)
 		//			    chessSquare(target));
 	}
 
+	if (m_useBitboard)
+	{
+		if (!capture.isEmpty())
+			m_bitboard.remove(capture.side(), capture.type(), m_bitIndex[target]);
+		if (clearSource)
+			m_bitboard.remove(side, pieceType, m_bitIndex[source]);
+		m_bitboard.add(side, pieceType, m_bitIndex[target]);
+	}
+
 	setSquare(target, Piece(side, pieceType));
 	if (clearSource)
 		setSquare(source, Piece::NoPiece);
@@ -1008,6 +1201,8 @@ void WesternBoard::vUndoMove(const Move& move)
 
 	//setEnpassantSquare(md.enpassantSquare, md.enpassantTarget);
 	m_reversibleMoveCount = md.reversibleMoveCount;
+	if (md.capture.isValid())
+		m_material += materialValue(md.capture.type());
 	//m_castlingRights = md.castlingRights;
 
 	//CastlingSide cside = md.castlingSide;
@@ -1032,6 +1227,15 @@ void WesternBoard::vUndoMove(const Move& move)
 		m_kingSquare[side] = source;
 	}
 
+	if (m_useBitboard && source != target)
+	{
+		int pieceType = pieceAt(target).type();
+		m_bitboard.remove(side, pieceType, m_bitIndex[target]);
+		m_bitboard.add(side, pieceType, m_bitIndex[source]);
+		if (!md.capture.isEmpty())
+			m_bitboard.add(md.capture.side(), md.capture.type(), m_bitIndex[target]);
+	}
+
 
 	//if (move.promotion() != Piece::NoPiece)
 	//{
@@ -1054,6 +1258,12 @@ void WesternBoard::generateMovesForPiece(QVarLengthArray<Move>& moves,
 					 int pieceType,
 					 int sourceSquare) const
 {		
+	if (m_useBitboard)
+	{
+		generateBitboardMoves(moves, pieceType, sourceSquare);
+		return;
+	}
+
 	switch (pieceType)
 	{
 	case Pawn:     // ߲
@@ -1267,107 +1477,246 @@ void WesternBoard::generateMovesForPiece(QVarLengthArray<Move>& moves,
 
 
 
+void WesternBoard::generateBitboardMoves(QVarLengthArray<Move>& moves,
+					 int pieceType,
+					 int sourceSquare) const
+{
+	const int source = m_bitIndex[sourceSquare];
+	const Bitboard own = m_bitboard.pieces(sideToMove());
+	const Bitboard occupied = m_bitboard.occupied();
+
+	const XiangqiBitboard::Step* steps = nullptr;
+	int stepCount = 4;
+	switch (pieceType)
+	{
+	case Pawn:
+		steps = XiangqiBitboard::pawnSteps(pieceAt(sourceSquare).side(), source);
+		stepCount = 3;
+		break;
+	case King:
+		steps = XiangqiBitboard::kingSteps(source);
+		break;
+	case Shi:
+		steps = XiangqiBitboard::shiSteps(source);
+		break;
+	case Ma:
+		steps = XiangqiBitboard::maSteps(source);
+		stepCount = 8;
+		break;
+	case Xiang:
+		steps = XiangqiBitboard::xiangSteps(source);
+		break;
+	case Che:
+	case Pao:
+	{
+		Bitboard attacks = m_bitboard.cheAttacks(source);
+		Bitboard targets;
+		if (pieceType == Che)
+			targets = attacks & ~own;
+		else
+			targets = (attacks & ~occupied)
+				| (m_bitboard.paoCaptures(source) & ~own);
+
+		// Direction by direction, nearest target first
+		for (int i = XiangqiBitboard::Up; i <= XiangqiBitboard::Down; i++)
+		{
+			auto direction = XiangqiBitboard::Direction(i);
+			Bitboard ray = targets & XiangqiBitboard::ray(source, direction);
+			bool ascending = (direction == XiangqiBitboard::Up
+				       || direction == XiangqiBitboard::Right);
+			while (!ray.isEmpty())
+			{
+				int target = ascending ? ray.first() : ray.last();
+				ray ^= Bitboard::square(target);
+				moves.append(Move(sourceSquare, m_squareIndex[target]));
+			}
+		}
+		return;
+	}
+	default:
+		return;
+	}
+
+	for (int i = 0; i < stepCount; i++)
+	{
+		const XiangqiBitboard::Step& step = steps[i];
+		if (step.target < 0
+		||  (step.block >= 0 && occupied.test(step.block))
+		||  own.test(step.target))
+			continue;
+		moves.append(Move(sourceSquare, m_squareIndex[step.target]));
+	}
+}
+
 bool WesternBoard::inCheck(Side side /*, int square*/) const
+{
+	if (m_useBitboard)
+		return m_bitboard.isAttacked(m_bitIndex[m_kingSquare[side]],
+					     side.opposite());
+	return inCheckAfter(side, 0, 0);
+}
+
+bool WesternBoard::inCheckAfter(Side side, int source, int target) const
 {
 	Side opSide = side.opposite();
-	//Piece opKing(opSide, King);
-	Piece piece;
+	Piece moved = pieceAt(source);
 
 	int ksquare = m_kingSquare[side];
+	if (source != 0 && source == ksquare)
+		ksquare = target;
 
-	//if (ksquare != 27 && ksquare != 126) {
-	//	int a = 0;
-	//}
+	// The board as it would be after the move
+	auto at = [&](int square)
+	{
+		if (source != 0)
+		{
+			if (square == target)
+				return moved;
+			if (square == source)
+				return Piece(Piece::NoPiece);
+		}
+		return pieceAt(square);
+	};
 
-	// Ƿڣ, ԷĽ 
+	// Che, pawns and the other king attack with the first piece on
+	// a line, pao with the second one
+	int pawnSquare = (side == Side::White) ? ksquare - m_arwidth
+					       : ksquare + m_arwidth;
 	for (int i = 0; i < m_CheOffsets.size(); i++)
 	{
 		int offset = m_CheOffsets[i];
-		int targetSquare = ksquare + offset;
+		int square = ksquare + offset;
+		Piece piece;
+		while ((piece = at(square)).isEmpty())
+			square += offset;
+		if (piece.isWall())
+			continue;
 
-		int count = 0;    // һֻһھ
-		while (true)
+		if (piece.side() == opSide)
 		{
-			if (!isValidSquare(chessSquare(targetSquare)))
-				break;
-
-			piece = pieceAt(targetSquare);
-			if (!piece.isEmpty())
-			{
-				count++;
-				if (count == 1) {        // ǲгԷĽڽ
-					if (piece.side() == opSide) {  // ǶԷ
-						if (piece.type() == Che || piece.type() == King) {
-							return true;
-						}
-						else if (piece.type() == Pawn) {
-							if (abs(targetSquare - ksquare) == 1) {
-								return true;
-							}
-							if (side == Side::White) {
-								if (targetSquare == ksquare - 11) {
-									return true;
-								}
-							}
-							else {
-								if (targetSquare == ksquare + 11) {
-									return true;
-								}
-							}
-						}
-					}
-				}
-				else if (count == 2) {   // ǲڽ
-					if (piece.side() == opSide) {  // ǶԷ
-						if (piece.type() == Pao) {
-							return true;
-						}
-					}
-					break;
-				}
-			}
-			targetSquare += offset;
+			int type = piece.type();
+			if (type == Che || type == King)
+				return true;
+			if (type == Pawn
+			&&  (square == ksquare - 1
+			||   square == ksquare + 1
+			||   square == pawnSquare))
+				return true;
 		}
-	}
 
-	//Ƿ 
+		square += offset;
+		while ((piece = at(square)).isEmpty())
+			square += offset;
+		if (piece.side() == opSide && piece.type() == Pao)
+			return true;
+	}
 
-	// Knight, archbishop, chancellor attacks
+	// Ma attacks, unless the leg next to the king is blocked
 	for (int i = 0; i < m_MaOffsets.size(); i++)
 	{
-		piece = pieceAt(ksquare + m_MaOffsets[i]);
-		if (piece.side() == opSide && piece.type() == Ma) {
-			// Ҫһǲ
-			Piece leg = pieceAt(ksquare + m_MaCheckLegOffsets[i]);
+		Piece piece = at(ksquare + m_MaOffsets[i]);
+		if (piece.side() == opSide && piece.type() == Ma
+		&&  at(ksquare + m_MaCheckLegOffsets[i]).isEmpty())
+			return true;
+	}
 
-			//int a = ksquare + m_MaCheckLegOffsets[i];
-			//int b = m_MaCheckLegOffsets[i];
+	return false;
+}
 
-			if (leg.isEmpty()) {
-				return true;
-			}
+WesternBoard::LegalityInfo WesternBoard::legalityInfo()
+{
+	LegalityInfo info;
+	info.kingSquare = m_kingSquare[sideToMove()];
+	info.inCheck = sideToMoveInCheck();
+
+	// Each king line ends at its second piece: a move beyond that
+	// can't pin, unpin or screen anything
+	for (int i = 0; i < 4; i++)
+	{
+		int offset = m_CheOffsets[i];
+		int square = info.kingSquare;
+		int pieces = 0;
+		while (pieces < 2)
+		{
+			Piece piece = pieceAt(square + offset);
+			if (piece.isWall())
+				break;
+			square += offset;
+			if (!piece.isEmpty())
+				pieces++;
 		}
+		info.lineEnd[i] = square;
+	}
+
+	return info;
+}
+
+bool WesternBoard::isOnKingLine(const LegalityInfo& info, int square) const
+{
+	int ksquare = info.kingSquare;
+
+	if (square / m_arwidth == ksquare / m_arwidth)
+		return square < ksquare ? square >= info.lineEnd[1]
+					: square <= info.lineEnd[2];
+	if (square % m_arwidth == ksquare % m_arwidth)
+		return square < ksquare ? square >= info.lineEnd[0]
+					: square <= info.lineEnd[3];
+	return false;
+}
+
+bool WesternBoard::isLegalMoveFast(const Move& move, const LegalityInfo& info)
+{
+	int source = move.sourceSquare();
+	int target = move.targetSquare();
 
+	// A move can only expose the king if the king is in check or
+	// moving, if the move leaves or enters a king line (a pin, a
+	// flying general or a pao screen), or if it leaves a ma leg
+	// next to the king.
+	int diff = qAbs(source - info.kingSquare);
+	bool safe = !info.inCheck
+		 && source != info.kingSquare
+		 && diff != m_arwidth - 1
+		 && diff != m_arwidth + 1
+		 && !isOnKingLine(info, source)
+		 && !isOnKingLine(info, target);
+	if (!safe && inCheckAfter(sideToMove(), source, target))
+		return false;
+
+	// Only a quiet move can repeat a position; let the full rules
+	// rule on the rare candidates
+	if (pieceAt(target).isEmpty())
+	{
+		Piece piece = pieceAt(source);
+		quint64 newKey = key()
+			       ^ m_zobrist->piece(piece, source)
+			       ^ m_zobrist->piece(piece, target)
+			       ^ m_zobrist->side();
+		if (isRepetitionCandidate(newKey))
+			return Board::vIsLegalMove(move);
 	}
 
-	//Side opSide = sideToMove().opposite();
-	//for (int i = 0; i < m_MaOffsets.size(); i++)
-	//{
-	//	int targetSquare = sourceSquare + m_MaOffsets[i];
-	//	if (!isValidSquare(chessSquare(targetSquare)))
-	//		continue;
-	//	int leg = sourceSquare + m_MaLegOffsets[i];
-	//	if (!pieceAt(leg).isEmpty())
-	//		continue;     // 
-	//	Piece capture = pieceAt(targetSquare);
-	//	if (capture.isEmpty() || capture.side() == opSide)
-	//		moves.append(Move(sourceSquare, targetSquare));
-	//}
+	return true;
+}
 
-	
+void WesternBoard::generateLegalMoves(QVarLengthArray<Move>& moves,
+				      bool firstOnly)
+{
+	QVarLengthArray<Move> pseudoMoves;
+	generateMoves(pseudoMoves);
 
-	
-	return false;
+	const LegalityInfo info = legalityInfo();
+
+	moves.clear();
+	for (int i = 0; i < pseudoMoves.size(); i++)
+	{
+		if (!isLegalMoveFast(pseudoMoves[i], info))
+			continue;
+
+		moves.append(pseudoMoves[i]);
+		if (firstOnly)
+			break;
+	}
 }
 
 bool WesternBoard::isLegalPosition()
@@ -1393,7 +1742,7 @@ bool WesternBoard::vIsLegalMove(const Move& move)
 	//&&  captureType(move) != Piece::NoPiece)
 	//	return false;
 
-	return Board::vIsLegalMove(move);
+	return isLegalMoveFast(move, legalityInfo());
 }
 
 
@@ -1521,6 +1870,44 @@ int WesternBoard::reversibleMoveCount() const
 	return m_reversibleMoveCount;
 }
 
+int WesternBoard::materialValue(int pieceType) const
+{
+	// Kings and Shi can't attack, a Xiang can only help
+	switch (pieceType)
+	{
+	case King:
+	case Shi:
+		return 0;
+	case Xiang:
+		return 1;
+	default:
+		return 2;
+	}
+}
+
+bool WesternBoard::isBitboardEnabled() const
+{
+	return m_useBitboard;
+}
+
+void WesternBoard::setBitboardEnabled(bool enabled)
+{
+	if (enabled && !m_useBitboard)
+		syncBitboard();
+	m_useBitboard = enabled;
+}
+
+void WesternBoard::syncBitboard()
+{
+	m_bitboard.clear();
+	for (int i = 0; i < arraySize(); i++)
+	{
+		Piece piece = pieceAt(i);
+		if (piece.isValid())
+			m_bitboard.add(piece.side(), piece.type(), m_bitIndex[i]);
+	}
+}
+
 Result WesternBoard::result()
 {
 	QString str;
@@ -1543,37 +1930,7 @@ Result WesternBoard::result()
 	}
 
 	// Insufficient mating material
-	int material = 0;
-	bool bishops[] = { false, false };
-	for (int i = 0; i < arraySize(); i++)
-	{
-		const Piece& piece = pieceAt(i);
-		if (!piece.isValid())
-			continue;
-
-		switch (piece.type())
-		{
-		case King:
-			break;
-		case Shi:
-		{
-			//auto color = chessSquare(i).color();
-			//if (color != Square::NoColor && !bishops[color])
-			//{
-			//	material++;
-			//	bishops[color] = true;
-			//}
-			break;
-		}
-		case Xiang:
-			material++;
-			break;
-		default:
-			material += 2;
-			break;
-		}
-	}
-	if (material <= 0)
+	if (m_material <= 0)
 	{
 		str = tr("˫޽к");
 		return Result(Result::Draw, Side::NoSide, str);
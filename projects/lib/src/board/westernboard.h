@@ -19,6 +19,7 @@
 #define WESTERNBOARD_H
 
 #include "board.h"
+#include "xiangqibitboard.h"
 
 namespace Chess {
 
@@ -61,6 +62,20 @@ class LIB_EXPORT WesternBoard : public Board
 		virtual Result result();
 		virtual int reversibleMoveCount() const;
 
+		/*!
+		 * Returns true if the board keeps a XiangqiBitboard of the
+		 * position and uses it for check detection, move generation
+		 * and material counting. The default value is true.
+		 */
+		bool isBitboardEnabled() const;
+		/*!
+		 * Enables or disables the bitboard representation.
+		 *
+		 * With the bitboard disabled the board only uses its square
+		 * array, like it always did.
+		 */
+		void setBitboardEnabled(bool enabled);
+
 	protected:
 		/*! The king's castling side. */
 		//enum CastlingSide
@@ -223,12 +238,83 @@ class LIB_EXPORT WesternBoard : public Board
 						   int pieceType,
 						   int square) const;
 		virtual bool vIsLegalMove(const Move& move);
+		virtual void generateLegalMoves(QVarLengthArray<Move>& moves,
+						bool firstOnly = false);
 		virtual bool isLegalPosition();
 		virtual int captureType(const Move& move) const;
 
 		virtual Move moveFromStringCN(const QString& str);
 
 	private:
+		/*!
+		 * What the legality of a move depends on, computed once
+		 * per position.
+		 */
+		struct LegalityInfo
+		{
+			int kingSquare;
+			bool inCheck;
+			/*!
+			 * Last square of each king line (in m_CheOffsets
+			 * order) that matters: the second piece from the
+			 * king, or the edge of the board.
+			 */
+			int lineEnd[4];
+		};
+
+		/*!
+		 * Returns true if \a side would be in check after moving
+		 * the piece at \a source to \a target, without making the
+		 * move. If \a source is 0 the current position is checked.
+		 */
+		bool inCheckAfter(Side side, int source, int target) const;
+		LegalityInfo legalityInfo();
+		bool isOnKingLine(const LegalityInfo& info, int square) const;
+		bool isLegalMoveFast(const Move& move, const LegalityInfo& info);
+
+		/*!
+		 * Returns the mating material value of \a pieceType.
+		 * The game is drawn when both sides together have none.
+		 */
+		int materialValue(int pieceType) const;
+		/*! Rebuilds the bitboard from the square array. */
+		void syncBitboard();
+		/*!
+		 * Generates the moves of generateMovesForPiece() from the
+		 * bitboard, in the same order.
+		 */
+		void generateBitboardMoves(QVarLengthArray<Move>& moves,
+					   int pieceType,
+					   int sourceSquare) const;
+
+		/*! Front/rear qualifier of a move in Chinese notation. */
+		enum FileQualifier
+		{
+			NoQualifier,	//!< The only piece of its type on the file
+			Front,		//!< The piece nearer to the opponent
+			Rear		//!< The piece farther from the opponent
+		};
+		/*!
+		 * Returns the qualifier ChineseMoveString() uses for the
+		 * piece at \a square.
+		 */
+		FileQualifier fileQualifier(int square) const;
+		/*!
+		 * If one of \a glyphs[\a first] ... \a glyphs[\a last]
+		 * is at \a pos in \a str, moves \a pos past it and returns
+		 * its index. Otherwise returns 0.
+		 */
+		int matchGlyph(const QString& str,
+			       int& pos,
+			       const QVarLengthArray<QString>& glyphs,
+			       int first,
+			       int last) const;
+		/*!
+		 * Reads a file number or distance (1 to 9) in either
+		 * numeral style at \a pos in \a str. Returns 0 if there is
+		 * none.
+		 */
+		int matchNumber(const QString& str, int& pos) const;
 
 		// Data for reversing/unmaking a move
 		struct MoveData
@@ -248,6 +334,7 @@ class LIB_EXPORT WesternBoard : public Board
 		int m_kingSquare[2];
 		int m_plyOffset;
 		int m_reversibleMoveCount;
+		int m_material;
 		//bool m_kingCanCapture;
 	
 		//bool m_multiDigitNotation;
@@ -255,6 +342,12 @@ class LIB_EXPORT WesternBoard : public Board
 
 		const WesternZobrist* m_zobrist;
 
+		bool m_useBitboard;
+		XiangqiBitboard m_bitboard;
+		// Square array index to bitboard intersection and back
+		QVarLengthArray<int> m_bitIndex;
+		QVarLengthArray<int, Bitboard::SquareCount> m_squareIndex;
+
 		QVarLengthArray<int> m_BPawnOffsets;	    // 
 		QVarLengthArray<int> m_RPawnOffsets;	    // 
 		QVarLengthArray<int> m_MaOffsets;
@@ -0,0 +1,371 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "xiangqibitboard.h"
+#include <cstring>
+#include "westernboard.h"
+
+namespace Chess {
+
+namespace {
+
+const int s_files = 9;
+const int s_ranks = 10;
+
+struct Tables
+{
+	Tables();
+
+	XiangqiBitboard::Step ma[Bitboard::SquareCount][8];
+	XiangqiBitboard::Step xiang[Bitboard::SquareCount][4];
+	XiangqiBitboard::Step shi[Bitboard::SquareCount][4];
+	XiangqiBitboard::Step king[Bitboard::SquareCount][4];
+	XiangqiBitboard::Step pawn[2][Bitboard::SquareCount][3];
+
+	// Ma attackers of a square by the (diagonal) leg that blocks them
+	Bitboard maAttackers[Bitboard::SquareCount][4];
+	qint8 maLeg[Bitboard::SquareCount][4];
+	Bitboard pawnAttackers[2][Bitboard::SquareCount];
+
+	Bitboard ray[Bitboard::SquareCount][4];
+
+	// Che and Pao lines by file (or rank) and rank (or file) occupancy
+	quint16 rankChe[s_files][1 << s_files];
+	quint16 rankPao[s_files][1 << s_files];
+	quint16 fileChe[s_ranks][1 << s_ranks];
+	quint16 filePao[s_ranks][1 << s_ranks];
+	// A file occupancy spread over the a-file
+	Bitboard fileBits[1 << s_ranks];
+};
+
+inline bool isOnBoard(int file, int rank)
+{
+	return file >= 0 && file < s_files && rank >= 0 && rank < s_ranks;
+}
+
+inline int bitIndex(int file, int rank)
+{
+	return rank * s_files + file;
+}
+
+inline bool isInPalace(int file, int rank)
+{
+	return file >= 3 && file <= 5 && (rank <= 2 || rank >= 7);
+}
+
+XiangqiBitboard::Step makeStep(int file, int rank, int blockFile, int blockRank)
+{
+	XiangqiBitboard::Step step = { -1, -1 };
+	if (!isOnBoard(file, rank))
+		return step;
+
+	step.target = qint8(bitIndex(file, rank));
+	if (isOnBoard(blockFile, blockRank))
+		step.block = qint8(bitIndex(blockFile, blockRank));
+	return step;
+}
+
+/*
+ * Attacks from \a from along a line of \a size squares with occupancy
+ * \a occupancy: the first piece in each direction for a Che, the
+ * second one for a Pao. Empty squares are included for a Che.
+ */
+quint16 lineAttacks(int from, int size, int occupancy, bool pao)
+{
+	quint16 attacks = 0;
+	for (int step = -1; step <= 1; step += 2)
+	{
+		int pieces = 0;
+		for (int i = from + step; i >= 0 && i < size; i += step)
+		{
+			bool occupied = (occupancy >> i) & 1;
+			if (!pao)
+				attacks |= 1 << i;
+			else if (occupied && pieces == 1)
+				attacks |= 1 << i;
+			if (occupied && ++pieces == (pao ? 2 : 1))
+				break;
+		}
+	}
+
+	return attacks;
+}
+
+Tables::Tables()
+{
+	memset(maLeg, -1, sizeof(maLeg));
+
+	for (int rank = 0; rank < s_ranks; rank++)
+	{
+		for (int file = 0; file < s_files; file++)
+		{
+			int sq = bitIndex(file, rank);
+
+			// Same order as the offsets in WesternBoard
+			ma[sq][0] = makeStep(file - 1, rank + 2, file, rank + 1);
+			ma[sq][1] = makeStep(file + 1, rank + 2, file, rank + 1);
+			ma[sq][2] = makeStep(file - 2, rank + 1, file - 1, rank);
+			ma[sq][3] = makeStep(file + 2, rank + 1, file + 1, rank);
+			ma[sq][4] = makeStep(file - 2, rank - 1, file - 1, rank);
+			ma[sq][5] = makeStep(file + 2, rank - 1, file + 1, rank);
+			ma[sq][6] = makeStep(file - 1, rank - 2, file, rank - 1);
+			ma[sq][7] = makeStep(file + 1, rank - 2, file, rank - 1);
+
+			xiang[sq][0] = makeStep(file - 2, rank + 2, file - 1, rank + 1);
+			xiang[sq][1] = makeStep(file + 2, rank + 2, file + 1, rank + 1);
+			xiang[sq][2] = makeStep(file - 2, rank - 2, file - 1, rank - 1);
+			xiang[sq][3] = makeStep(file + 2, rank - 2, file + 1, rank - 1);
+			for (int i = 0; i < 4; i++)
+			{
+				// Xiang can't cross the river
+				int target = xiang[sq][i].target;
+				if (target >= 0 && (target / s_files <= 4) != (rank <= 4))
+					xiang[sq][i].target = -1;
+			}
+
+			shi[sq][0] = makeStep(file - 1, rank + 1, -1, -1);
+			shi[sq][1] = makeStep(file + 1, rank + 1, -1, -1);
+			shi[sq][2] = makeStep(file - 1, rank - 1, -1, -1);
+			shi[sq][3] = makeStep(file + 1, rank - 1, -1, -1);
+
+			king[sq][XiangqiBitboard::Up] = makeStep(file, rank + 1, -1, -1);
+			king[sq][XiangqiBitboard::Left] = makeStep(file - 1, rank, -1, -1);
+			king[sq][XiangqiBitboard::Right] = makeStep(file + 1, rank, -1, -1);
+			king[sq][XiangqiBitboard::Down] = makeStep(file, rank - 1, -1, -1);
+			for (int i = 0; i < 4; i++)
+			{
+				int target = shi[sq][i].target;
+				if (target >= 0 && !isInPalace(target % s_files, target / s_files))
+					shi[sq][i].target = -1;
+				target = king[sq][i].target;
+				if (target >= 0 && !isInPalace(target % s_files, target / s_files))
+					king[sq][i].target = -1;
+			}
+
+			// Pawns step sideways once they've crossed the river
+			bool crossed = rank >= 5;
+			pawn[Side::White][sq][0] = makeStep(file, rank + 1, -1, -1);
+			pawn[Side::White][sq][1] = makeStep(crossed ? file - 1 : -1, rank, -1, -1);
+			pawn[Side::White][sq][2] = makeStep(crossed ? file + 1 : -1, rank, -1, -1);
+			crossed = rank <= 4;
+			pawn[Side::Black][sq][0] = makeStep(file, rank - 1, -1, -1);
+			pawn[Side::Black][sq][1] = makeStep(crossed ? file - 1 : -1, rank, -1, -1);
+			pawn[Side::Black][sq][2] = makeStep(crossed ? file + 1 : -1, rank, -1, -1);
+
+			// A king is attacked by pawns beside it and in front of it
+			if (isOnBoard(file, rank - 1))
+				pawnAttackers[Side::White][sq] |= Bitboard::square(bitIndex(file, rank - 1));
+			if (isOnBoard(file, rank + 1))
+				pawnAttackers[Side::Black][sq] |= Bitboard::square(bitIndex(file, rank + 1));
+			for (int side = Side::White; side <= Side::Black; side++)
+			{
+				if (isOnBoard(file - 1, rank))
+					pawnAttackers[side][sq] |= Bitboard::square(bitIndex(file - 1, rank));
+				if (isOnBoard(file + 1, rank))
+					pawnAttackers[side][sq] |= Bitboard::square(bitIndex(file + 1, rank));
+			}
+
+			for (int i = rank + 1; i < s_ranks; i++)
+				ray[sq][XiangqiBitboard::Up] |= Bitboard::square(bitIndex(file, i));
+			for (int i = file - 1; i >= 0; i--)
+				ray[sq][XiangqiBitboard::Left] |= Bitboard::square(bitIndex(i, rank));
+			for (int i = file + 1; i < s_files; i++)
+				ray[sq][XiangqiBitboard::Right] |= Bitboard::square(bitIndex(i, rank));
+			for (int i = rank - 1; i >= 0; i--)
+				ray[sq][XiangqiBitboard::Down] |= Bitboard::square(bitIndex(file, i));
+		}
+	}
+
+	// A Ma's leg is next to the Ma and diagonal to its target
+	for (int from = 0; from < Bitboard::SquareCount; from++)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			const XiangqiBitboard::Step& step = ma[from][i];
+			if (step.target < 0)
+				continue;
+
+			int target = step.target;
+			int df = step.block % s_files - target % s_files;
+			int dr = step.block / s_files - target / s_files;
+			int leg = (dr > 0 ? 0 : 2) + (df > 0 ? 1 : 0);
+
+			maAttackers[target][leg] |= Bitboard::square(from);
+			maLeg[target][leg] = step.block;
+		}
+	}
+
+	for (int from = 0; from < s_files; from++)
+	{
+		for (int occupancy = 0; occupancy < (1 << s_files); occupancy++)
+		{
+			rankChe[from][occupancy] = lineAttacks(from, s_files, occupancy, false);
+			rankPao[from][occupancy] = lineAttacks(from, s_files, occupancy, true);
+		}
+	}
+	for (int from = 0; from < s_ranks; from++)
+	{
+		for (int occupancy = 0; occupancy < (1 << s_ranks); occupancy++)
+		{
+			fileChe[from][occupancy] = lineAttacks(from, s_ranks, occupancy, false);
+			filePao[from][occupancy] = lineAttacks(from, s_ranks, occupancy, true);
+		}
+	}
+	for (int occupancy = 0; occupancy < (1 << s_ranks); occupancy++)
+	{
+		for (int rank = 0; rank < s_ranks; rank++)
+		{
+			if ((occupancy >> rank) & 1)
+				fileBits[occupancy] |= Bitboard::square(bitIndex(0, rank));
+		}
+	}
+}
+
+const Tables& tables()
+{
+	static const Tables s_tables;
+	return s_tables;
+}
+
+} // anonymous namespace
+
+XiangqiBitboard::XiangqiBitboard()
+{
+	clear();
+}
+
+void XiangqiBitboard::clear()
+{
+	for (int side = Side::White; side <= Side::Black; side++)
+	{
+		for (int type = 0; type < PieceTypeCount; type++)
+			m_pieces[side][type] = Bitboard();
+	}
+	m_occupied = Bitboard();
+	memset(m_rankOccupancy, 0, sizeof(m_rankOccupancy));
+	memset(m_fileOccupancy, 0, sizeof(m_fileOccupancy));
+
+	// Make sure the tables are built before they are needed
+	tables();
+}
+
+void XiangqiBitboard::add(Side side, int type, int square)
+{
+	Q_ASSERT(type > 0 && type < PieceTypeCount);
+
+	Bitboard bit = Bitboard::square(square);
+	m_pieces[side][type] |= bit;
+	m_pieces[side][0] |= bit;
+	m_occupied |= bit;
+	m_rankOccupancy[square / s_files] |= 1 << (square % s_files);
+	m_fileOccupancy[square % s_files] |= 1 << (square / s_files);
+}
+
+void XiangqiBitboard::remove(Side side, int type, int square)
+{
+	Q_ASSERT(type > 0 && type < PieceTypeCount);
+
+	Bitboard bit = Bitboard::square(square);
+	m_pieces[side][type] ^= bit;
+	m_pieces[side][0] ^= bit;
+	m_occupied ^= bit;
+	m_rankOccupancy[square / s_files] &= ~(1 << (square % s_files));
+	m_fileOccupancy[square % s_files] &= ~(1 << (square / s_files));
+}
+
+Bitboard XiangqiBitboard::cheAttacks(int square) const
+{
+	const Tables& t = tables();
+	int file = square % s_files;
+	int rank = square / s_files;
+
+	Bitboard rankAttacks(t.rankChe[file][m_rankOccupancy[rank]], 0);
+	return (rankAttacks << (rank * s_files))
+	     | (t.fileBits[t.fileChe[rank][m_fileOccupancy[file]]] << file);
+}
+
+Bitboard XiangqiBitboard::paoCaptures(int square) const
+{
+	const Tables& t = tables();
+	int file = square % s_files;
+	int rank = square / s_files;
+
+	Bitboard rankAttacks(t.rankPao[file][m_rankOccupancy[rank]], 0);
+	return (rankAttacks << (rank * s_files))
+	     | (t.fileBits[t.filePao[rank][m_fileOccupancy[file]]] << file);
+}
+
+bool XiangqiBitboard::isAttacked(int square, Side side) const
+{
+	const Tables& t = tables();
+
+	// Che and the other king attack with the first piece on a line
+	Bitboard attackers = m_pieces[side][WesternBoard::Che]
+			   | m_pieces[side][WesternBoard::King];
+	if (!(cheAttacks(square) & attackers).isEmpty())
+		return true;
+	if (!(paoCaptures(square) & m_pieces[side][WesternBoard::Pao]).isEmpty())
+		return true;
+	if (!(t.pawnAttackers[side][square]
+	    & m_pieces[side][WesternBoard::Pawn]).isEmpty())
+		return true;
+
+	Bitboard ma = m_pieces[side][WesternBoard::Ma];
+	if (ma.isEmpty())
+		return false;
+	for (int i = 0; i < 4; i++)
+	{
+		int leg = t.maLeg[square][i];
+		if (leg >= 0 && !m_occupied.test(leg)
+		&&  !(t.maAttackers[square][i] & ma).isEmpty())
+			return true;
+	}
+
+	return false;
+}
+
+const Bitboard& XiangqiBitboard::ray(int square, Direction direction)
+{
+	return tables().ray[square][direction];
+}
+
+const XiangqiBitboard::Step* XiangqiBitboard::maSteps(int square)
+{
+	return tables().ma[square];
+}
+
+const XiangqiBitboard::Step* XiangqiBitboard::xiangSteps(int square)
+{
+	return tables().xiang[square];
+}
+
+const XiangqiBitboard::Step* XiangqiBitboard::shiSteps(int square)
+{
+	return tables().shi[square];
+}
+
+const XiangqiBitboard::Step* XiangqiBitboard::kingSteps(int square)
+{
+	return tables().king[square];
+}
+
+const XiangqiBitboard::Step* XiangqiBitboard::pawnSteps(Side side, int square)
+{
+	return tables().pawn[side][square];
+}
+
+} // namespace Chess
@@ -0,0 +1,230 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XIANGQIBITBOARD_H
+#define XIANGQIBITBOARD_H
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+#include "side.h"
+
+namespace Chess {
+
+/*!
+ * \brief A set of intersections of the 9x10 Xiangqi board
+ *
+ * Intersection (\a file, \a rank) is bit rank * 9 + file, with rank 0
+ * on Red's side, so the 90 intersections fit in two 64-bit words.
+ */
+class LIB_EXPORT Bitboard
+{
+	public:
+		/*! Number of intersections. */
+		enum { SquareCount = 90 };
+
+		/*! Creates an empty set. */
+		Bitboard() : m_lo(0), m_hi(0) {}
+		/*! Creates a set from its low and high words. */
+		Bitboard(quint64 lo, quint64 hi) : m_lo(lo), m_hi(hi) {}
+
+		/*! Returns a set containing only \a square. */
+		static Bitboard square(int square)
+		{
+			return square < 64 ? Bitboard(Q_UINT64_C(1) << square, 0)
+					   : Bitboard(0, Q_UINT64_C(1) << (square - 64));
+		}
+
+		/*! Returns true if the set is empty. */
+		bool isEmpty() const { return (m_lo | m_hi) == 0; }
+		/*! Returns true if \a square is in the set. */
+		bool test(int square) const
+		{
+			return square < 64 ? (m_lo >> square) & 1
+					   : (m_hi >> (square - 64)) & 1;
+		}
+		/*! Returns the number of intersections in the set. */
+		int count() const
+		{
+			return int(qPopulationCount(m_lo) + qPopulationCount(m_hi));
+		}
+		/*! Returns the lowest intersection; the set must not be empty. */
+		int first() const
+		{
+			return m_lo != 0 ? int(qCountTrailingZeroBits(m_lo))
+					 : 64 + int(qCountTrailingZeroBits(m_hi));
+		}
+		/*! Returns the highest intersection; the set must not be empty. */
+		int last() const
+		{
+			return m_hi != 0 ? 127 - int(qCountLeadingZeroBits(m_hi))
+					 : 63 - int(qCountLeadingZeroBits(m_lo));
+		}
+
+		/*! Returns the intersections that are not in the set. */
+		Bitboard operator~() const
+		{
+			return Bitboard(~m_lo, ~m_hi & ((Q_UINT64_C(1) << (SquareCount - 64)) - 1));
+		}
+		Bitboard operator&(const Bitboard& other) const
+		{
+			return Bitboard(m_lo & other.m_lo, m_hi & other.m_hi);
+		}
+		Bitboard operator|(const Bitboard& other) const
+		{
+			return Bitboard(m_lo | other.m_lo, m_hi | other.m_hi);
+		}
+		Bitboard operator^(const Bitboard& other) const
+		{
+			return Bitboard(m_lo ^ other.m_lo, m_hi ^ other.m_hi);
+		}
+		Bitboard& operator&=(const Bitboard& other)
+		{
+			m_lo &= other.m_lo;
+			m_hi &= other.m_hi;
+			return *this;
+		}
+		Bitboard& operator|=(const Bitboard& other)
+		{
+			m_lo |= other.m_lo;
+			m_hi |= other.m_hi;
+			return *this;
+		}
+		Bitboard& operator^=(const Bitboard& other)
+		{
+			m_lo ^= other.m_lo;
+			m_hi ^= other.m_hi;
+			return *this;
+		}
+		/*! Returns the set moved \a n intersections up (0 <= n < 128). */
+		Bitboard operator<<(int n) const
+		{
+			if (n == 0)
+				return *this;
+			if (n >= 64)
+				return Bitboard(0, m_lo << (n - 64));
+			return Bitboard(m_lo << n, (m_hi << n) | (m_lo >> (64 - n)));
+		}
+
+	private:
+		quint64 m_lo;
+		quint64 m_hi;
+};
+
+/*!
+ * \brief Bitboards of a Xiangqi position
+ *
+ * XiangqiBitboard keeps one Bitboard per side and piece type and the
+ * occupancy of every rank and file. The move and attack tables are
+ * precomputed once per process: the leaper tables (Ma, Xiang, Shi,
+ * King and Pawn) per intersection, and the Che and Pao lines per
+ * intersection and rank or file occupancy.
+ *
+ * Squares are Bitboard intersections, piece types are
+ * WesternBoard::WesternPieceType values.
+ */
+class LIB_EXPORT XiangqiBitboard
+{
+	public:
+		/*! Number of piece types, including Piece::NoPiece. */
+		enum { PieceTypeCount = 8 };
+
+		/*! Line directions, in WesternBoard's Che offset order. */
+		enum Direction
+		{
+			Up,	//!< Towards Black (rank + 1)
+			Left,	//!< Towards the a-file (file - 1)
+			Right,	//!< Towards the i-file (file + 1)
+			Down	//!< Towards Red (rank - 1)
+		};
+
+		/*! One step of a leaper. */
+		struct Step
+		{
+			/*! Target intersection, or -1 if off the board. */
+			qint8 target;
+			/*!
+			 * The intersection that must be empty for the
+			 * step, or -1 if the step can't be blocked.
+			 */
+			qint8 block;
+		};
+
+		/*! Creates an empty position. */
+		XiangqiBitboard();
+
+		/*! Removes every piece. */
+		void clear();
+		/*! Adds a piece of \a side and \a type at \a square. */
+		void add(Side side, int type, int square);
+		/*! Removes the piece of \a side and \a type at \a square. */
+		void remove(Side side, int type, int square);
+
+		/*! Returns the occupied intersections. */
+		Bitboard occupied() const { return m_occupied; }
+		/*! Returns the pieces of \a side. */
+		Bitboard pieces(Side side) const { return m_pieces[side][0]; }
+		/*! Returns the pieces of \a side and \a type. */
+		Bitboard pieces(Side side, int type) const
+		{
+			return m_pieces[side][type];
+		}
+
+		/*!
+		 * Returns the intersections a Che at \a square attacks: the
+		 * empty ones and the first piece in each direction.
+		 */
+		Bitboard cheAttacks(int square) const;
+		/*!
+		 * Returns the intersections a Pao at \a square can capture:
+		 * the first piece behind a screen in each direction.
+		 */
+		Bitboard paoCaptures(int square) const;
+		/*!
+		 * Returns true if any piece of \a side attacks the king at
+		 * \a square.
+		 *
+		 * Pawns next to \a square attack it sideways whether or not
+		 * they have crossed the river, which they always have when
+		 * the king is in its palace.
+		 */
+		bool isAttacked(int square, Side side) const;
+
+		/*!
+		 * Returns the intersections from \a square to the edge of
+		 * the board in \a direction, \a square excluded.
+		 */
+		static const Bitboard& ray(int square, Direction direction);
+		/*! Returns the eight Ma steps from \a square. */
+		static const Step* maSteps(int square);
+		/*! Returns the four Xiang steps from \a square. */
+		static const Step* xiangSteps(int square);
+		/*! Returns the four Shi steps from \a square. */
+		static const Step* shiSteps(int square);
+		/*! Returns the four King steps from \a square. */
+		static const Step* kingSteps(int square);
+		/*! Returns the three Pawn steps of \a side from \a square. */
+		static const Step* pawnSteps(Side side, int square);
+
+	private:
+		Bitboard m_pieces[2][PieceTypeCount];
+		Bitboard m_occupied;
+		quint16 m_rankOccupancy[10];
+		quint16 m_fileOccupancy[9];
+};
+
+} // namespace Chess
+#endif // XIANGQIBITBOARD_H
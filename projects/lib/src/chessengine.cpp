@@ -17,11 +17,15 @@
 */
 
 #include "chessengine.h"
+#include <QDateTime>
 #include <QIODevice>
+#include <QMetaMethod>
 #include <QTimer>
 #include <QStringRef>
 #include <QtAlgorithms>
 #include "engineoption.h"
+#include "enginetranscript.h"
+#include "linetimestampsource.h"
 
 
 int ChessEngine::s_count = 0;
@@ -81,7 +85,11 @@ ChessEngine::ChessEngine(QObject* parent)
 	  m_idleTimer(new QTimer(this)),
 	  m_protocolStartTimer(new QTimer(this)),
 	  m_ioDevice(nullptr),
-	  m_restartMode(EngineConfiguration::RestartAuto)
+	  m_goIndex(-1),
+	  m_restartMode(EngineConfiguration::RestartAuto),
+	  m_transcript(nullptr),
+	  m_timestamps(nullptr),
+	  m_lineTime(-1)
 {
 	m_pingTimer->setSingleShot(true);
 	m_pingTimer->setInterval(15000);
@@ -104,6 +112,37 @@ ChessEngine::ChessEngine(QObject* parent)
 ChessEngine::~ChessEngine()
 {
 	qDeleteAll(m_options);
+	delete m_transcript;
+}
+
+bool ChessEngine::hasDebugReceivers() const
+{
+	// Formatting every line is wasted work if nobody shows it
+	static const QMetaMethod s_debugMessage =
+		QMetaMethod::fromSignal(&ChessPlayer::debugMessage);
+	return isSignalConnected(s_debugMessage);
+}
+
+bool ChessEngine::dumpTranscript(const QString& fileName) const
+{
+	if (m_transcript == nullptr)
+		return false;
+
+	QString file(fileName.isEmpty() ? m_transcriptFile : fileName);
+	if (file.isEmpty())
+		return false;
+
+	QString title = QString("%1(%2) %3")
+		.arg(name())
+		.arg(m_id)
+		.arg(QDateTime::currentDateTime().toString(Qt::ISODate));
+	if (!m_transcript->dump(file, title))
+	{
+		qWarning("Cannot write the transcript of engine %s(%d) to %s",
+			 qUtf8Printable(name()), m_id, qUtf8Printable(file));
+		return false;
+	}
+	return true;
 }
 
 QIODevice* ChessEngine::device() const
@@ -117,6 +156,7 @@ void ChessEngine::setDevice(QIODevice* device)
 
 	m_ioDevice = device;
 	m_ioDevice->setParent(this);
+	m_timestamps = dynamic_cast<LineTimestampSource*>(device);
 
 	connect(m_ioDevice, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
 	connect(m_ioDevice, SIGNAL(readChannelFinished()), this, SLOT(onCrashed()));
@@ -127,6 +167,10 @@ void ChessEngine::applyConfiguration(const EngineConfiguration& configuration)
 	if (!configuration.name().isEmpty())
 		setName(configuration.name());
 
+	m_transcriptFile = configuration.transcriptFile();
+	if (!m_transcriptFile.isEmpty() && m_transcript == nullptr)
+		m_transcript = new EngineTranscript();
+
 	const auto initStrings = configuration.initStrings();
 	for (const QString& str : initStrings)
 		write(str);
@@ -322,7 +366,7 @@ bool ChessEngine::stopThinking()
 		// pondering state and is being pinged, we can assume that
 		// whatever is in the write buffer is obsolete by now because
 		// the engine is being told to stop.
-		m_writeBuffer.clear();
+		clearWriteBuffer();
 	}
 	return false;
 }
@@ -333,7 +377,7 @@ void ChessEngine::onIdleTimeout()
 	if (state() != Thinking || m_pinging)
 		return;
 
-	m_writeBuffer.clear();
+	clearWriteBuffer();
 	kill();
 
 	forfeit(Chess::Result::StalledConnection);
@@ -350,7 +394,7 @@ void ChessEngine::kill()
 	m_pinging = false;
 	m_pingTimer->stop();
 	m_protocolStartTimer->stop();
-	m_writeBuffer.clear();
+	clearWriteBuffer();
 
 	disconnect(m_ioDevice, SIGNAL(readChannelFinished()),
 		   this, SLOT(onCrashed()));
@@ -359,6 +403,12 @@ void ChessEngine::kill()
 	ChessPlayer::kill();
 }
 
+void ChessEngine::onCrashed()
+{
+	dumpTranscript();
+	ChessPlayer::onCrashed();
+}
+
 void ChessEngine::onTimeout()
 {
 	stopThinking();
@@ -414,7 +464,8 @@ void ChessEngine::onPingTimeout()
 	         qUtf8Printable(errorString()));
 
 	m_pinging = false;
-	m_writeBuffer.clear();
+	clearWriteBuffer();
+	dumpTranscript();
 	kill();
 
 	forfeit(Chess::Result::StalledConnection);
@@ -432,33 +483,62 @@ void ChessEngine::write(const QString& data, WriteMode mode)
 	}
 
 	Q_ASSERT(m_ioDevice->isWritable());
-	emit debugMessage(QString(">%1(%2): %3")
-			  .arg(name())
-			  .arg(m_id)
-			  .arg(data));
+	if (hasDebugReceivers())
+		emit debugMessage(QString(">%1(%2): %3")
+				  .arg(name())
+				  .arg(m_id)
+				  .arg(data));
 
-	if (m_ioDevice->write(data.toLatin1() + "\n") == -1)
+	const QByteArray line(data.toLatin1() + "\n");
+	if (m_transcript != nullptr)
+		m_transcript->append(EngineTranscript::Input, line);
+	if (m_ioDevice->write(line) == -1)
 		qWarning("Writing to engine %s(%d) failed",
 			 qUtf8Printable(name()), m_id);
 }
 
+void ChessEngine::writeGo(const QString& data)
+{
+	bool buffered = state() == NotStarted || m_pinging;
+	if (buffered && state() != Disconnected)
+		m_goIndex = m_writeBuffer.size();
+
+	write(data);
+	if (!buffered)
+		setClockStartTime(TimeControl::currentTime());
+}
+
+qint64 ChessEngine::replyTime() const
+{
+	return m_lineTime;
+}
+
 void ChessEngine::onReadyRead()
 {
-	while (m_ioDevice->isReadable() && m_ioDevice->canReadLine())
+	while (m_ioDevice->isReadable() && m_lineReader.readLine(m_ioDevice))
 	{
-		QString line = QString(m_ioDevice->readLine());
-		if (line.endsWith('\n'))
-			line.chop(1);
-		if (line.endsWith('\r'))
-			line.chop(1);
-		if (line.isEmpty())
+		// Every line has a timestamp, so take it even if the line
+		// is skipped
+		m_lineTime = -1;
+		if (m_timestamps != nullptr)
+			m_lineTime = m_timestamps->takeLineTimestamp();
+		if (m_lineTime < 0)
+			m_lineTime = TimeControl::currentTime();
+
+		if (m_transcript != nullptr)
+			m_transcript->append(EngineTranscript::Output,
+					     m_lineReader.data(),
+					     m_lineReader.size());
+		if (m_lineReader.isEmpty())
 			continue;
 
-		emit debugMessage(QString("<%1(%2): %3")
-				  .arg(name())
-				  .arg(m_id)
-				  .arg(line));
-		parseLine(line);
+		if (hasDebugReceivers())
+			emit debugMessage(QString("<%1(%2): %3")
+					  .arg(name())
+					  .arg(m_id)
+					  .arg(m_lineReader.toString()));
+		if (!parseRawLine(m_lineReader))
+			parseLine(m_lineReader.toString());
 
 		if (m_idleTimer->isActive())
 		{
@@ -468,6 +548,13 @@ void ChessEngine::onReadyRead()
 				m_idleTimer->stop();
 		}
 	}
+	m_lineTime = -1;
+}
+
+bool ChessEngine::parseRawLine(const EngineLineReader& line)
+{
+	Q_UNUSED(line);
+	return false;
 }
 
 void ChessEngine::flushWriteBuffer()
@@ -475,14 +562,22 @@ void ChessEngine::flushWriteBuffer()
 	if (m_pinging || state() == NotStarted)
 		return;
 
-	for (const QString& line : qAsConst(m_writeBuffer))
-		write(line);
-	m_writeBuffer.clear();
+	const QStringList buffer(m_writeBuffer);
+	int goIndex = m_goIndex;
+	clearWriteBuffer();
+
+	for (int i = 0; i < buffer.size(); i++)
+	{
+		write(buffer.at(i));
+		if (i == goIndex)
+			setClockStartTime(TimeControl::currentTime());
+	}
 }
 
 void ChessEngine::clearWriteBuffer()
 {
 	m_writeBuffer.clear();
+	m_goIndex = -1;
 }
 
 void ChessEngine::onProtocolStartTimeout()
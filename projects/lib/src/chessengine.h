@@ -23,9 +23,12 @@
 #include <QVariant>
 #include <QStringList>
 #include "engineconfiguration.h"
+#include "enginelinereader.h"
+class LineTimestampSource;
 
 class QIODevice;
 class EngineOption;
+class EngineTranscript;
 
 
 /*!
@@ -60,7 +63,12 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 
 		/*! Returns the current device associated with the engine. */
 		QIODevice* device() const;
-		/*! Sets the current device to \a device. */
+		/*!
+		 * Sets the current device to \a device.
+		 *
+		 * If \a device is also a LineTimestampSource, the engine's
+		 * moves are timed by their arrival at the device.
+		 */
 		void setDevice(QIODevice* device);
 
 		// Inherited from ChessPlayer
@@ -118,6 +126,17 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		/*! Returns a list of supported chess variants. */
 		QStringList variants() const;
 
+		/*!
+		 * Appends the engine's I/O transcript to \a fileName, or
+		 * to the configured transcript file if \a fileName is
+		 * empty.
+		 *
+		 * Returns false if the engine has no transcript or it
+		 * can't be written.
+		 * \sa EngineConfiguration::transcriptFile()
+		 */
+		bool dumpTranscript(const QString& fileName = QString()) const;
+
 	public slots:
 		// Inherited from ChessPlayer
 		virtual void go();
@@ -164,6 +183,16 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 
 		/*! Parses a line of input from the engine. */
 		virtual void parseLine(const QString& line) = 0;
+		/*!
+		 * Parses a line of input from the engine without converting
+		 * it to a QString first. This is meant for the lines engines
+		 * send most often, like thinking output.
+		 *
+		 * Returns false if the line wasn't handled, in which case it
+		 * is passed to parseLine(). The default implementation
+		 * always returns false.
+		 */
+		virtual bool parseRawLine(const EngineLineReader& line);
 
 		/*!
 		 * Sends a ping command to the engine.
@@ -231,9 +260,20 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		 */
 		int id() const;
 
+		// Inherited from ChessPlayer
+		virtual qint64 replyTime() const;
+
+		/*!
+		 * Writes \a data, the command that tells the engine to start
+		 * thinking, and starts charging the engine's thinking time
+		 * when \a data is actually written to the device.
+		 */
+		void writeGo(const QString& data);
+
 	protected slots:
 		// Inherited from ChessPlayer
 		virtual void onTimeout();
+		virtual void onCrashed();
 
 		/*! Reads input from the engine. */
 		void onReadyRead();
@@ -277,6 +317,8 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 	private:
 		static int s_count;
 
+		bool hasDebugReceivers() const;
+
 		int m_id;
 		State m_pingState;
 		bool m_pinging;
@@ -288,10 +330,16 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		QTimer* m_protocolStartTimer;
 		QIODevice *m_ioDevice;
 		QStringList m_writeBuffer;
+		int m_goIndex;
 		QStringList m_variants;
 		QList<EngineOption*> m_options;
 		QMap<QString, QVariant> m_optionBuffer;
 		EngineConfiguration::RestartMode m_restartMode;
+		EngineTranscript* m_transcript;
+		EngineLineReader m_lineReader;
+		LineTimestampSource* m_timestamps;
+		qint64 m_lineTime;
+		QString m_transcriptFile;
 };
 
 #endif // CHESSENGINE_H
@@ -16,6 +16,7 @@
 */
 
 #include "chessgame.h"
+#include <QElapsedTimer>
 #include <QThread>
 #include <QTimer>
 #include "board/board.h"
@@ -63,6 +64,8 @@ ChessGame::ChessGame(Chess::Board* board, PgnGame* pgn, QObject* parent)
 	  m_pgnInitialized(false),
 	  m_bookOwnership(false),
 	  m_boardShouldBeFlipped(false),
+	  m_resultCheckTime(0),
+	  m_resultCheckCount(0),
 	  m_pgn(pgn)
 {
 	Q_ASSERT(pgn != nullptr);
@@ -72,6 +75,9 @@ ChessGame::ChessGame(Chess::Board* board, PgnGame* pgn, QObject* parent)
 		m_player[i] = nullptr;
 		m_book[i] = nullptr;
 		m_bookDepth[i] = 0;
+		m_clockOverhead[i] = 0;
+		m_clockLag[i] = 0;
+		m_maxClockLag[i] = 0;
 	}
 }
 
@@ -140,6 +146,34 @@ const QMap<int,int>& ChessGame::scores() const
 	return m_scores;
 }
 
+qint64 ChessGame::resultCheckTime() const
+{
+	return m_resultCheckTime;
+}
+
+int ChessGame::resultCheckCount() const
+{
+	return m_resultCheckCount;
+}
+
+qint64 ChessGame::clockOverhead(Chess::Side side) const
+{
+	Q_ASSERT(!side.isNull());
+	return m_clockOverhead[side];
+}
+
+qint64 ChessGame::clockLag(Chess::Side side) const
+{
+	Q_ASSERT(!side.isNull());
+	return m_clockLag[side];
+}
+
+int ChessGame::maxClockLag(Chess::Side side) const
+{
+	Q_ASSERT(!side.isNull());
+	return m_maxClockLag[side];
+}
+
 Chess::Result ChessGame::result() const
 {
 	return m_result;
@@ -262,12 +296,24 @@ void ChessGame::onMoveMade(const Chess::Move& move)
 		return;
 	}
 
+	Chess::Side side(m_board->sideToMove());
+	const TimeControl* tc = sender->timeControl();
+	m_clockOverhead[side] += tc->lastMoveOverhead();
+	m_clockLag[side] += tc->lastMoveLag();
+	m_maxClockLag[side] = qMax(m_maxClockLag[side], tc->lastMoveLag());
+
 	m_scores[m_moves.size()] = sender->evaluation().score();
 	m_moves.append(move);
 	addPgnMove(move, evalString(sender->evaluation()));
 
-	// Get the result before sending the move to the opponent
+	// The opponent needs the position before the move, the result
+	// needs the position after it
+	ChessPlayer* player = playerToWait();
+	player->makeMove(move);
 	m_board->makeMove(move);
+
+	QElapsedTimer timer;
+	timer.start();
 	m_result = m_board->result();
 	if (m_result.isNone())
 	{
@@ -277,11 +323,8 @@ void ChessGame::onMoveMade(const Chess::Move& move)
 		m_adjudicator.addEval(m_board, sender->evaluation());
 		m_result = m_adjudicator.result();
 	}
-	m_board->undoMove();
-
-	ChessPlayer* player = playerToWait();
-	player->makeMove(move);
-	m_board->makeMove(move);
+	m_resultCheckTime += timer.nsecsElapsed();
+	m_resultCheckCount++;
 
 	if (m_result.isNone())
 	{
@@ -59,6 +59,25 @@ class LIB_EXPORT ChessGame : public QObject
 		const QVector<Chess::Move>& moves() const;
 		const QMap<int,int>& scores() const;
 		Chess::Result result() const;
+		/*!
+		 * Returns the total time in nanoseconds spent checking for
+		 * the end of the game after the players' moves.
+		 */
+		qint64 resultCheckTime() const;
+		/*! Returns the number of moves checked for the end of the game. */
+		int resultCheckCount() const;
+		/*!
+		 * Returns the total time in milliseconds that \a side's
+		 * clock ran before the player got the request to move.
+		 */
+		qint64 clockOverhead(Chess::Side side) const;
+		/*!
+		 * Returns the total time in milliseconds between the arrival
+		 * of \a side's moves and stopping the clock.
+		 */
+		qint64 clockLag(Chess::Side side) const;
+		/*! Returns the longest clock lag of a single move by \a side. */
+		int maxClockLag(Chess::Side side) const;
 
 		void setError(const QString& message);
 		void setPlayer(Chess::Side side, ChessPlayer* player);
@@ -142,6 +161,11 @@ class LIB_EXPORT ChessGame : public QObject
 		bool m_pgnInitialized;
 		bool m_bookOwnership;
 		bool m_boardShouldBeFlipped;
+		qint64 m_resultCheckTime;
+		int m_resultCheckCount;
+		qint64 m_clockOverhead[2];
+		qint64 m_clockLag[2];
+		int m_maxClockLag[2];
 		QString m_error;
 		QString m_startingFen;
 		Chess::Result m_result;
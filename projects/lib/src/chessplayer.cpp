@@ -134,6 +134,24 @@ void ChessPlayer::startClock()
 	}
 }
 
+void ChessPlayer::setClockStartTime(qint64 timestamp)
+{
+	if (m_state != Thinking)
+		return;
+
+	m_timeControl.setStartTime(timestamp);
+	if (m_timer->isActive())
+	{
+		int t = m_timeControl.activeTimeLeft() + m_timeControl.expiryMargin();
+		m_timer->start(qMax(t, 0) + 200);
+	}
+}
+
+qint64 ChessPlayer::replyTime() const
+{
+	return -1;
+}
+
 void ChessPlayer::makeBookMove(const Chess::Move& move)
 {
 	m_timeControl.startTimer();
@@ -244,7 +262,7 @@ void ChessPlayer::claimResult(const Chess::Result& result)
 		return;
 
 	m_timer->stop();
-	m_timeControl.update();
+	m_timeControl.update(true, replyTime());
 	if (m_state == Thinking)
 		setState(Observing);
 	m_claimedResult = true;
@@ -268,7 +286,7 @@ void ChessPlayer::emitMove(const Chess::Move& move)
 	if (m_state == Thinking)
 		setState(Observing);
 
-	m_timeControl.update();
+	m_timeControl.update(true, replyTime());
 	m_eval.setTime(m_timeControl.lastMoveTime());
 	m_eval.setIsTrusted(!areClaimsValidated());
 
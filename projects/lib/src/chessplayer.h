@@ -263,6 +263,20 @@ class LIB_EXPORT ChessPlayer : public QObject
 		 */
 		virtual bool canPlayAfterTimeout() const;
 
+		/*!
+		 * Returns the TimeControl::currentTime() when the player's
+		 * latest move or result claim arrived, or -1 if it's being
+		 * processed as it arrives.
+		 *
+		 * The default implementation returns -1.
+		 */
+		virtual qint64 replyTime() const;
+		/*!
+		 * Starts charging the thinking time at \a timestamp, when the
+		 * player actually got the request to move.
+		 */
+		void setClockStartTime(qint64 timestamp);
+
 		/*! Emits the resultClaim() signal with result \a result. */
 		void claimResult(const Chess::Result& result);
 		/*!
@@ -0,0 +1,332 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "compiledbook.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVector>
+#include <QWeakPointer>
+
+namespace {
+
+const char s_magic[8] = { 'C', 'C', 'X', 'Q', 'B', 'O', 'O', 'K' };
+const quint32 s_version = 1;
+const quint32 s_byteOrder = 0x01020304;
+// Aim for this many records per bucket
+const int s_bucketSize = 4;
+const int s_maxBucketBits = 24;
+
+struct Header
+{
+	char magic[8];
+	quint32 version;
+	quint32 byteOrder;
+	quint32 count;
+	quint32 bucketBits;
+	quint32 recordSize;
+	quint32 reserved;
+};
+
+Q_STATIC_ASSERT(sizeof(Header) == 32);
+Q_STATIC_ASSERT(sizeof(CompiledBook::Record) == 16);
+
+QMutex s_openMutex;
+QHash<QString, QWeakPointer<const CompiledBook>> s_openBooks;
+
+int bucketTableSize(int bucketBits)
+{
+	// One start index per bucket plus an end marker, padded so that
+	// the records stay 8-byte aligned.
+	int size = ((1 << bucketBits) + 1) * int(sizeof(quint32));
+	return (size + 7) & ~7;
+}
+
+inline quint32 bucket(quint64 key, int bucketBits)
+{
+	return bucketBits == 0 ? 0 : quint32(key >> (64 - bucketBits));
+}
+
+// OpeningBook binds keys that are negative as signed integers as the
+// double with the same bit pattern, so that's how they are stored in
+// bhobk.vkey. SQLite may have turned an integral double back into an
+// integer, which converts back to the same double.
+quint64 keyFromSql(const QVariant& value)
+{
+	double dkey;
+	if (value.type() == QVariant::Double)
+		dkey = value.toDouble();
+	else
+	{
+		qint64 ikey = value.toLongLong();
+		if (ikey > 0)
+			return quint64(ikey);
+		dkey = double(ikey);
+	}
+
+	quint64 key;
+	memcpy(&key, &dkey, sizeof(key));
+	return key;
+}
+
+bool setError(QString* error, const QString& message)
+{
+	if (error != nullptr)
+		*error = message;
+	return false;
+}
+
+} // anonymous namespace
+
+CompiledBook::CompiledBook(const QString& fileName)
+	: m_file(fileName),
+	  m_bucketBits(0),
+	  m_count(0),
+	  m_buckets(nullptr),
+	  m_records(nullptr)
+{
+}
+
+bool CompiledBook::isCompiledBook(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	char magic[sizeof(s_magic)];
+	return file.read(magic, sizeof(magic)) == qint64(sizeof(magic))
+	    && memcmp(magic, s_magic, sizeof(magic)) == 0;
+}
+
+QSharedPointer<const CompiledBook> CompiledBook::open(const QString& fileName)
+{
+	QString path = QFileInfo(fileName).canonicalFilePath();
+	if (path.isEmpty())
+		return QSharedPointer<const CompiledBook>();
+
+	QMutexLocker locker(&s_openMutex);
+
+	QSharedPointer<const CompiledBook> book = s_openBooks.value(path).toStrongRef();
+	if (!book.isNull())
+		return book;
+
+	CompiledBook* newBook = new CompiledBook(path);
+	if (!newBook->map())
+	{
+		delete newBook;
+		return QSharedPointer<const CompiledBook>();
+	}
+
+	book = QSharedPointer<const CompiledBook>(newBook);
+	s_openBooks[path] = book;
+	return book;
+}
+
+bool CompiledBook::map()
+{
+	if (!m_file.open(QIODevice::ReadOnly))
+		return false;
+
+	qint64 size = m_file.size();
+	if (size < qint64(sizeof(Header)))
+		return false;
+
+	const uchar* data = m_file.map(0, size);
+	if (data == nullptr)
+		return false;
+
+	Header header;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, s_magic, sizeof(s_magic)) != 0
+	||  header.version != s_version
+	||  header.byteOrder != s_byteOrder
+	||  header.recordSize != sizeof(Record)
+	||  header.bucketBits > quint32(s_maxBucketBits)
+	||  header.count > quint32(INT_MAX))
+	{
+		qWarning("Unsupported compiled opening book %s",
+			 qUtf8Printable(m_file.fileName()));
+		return false;
+	}
+
+	int tableSize = bucketTableSize(int(header.bucketBits));
+	qint64 expected = qint64(sizeof(Header)) + tableSize
+			+ qint64(header.count) * qint64(sizeof(Record));
+	if (size != expected)
+	{
+		qWarning("Truncated compiled opening book %s",
+			 qUtf8Printable(m_file.fileName()));
+		return false;
+	}
+
+	m_bucketBits = int(header.bucketBits);
+	m_count = int(header.count);
+	m_buckets = reinterpret_cast<const quint32*>(data + sizeof(Header));
+	m_records = reinterpret_cast<const Record*>(data + sizeof(Header) + tableSize);
+
+	// The record ranges of the buckets must stay inside the file
+	quint32 previous = 0;
+	for (int i = 0; i <= 1 << m_bucketBits; i++)
+	{
+		quint32 offset = m_buckets[i];
+		if (offset < previous || offset > header.count)
+		{
+			qWarning("Corrupt compiled opening book %s",
+				 qUtf8Printable(m_file.fileName()));
+			return false;
+		}
+		previous = offset;
+	}
+
+	return previous == header.count;
+}
+
+bool CompiledBook::compile(const QString& sqlFileName,
+			   const QString& fileName,
+			   QString* error)
+{
+	QVector<Record> records;
+	const QString connectionName = QString("CompiledBook:%1").arg(sqlFileName);
+	{
+		QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+		db.setDatabaseName(sqlFileName);
+		db.setConnectOptions("QSQLITE_OPEN_READONLY");
+		if (!db.open())
+		{
+			QString message = db.lastError().text();
+			db = QSqlDatabase();
+			QSqlDatabase::removeDatabase(connectionName);
+			return setError(error, message);
+		}
+
+		QSqlQuery query(db);
+		query.setForwardOnly(true);
+		if (!query.exec("select vkey, vmove, vscore, vvalid from bhobk"))
+		{
+			QString message = query.lastError().text();
+			query = QSqlQuery();
+			db.close();
+			db = QSqlDatabase();
+			QSqlDatabase::removeDatabase(connectionName);
+			return setError(error, message);
+		}
+
+		while (query.next())
+		{
+			Record record;
+			record.key = keyFromSql(query.value(0));
+			record.move = quint16(query.value(1).toInt());
+			record.valid = quint16(qBound(0, query.value(3).toInt(), 0xffff));
+			record.score = query.value(2).toInt();
+			records << record;
+		}
+		query = QSqlQuery();
+		db.close();
+	}
+	QSqlDatabase::removeDatabase(connectionName);
+
+	std::sort(records.begin(), records.end(),
+		  [](const Record& a, const Record& b)
+	{
+		if (a.key != b.key)
+			return a.key < b.key;
+		return a.move < b.move;
+	});
+
+	int bucketBits = 0;
+	while (bucketBits < s_maxBucketBits
+	&&     (records.size() >> bucketBits) > s_bucketSize)
+		bucketBits++;
+
+	QVector<quint32> buckets(bucketTableSize(bucketBits) / int(sizeof(quint32)), 0);
+	const int bucketCount = 1 << bucketBits;
+	int index = 0;
+	for (int i = 0; i <= bucketCount; i++)
+	{
+		while (index < records.size()
+		&&     bucket(records.at(index).key, bucketBits) < quint32(i))
+			index++;
+		buckets[i] = quint32(index);
+	}
+
+	Header header;
+	memcpy(header.magic, s_magic, sizeof(s_magic));
+	header.version = s_version;
+	header.byteOrder = s_byteOrder;
+	header.count = quint32(records.size());
+	header.bucketBits = quint32(bucketBits);
+	header.recordSize = sizeof(Record);
+	header.reserved = 0;
+
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly))
+		return setError(error, file.errorString());
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(buckets.constData()),
+		   buckets.size() * int(sizeof(quint32)));
+	file.write(reinterpret_cast<const char*>(records.constData()),
+		   records.size() * int(sizeof(Record)));
+	if (!file.commit())
+		return setError(error, file.errorString());
+
+	return true;
+}
+
+Chess::GenericMove CompiledBook::genericMove(quint16 move)
+{
+	// bhobk squares are on a 16x16 board with files starting from 3
+	int from = move >> 8;
+	int to = move & 0xff;
+
+	Chess::Square sqfrom(from % 16 - 3, 12 - from / 16);
+	Chess::Square sqto(to % 16 - 3, 12 - to / 16);
+
+	return Chess::GenericMove(sqfrom, sqto);
+}
+
+int CompiledBook::count() const
+{
+	return m_count;
+}
+
+const CompiledBook::Record* CompiledBook::find(quint64 key, int* count) const
+{
+	quint32 b = bucket(key, m_bucketBits);
+	const Record* begin = m_records + m_buckets[b];
+	const Record* end = m_records + m_buckets[b + 1];
+
+	const Record* first = std::lower_bound(begin, end, key,
+		[](const Record& record, quint64 key)
+	{
+		return record.key < key;
+	});
+
+	const Record* last = first;
+	while (last != end && last->key == key)
+		++last;
+
+	*count = int(last - first);
+	return first == last ? nullptr : first;
+}
@@ -0,0 +1,109 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPILEDBOOK_H
+#define COMPILEDBOOK_H
+
+#include <QtGlobal>
+#include <QFile>
+#include <QSharedPointer>
+#include "board/genericmove.h"
+
+/*!
+ * \brief A read-only, memory-mapped opening book.
+ *
+ * CompiledBook is a compact binary form of a bhobk SQLite opening
+ * book. The file holds a small header, a bucket table indexed by the
+ * top bits of the Zobrist key and the book rows sorted by key, so a
+ * probe touches one bucket and a handful of records without any SQL
+ * or heap allocation.
+ *
+ * The file is mapped, not read: every OpeningBook that opens the same
+ * file in a process shares one mapping, and the operating system
+ * shares the pages between processes.
+ *
+ * A compiled book is created from an SQLite book with compile().
+ */
+class LIB_EXPORT CompiledBook
+{
+	public:
+		/*!
+		 * A book row, stored as-is in the file.
+		 *
+		 * \note The fields are little-endian.
+		 */
+		struct Record
+		{
+			/*! Zobrist key of the position. */
+			quint64 key;
+			/*! Move in bhobk encoding (from << 8 | to). */
+			quint16 move;
+			/*! The bhobk vvalid column, clamped to 16 bits. */
+			quint16 valid;
+			/*! The bhobk vscore column. */
+			qint32 score;
+		};
+
+		/*! Returns true if \a fileName starts with a compiled book header. */
+		static bool isCompiledBook(const QString& fileName);
+
+		/*!
+		 * Opens the compiled book \a fileName.
+		 *
+		 * Returns a null pointer if the file can't be mapped or
+		 * isn't a valid compiled book. If the book is already open
+		 * somewhere in the process, the same object is returned.
+		 */
+		static QSharedPointer<const CompiledBook> open(const QString& fileName);
+
+		/*!
+		 * Compiles the SQLite book \a sqlFileName into \a fileName.
+		 *
+		 * Returns true if successful; otherwise returns false and
+		 * sets \a error (if not null) to a description of the problem.
+		 */
+		static bool compile(const QString& sqlFileName,
+				    const QString& fileName,
+				    QString* error = nullptr);
+
+		/*! Converts a bhobk move \a move to a generic move. */
+		static Chess::GenericMove genericMove(quint16 move);
+
+		/*! Returns the number of records in the book. */
+		int count() const;
+
+		/*!
+		 * Returns the first record with key \a key and sets \a count
+		 * to the number of consecutive records sharing the key.
+		 *
+		 * Returns nullptr and sets \a count to 0 if there is no
+		 * such record.
+		 */
+		const Record* find(quint64 key, int* count) const;
+
+	private:
+		CompiledBook(const QString& fileName);
+		bool map();
+
+		QFile m_file;
+		int m_bucketBits;
+		int m_count;
+		const quint32* m_buckets;
+		const Record* m_records;
+};
+
+#endif // COMPILEDBOOK_H
@@ -58,6 +58,7 @@ EngineConfiguration::EngineConfiguration(const QVariant& variant)
 	setCommand(map["command"].toString());
 	setWorkingDirectory(map["workingDirectory"].toString());
 	setStderrFile(map["stderrFile"].toString());
+	setTranscriptFile(map["transcriptFile"].toString());
 	setProtocol(map["protocol"].toString());
 
 	if (map.contains("initStrings"))
@@ -102,6 +103,7 @@ EngineConfiguration::EngineConfiguration(const EngineConfiguration& other)
 	  m_command(other.m_command),
 	  m_workingDirectory(other.m_workingDirectory),
 	  m_stderrFile(other.m_stderrFile),
+	  m_transcriptFile(other.m_transcriptFile),
 	  m_protocol(other.m_protocol),
 	  m_arguments(other.m_arguments),
 	  m_initStrings(other.m_initStrings),
@@ -126,6 +128,7 @@ EngineConfiguration& EngineConfiguration::operator=(EngineConfiguration&& other)
 	m_command = other.m_command;
 	m_workingDirectory = other.m_workingDirectory;
 	m_stderrFile = other.m_stderrFile;
+	m_transcriptFile = other.m_transcriptFile;
 	m_protocol = other.m_protocol;
 	m_arguments = other.m_arguments;
 	m_initStrings = other.m_initStrings;
@@ -154,6 +157,8 @@ QVariant EngineConfiguration::toVariant() const
 	map.insert("command", m_command);
 	map.insert("workingDirectory", m_workingDirectory);
 	map.insert("stderrFile", m_stderrFile);
+	if (!m_transcriptFile.isEmpty())
+		map.insert("transcriptFile", m_transcriptFile);
 	map.insert("protocol", m_protocol);
 
 	if (!m_initStrings.isEmpty())
@@ -211,6 +216,11 @@ void EngineConfiguration::setStderrFile(const QString& fileName)
 	m_stderrFile = fileName;
 }
 
+void EngineConfiguration::setTranscriptFile(const QString& fileName)
+{
+	m_transcriptFile = fileName;
+}
+
 QString EngineConfiguration::name() const
 {
 	return m_name;
@@ -231,6 +241,11 @@ QString EngineConfiguration::stderrFile() const
 	return m_stderrFile;
 }
 
+QString EngineConfiguration::transcriptFile() const
+{
+	return m_transcriptFile;
+}
+
 QString EngineConfiguration::protocol() const
 {
 	return m_protocol;
@@ -369,6 +384,7 @@ EngineConfiguration& EngineConfiguration::operator=(const EngineConfiguration& o
 		m_command = other.m_command;
 		m_workingDirectory = other.m_workingDirectory;
 		m_stderrFile = other.m_stderrFile;
+		m_transcriptFile = other.m_transcriptFile;
 		m_protocol = other.m_protocol;
 		m_arguments = other.m_arguments;
 		m_initStrings = other.m_initStrings;
@@ -96,6 +96,13 @@ class LIB_EXPORT EngineConfiguration
 		 * \sa stderrFile()
 		 */
 		void setStderrFile(const QString& fileName);
+		/*!
+		 * Sets the filename where the engine's I/O transcript is
+		 * written if the engine crashes or stalls.
+		 *
+		 * \sa transcriptFile()
+		 */
+		void setTranscriptFile(const QString& fileName);
 		/*!
 		 * Sets the communication protocol the engine uses.
 		 *
@@ -128,6 +135,14 @@ class LIB_EXPORT EngineConfiguration
 		 * \sa setStderrFile()
 		 */
 		QString stderrFile() const;
+		/*!
+		 * Returns the filename where the engine's I/O transcript is
+		 * written if the engine crashes or stalls. The transcript is
+		 * only recorded if this is set.
+		 *
+		 * \sa setTranscriptFile()
+		 */
+		QString transcriptFile() const;
 		/*!
 		 * Returns the communication protocol the engine uses.
 		 *
@@ -217,6 +232,7 @@ class LIB_EXPORT EngineConfiguration
 		QString m_command;
 		QString m_workingDirectory;
 		QString m_stderrFile;
+		QString m_transcriptFile;
 		QString m_protocol;
 		QStringList m_arguments;
 		QStringList m_initStrings;
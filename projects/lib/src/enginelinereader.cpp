@@ -0,0 +1,222 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "enginelinereader.h"
+#include <cstring>
+#include <QIODevice>
+
+namespace {
+
+inline bool isSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+} // anonymous namespace
+
+EngineToken::EngineToken()
+	: m_begin(nullptr),
+	  m_end(nullptr)
+{
+}
+
+EngineToken::EngineToken(const char* begin, const char* end)
+	: m_begin(begin),
+	  m_end(end)
+{
+}
+
+bool EngineToken::isNull() const
+{
+	return m_begin == nullptr;
+}
+
+const char* EngineToken::begin() const
+{
+	return m_begin;
+}
+
+const char* EngineToken::end() const
+{
+	return m_end;
+}
+
+int EngineToken::size() const
+{
+	return int(m_end - m_begin);
+}
+
+bool EngineToken::operator==(const char* str) const
+{
+	if (m_begin == nullptr)
+		return false;
+
+	const char* p = m_begin;
+	for (; p != m_end; ++p, ++str)
+	{
+		if (*str != *p)
+			return false;
+	}
+	return *str == '\0';
+}
+
+bool EngineToken::operator!=(const char* str) const
+{
+	return !(*this == str);
+}
+
+int EngineToken::keyword(const char* const* keywords, int count) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (*this == keywords[i])
+			return i;
+	}
+	return -1;
+}
+
+qint64 EngineToken::toLongLong(bool* ok) const
+{
+	const char* p = m_begin;
+	bool negative = false;
+	if (p != m_end && (*p == '-' || *p == '+'))
+		negative = (*p++ == '-');
+
+	qint64 value = 0;
+	bool valid = (p != m_end);
+	for (; p != m_end; ++p)
+	{
+		if (*p < '0' || *p > '9')
+		{
+			valid = false;
+			break;
+		}
+		value = value * 10 + (*p - '0');
+	}
+
+	if (ok != nullptr)
+		*ok = valid;
+	if (!valid)
+		return 0;
+	return negative ? -value : value;
+}
+
+int EngineToken::toInt(bool* ok) const
+{
+	return int(toLongLong(ok));
+}
+
+QString EngineToken::toString() const
+{
+	return QString::fromLatin1(m_begin, size());
+}
+
+
+EngineLineReader::EngineLineReader()
+	: m_buffer(256, '\0'),
+	  m_size(0)
+{
+}
+
+bool EngineLineReader::readLine(QIODevice* device)
+{
+	m_size = 0;
+	if (!device->canReadLine())
+		return false;
+
+	while (true)
+	{
+		// QIODevice::readLine() needs room for a terminating null
+		if (m_buffer.size() - m_size < 2)
+			m_buffer.resize(m_buffer.size() * 2);
+
+		qint64 n = device->readLine(m_buffer.data() + m_size,
+					    m_buffer.size() - m_size);
+		if (n <= 0)
+			break;
+		m_size += int(n);
+		if (m_buffer.at(m_size - 1) == '\n')
+			break;
+	}
+
+	if (m_size > 0 && m_buffer.at(m_size - 1) == '\n')
+		m_size--;
+	if (m_size > 0 && m_buffer.at(m_size - 1) == '\r')
+		m_size--;
+	return true;
+}
+
+void EngineLineReader::setLine(const char* line, int size)
+{
+	if (m_buffer.size() < size + 1)
+		m_buffer.resize(size + 1);
+	memcpy(m_buffer.data(), line, size);
+	m_size = size;
+}
+
+const char* EngineLineReader::data() const
+{
+	return m_buffer.constData();
+}
+
+int EngineLineReader::size() const
+{
+	return m_size;
+}
+
+bool EngineLineReader::isEmpty() const
+{
+	return m_size == 0;
+}
+
+QString EngineLineReader::toString() const
+{
+	return QString::fromUtf8(m_buffer.constData(), m_size);
+}
+
+EngineToken EngineLineReader::firstToken() const
+{
+	const char* begin = m_buffer.constData();
+	return nextToken(EngineToken(begin, begin));
+}
+
+EngineToken EngineLineReader::nextToken(const EngineToken& previous) const
+{
+	const char* end = m_buffer.constData() + m_size;
+	const char* p = previous.end();
+	while (p != end && isSpace(*p))
+		++p;
+	if (p == end)
+		return EngineToken();
+
+	const char* begin = p;
+	while (p != end && !isSpace(*p))
+		++p;
+	return EngineToken(begin, p);
+}
+
+EngineToken EngineLineReader::rest(const EngineToken& previous) const
+{
+	EngineToken token(nextToken(previous));
+	if (token.isNull())
+		return token;
+
+	const char* end = m_buffer.constData() + m_size;
+	while (end != token.end() && isSpace(*(end - 1)))
+		--end;
+	return EngineToken(token.begin(), end);
+}
@@ -0,0 +1,126 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ENGINELINEREADER_H
+#define ENGINELINEREADER_H
+
+#include <QByteArray>
+#include <QString>
+
+class QIODevice;
+
+/*!
+ * \brief A whitespace-delimited token of an engine's output line
+ *
+ * EngineToken points into the buffer of an EngineLineReader and is valid
+ * until the reader reads the next line.
+ */
+class LIB_EXPORT EngineToken
+{
+	public:
+		/*! Creates a null token. */
+		EngineToken();
+		/*! Creates a token of the characters from \a begin to \a end. */
+		EngineToken(const char* begin, const char* end);
+
+		/*! Returns true if this is a null token. */
+		bool isNull() const;
+		/*! Returns a pointer to the first character. */
+		const char* begin() const;
+		/*! Returns a pointer past the last character. */
+		const char* end() const;
+		/*! Returns the number of characters. */
+		int size() const;
+
+		/*! Returns true if the token is \a str. */
+		bool operator==(const char* str) const;
+		/*! Returns true if the token isn't \a str. */
+		bool operator!=(const char* str) const;
+
+		/*!
+		 * Returns the index of the token in \a keywords, an array of
+		 * \a count strings, or -1 if it's not one of them.
+		 */
+		int keyword(const char* const* keywords, int count) const;
+
+		/*!
+		 * Returns the token as a decimal integer, optionally with
+		 * a sign. If the token isn't a number, 0 is returned and
+		 * \a ok is set to false.
+		 */
+		qint64 toLongLong(bool* ok = nullptr) const;
+		/*! Returns the token as an int, see toLongLong(). */
+		int toInt(bool* ok = nullptr) const;
+
+		/*! Returns the token as a string. */
+		QString toString() const;
+
+	private:
+		const char* m_begin;
+		const char* m_end;
+};
+
+/*!
+ * \brief Reads engine output one line at a time into a reusable buffer
+ *
+ * Engines can send thousands of lines per second. EngineLineReader
+ * reads them straight from the device into a buffer that is only
+ * allocated when a line is longer than any before it, and splits them
+ * into EngineToken objects without converting them to QString.
+ */
+class LIB_EXPORT EngineLineReader
+{
+	public:
+		/*! Creates a new reader. */
+		EngineLineReader();
+
+		/*!
+		 * Reads the next complete line from \a device without the
+		 * line ending. Returns false if there is no complete line.
+		 */
+		bool readLine(QIODevice* device);
+		/*! Sets the current line to \a line. */
+		void setLine(const char* line, int size);
+
+		/*! Returns a pointer to the current line. */
+		const char* data() const;
+		/*! Returns the length of the current line. */
+		int size() const;
+		/*! Returns true if the current line is empty. */
+		bool isEmpty() const;
+		/*! Returns the current line as a string. */
+		QString toString() const;
+
+		/*! Returns the first token of the line. */
+		EngineToken firstToken() const;
+		/*!
+		 * Returns the token after \a previous, or a null token at
+		 * the end of the line.
+		 */
+		EngineToken nextToken(const EngineToken& previous) const;
+		/*!
+		 * Returns the rest of the line after \a previous without
+		 * leading and trailing whitespace.
+		 */
+		EngineToken rest(const EngineToken& previous) const;
+
+	private:
+		QByteArray m_buffer;
+		int m_size;
+};
+
+#endif // ENGINELINEREADER_H
@@ -21,11 +21,13 @@
 
 #include <QtGlobal>
 
-#ifdef Q_OS_WIN32
+#if defined(Q_OS_WIN32)
   #include "engineprocess_win.h"
-#else // not Q_OS_WIN32
+#elif defined(Q_OS_LINUX)
+  #include "engineprocess_linux.h"
+#else // not Q_OS_WIN32 or Q_OS_LINUX
   #include <QProcess>
   #define EngineProcess QProcess
-#endif // not Q_OS_WIN32
+#endif // not Q_OS_WIN32 or Q_OS_LINUX
 
 #endif // ENGINEPROCESS_H
@@ -0,0 +1,505 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "engineprocess_linux.h"
+#include <QDir>
+#include <QFile>
+#include <QRegExp>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <sys/types.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include "pipepoller_linux.h"
+
+namespace {
+
+void ignoreSigPipe()
+{
+	// Writing to an engine that has exited must not kill us
+	static const bool s_ignored = (signal(SIGPIPE, SIG_IGN) != SIG_ERR);
+	Q_UNUSED(s_ignored);
+}
+
+} // anonymous namespace
+
+EngineProcess::EngineProcess(QObject* parent)
+	: QIODevice(parent),
+	  m_started(false),
+	  m_finished(false),
+	  m_exitCode(0),
+	  m_exitStatus(EngineProcess::NormalExit),
+	  m_stdErrFileMode(Truncate),
+	  m_pid(-1),
+	  m_inWrite(-1),
+	  m_outRead(-1),
+	  m_poller(nullptr),
+	  m_outputPos(0),
+	  m_outputPending(false)
+{
+	// Keep the capacity when the buffer is emptied
+	m_output.reserve(0x1000);
+}
+
+EngineProcess::~EngineProcess()
+{
+	if (m_started)
+	{
+		qWarning("EngineProcess: Destroyed while process is still running.");
+		kill();
+		waitForFinished();
+	}
+	cleanup();
+}
+
+int EngineProcess::exitCode() const
+{
+	return m_exitCode;
+}
+
+EngineProcess::ExitStatus EngineProcess::exitStatus() const
+{
+	return m_exitStatus;
+}
+
+qint64 EngineProcess::bytesAvailable() const
+{
+	QMutexLocker locker(&m_outputMutex);
+	return QIODevice::bytesAvailable() + m_output.size() - m_outputPos;
+}
+
+bool EngineProcess::canReadLine() const
+{
+	QMutexLocker locker(&m_outputMutex);
+	const char* data = m_output.constData() + m_outputPos;
+	size_t size = size_t(m_output.size() - m_outputPos);
+
+	return memchr(data, '\n', size) != nullptr
+	    || QIODevice::canReadLine();
+}
+
+qint64 EngineProcess::takeLineTimestamp()
+{
+	QMutexLocker locker(&m_outputMutex);
+	if (m_lineTimes.isEmpty())
+		return -1;
+	return m_lineTimes.dequeue();
+}
+
+void EngineProcess::closeFd(int* fd)
+{
+	if (*fd == -1)
+		return;
+	::close(*fd);
+	*fd = -1;
+}
+
+void EngineProcess::cleanup()
+{
+	// The poller must let go of this process before the pipe closes
+	if (m_poller != nullptr)
+	{
+		m_poller->removePipe(m_outRead);
+		m_poller = nullptr;
+	}
+
+	closeFd(&m_inWrite);
+	closeFd(&m_outRead);
+
+	m_started = false;
+}
+
+void EngineProcess::close()
+{
+	if (!m_started)
+		return;
+
+	emit aboutToClose();
+	kill();
+	waitForFinished(-1);
+	cleanup();
+	QIODevice::close();
+}
+
+bool EngineProcess::isSequential() const
+{
+	return true;
+}
+
+void EngineProcess::setWorkingDirectory(const QString& dir)
+{
+	m_workDir = dir;
+}
+
+void EngineProcess::setStandardErrorFile(const QString& fileName, OpenMode mode)
+{
+	m_stdErrFile = fileName;
+	m_stdErrFileMode = mode;
+}
+
+QString EngineProcess::unquote(QString str)
+{
+	if (str.startsWith('\"'))
+		str.remove(0, 1);
+	if (str.endsWith('\"'))
+		str.chop(1);
+
+	return str;
+}
+
+void EngineProcess::start(const QString& program,
+			  const QStringList& arguments,
+			  OpenMode mode)
+{
+	if (m_started)
+		close();
+
+	m_started = false;
+	m_finished = false;
+	m_exitCode = 0;
+	m_exitStatus = NormalExit;
+	m_output.resize(0);
+	m_outputPos = 0;
+	m_lineTimes.clear();
+	m_outputPending = false;
+	ignoreSigPipe();
+
+	// Find the program before forking, like QProcess does
+	QString path(program);
+	if (!program.contains('/'))
+		path = QStandardPaths::findExecutable(program);
+	if (path.isEmpty())
+		return;
+
+	QList<QByteArray> args;
+	args << QFile::encodeName(path);
+	for (const QString& arg : arguments)
+		args << arg.toLocal8Bit();
+	QVector<char*> argv;
+	for (QByteArray& arg : args)
+		argv << arg.data();
+	argv << nullptr;
+	char* const* argvData = argv.constData();
+
+	const QByteArray workDir(QFile::encodeName(m_workDir));
+	const QByteArray errFile(m_stdErrFile.isEmpty()
+				 ? QByteArray("/dev/null")
+				 : QFile::encodeName(m_stdErrFile));
+	int errFlags = O_WRONLY | O_CREAT | O_CLOEXEC;
+	errFlags |= (m_stdErrFileMode & Append) ? O_APPEND : O_TRUNC;
+	int errFd = ::open(errFile.constData(), errFlags, 0666);
+
+	// The pipes are closed on exec so that the other engines don't
+	// keep them open. 'execPipe' tells whether the exec failed.
+	int inPipe[2] = { -1, -1 };
+	int outPipe[2] = { -1, -1 };
+	int execPipe[2] = { -1, -1 };
+	pid_t pid = -1;
+	if (pipe2(inPipe, O_CLOEXEC) == 0
+	&&  pipe2(outPipe, O_CLOEXEC) == 0
+	&&  pipe2(execPipe, O_CLOEXEC) == 0)
+		pid = fork();
+
+	if (pid == 0)
+	{
+		// Only async-signal-safe calls from here on
+		signal(SIGPIPE, SIG_DFL);
+		dup2(inPipe[0], STDIN_FILENO);
+		dup2(outPipe[1], STDOUT_FILENO);
+		if (errFd != -1)
+			dup2(errFd, STDERR_FILENO);
+
+		if (workDir.isEmpty() || chdir(workDir.constData()) == 0)
+			execv(argvData[0], argvData);
+
+		int err = errno;
+		ssize_t n = ::write(execPipe[1], &err, sizeof(err));
+		Q_UNUSED(n);
+		_exit(127);
+	}
+
+	closeFd(&inPipe[0]);
+	closeFd(&outPipe[1]);
+	closeFd(&execPipe[1]);
+	closeFd(&errFd);
+
+	bool ok = false;
+	if (pid > 0)
+	{
+		int err = 0;
+		ssize_t n;
+		do
+			n = ::read(execPipe[0], &err, sizeof(err));
+		while (n == -1 && errno == EINTR);
+
+		ok = (n == 0);
+		if (!ok)
+			waitpid(pid, nullptr, 0);
+	}
+	closeFd(&execPipe[0]);
+
+	if (!ok)
+	{
+		closeFd(&inPipe[1]);
+		closeFd(&outPipe[0]);
+		return;
+	}
+
+	m_pid = pid;
+	m_inWrite = inPipe[1];
+	m_outRead = outPipe[0];
+	m_started = true;
+
+	// The poller reads until the pipe is empty
+	fcntl(m_outRead, F_SETFL, fcntl(m_outRead, F_GETFL) | O_NONBLOCK);
+	m_poller = PipePoller::acquire();
+	m_poller->addPipe(m_outRead, this);
+
+	// Make QIODevice aware that the device is now open
+	QIODevice::open(mode);
+}
+
+void EngineProcess::start(const QString& program,
+			  OpenMode mode)
+{
+	QStringList args;
+
+	QRegExp rx("((?:[^\\s\"]+)|(?:\"(?:\\\\\"|[^\"])*\"))");
+	int pos = 0;
+	while ((pos = rx.indexIn(program, pos)) != -1)
+	{
+		args << unquote(rx.cap());
+		pos += rx.matchedLength();
+	}
+	if (args.isEmpty())
+		return;
+
+	QString prog = args.first();
+	args.removeFirst();
+	start(prog, args, mode);
+}
+
+void EngineProcess::kill()
+{
+	if (m_started && !m_finished)
+		::kill(m_pid, SIGKILL);
+}
+
+bool EngineProcess::setCpuAffinity(int cpu)
+{
+	if (!m_started || m_finished || cpu < 0 || cpu >= CPU_SETSIZE)
+		return false;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+
+	// Threads the engine has already started keep their own masks
+	const QStringList tasks = QDir(QString("/proc/%1/task").arg(m_pid))
+		.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+	if (tasks.isEmpty())
+		return sched_setaffinity(m_pid, sizeof(set), &set) == 0;
+
+	bool ok = true;
+	for (const QString& task : tasks)
+	{
+		if (sched_setaffinity(pid_t(task.toInt()), sizeof(set), &set) != 0)
+			ok = false;
+	}
+	return ok;
+}
+
+bool EngineProcess::reap(bool block)
+{
+	int status = 0;
+	pid_t ret;
+	do
+		ret = waitpid(m_pid, &status, block ? 0 : WNOHANG);
+	while (ret == -1 && errno == EINTR);
+
+	if (ret == 0)
+		return false;
+
+	m_finished = true;
+	if (ret == m_pid && WIFEXITED(status))
+	{
+		m_exitCode = WEXITSTATUS(status);
+		m_exitStatus = (m_exitCode == 0) ? NormalExit : CrashExit;
+	}
+	else
+	{
+		m_exitCode = -1;
+		m_exitStatus = CrashExit;
+	}
+	return true;
+}
+
+void EngineProcess::appendOutput(const char* data, int size, qint64 timestamp)
+{
+	QMutexLocker locker(&m_outputMutex);
+
+	bool newLine = false;
+	const char* end = data + size;
+	for (const char* p = data;
+	     (p = static_cast<const char*>(memchr(p, '\n', size_t(end - p)))) != nullptr;
+	     p++)
+	{
+		m_lineTimes.enqueue(timestamp);
+		newLine = true;
+	}
+	m_output.append(data, size);
+
+	// To avoid event spam, notify only if there's a whole line of
+	// new data and the previous notification was handled
+	if (newLine && !m_outputPending)
+	{
+		m_outputPending = true;
+		QMetaObject::invokeMethod(this, "onOutput", Qt::QueuedConnection);
+	}
+}
+
+void EngineProcess::closeOutput()
+{
+	QMetaObject::invokeMethod(this, "onOutputClosed", Qt::QueuedConnection);
+}
+
+void EngineProcess::onOutput()
+{
+	m_outputMutex.lock();
+	m_outputPending = false;
+	m_outputMutex.unlock();
+
+	emit readyRead();
+}
+
+void EngineProcess::onOutputClosed()
+{
+	if (!m_started)
+		return;
+
+	if (bytesAvailable() > 0)
+		emit readyRead();
+	emit readChannelFinished();
+	onFinished();
+}
+
+void EngineProcess::onFinished()
+{
+	if (!m_started || m_finished)
+		return;
+
+	// The process may close its output just before exiting
+	if (!reap(false))
+	{
+		QTimer::singleShot(10, this, SLOT(onFinished()));
+		return;
+	}
+
+	cleanup();
+	emit finished(m_exitCode, m_exitStatus);
+}
+
+bool EngineProcess::waitForFinished(int msecs)
+{
+	if (!m_started)
+		return true;
+
+	if (msecs == -1)
+		reap(true);
+	else
+	{
+		QElapsedTimer timer;
+		timer.start();
+		while (!reap(false))
+		{
+			if (timer.elapsed() >= msecs)
+				return false;
+			QThread::msleep(1);
+		}
+	}
+
+	cleanup();
+	emit finished(m_exitCode, m_exitStatus);
+	return true;
+}
+
+bool EngineProcess::waitForStarted(int msecs)
+{
+	// Don't wait here because start() already did the waiting
+	Q_UNUSED(msecs);
+	return m_started;
+}
+
+QString EngineProcess::workingDirectory() const
+{
+	return m_workDir;
+}
+
+qint64 EngineProcess::readData(char* data, qint64 maxSize)
+{
+	QMutexLocker locker(&m_outputMutex);
+
+	int n = int(qMin(maxSize, qint64(m_output.size() - m_outputPos)));
+	if (n <= 0)
+		return isOpen() ? 0 : -1;
+
+	memcpy(data, m_output.constData() + m_outputPos, size_t(n));
+	m_outputPos += n;
+
+	if (m_outputPos == m_output.size())
+	{
+		m_output.resize(0);
+		m_outputPos = 0;
+	}
+	else if (m_outputPos >= 0x1000)
+	{
+		m_output.remove(0, m_outputPos);
+		m_outputPos = 0;
+	}
+	return n;
+}
+
+qint64 EngineProcess::writeData(const char* data, qint64 maxSize)
+{
+	if (!m_started)
+		return -1;
+
+	qint64 written = 0;
+	while (written < maxSize)
+	{
+		ssize_t n = ::write(m_inWrite, data + written,
+				    size_t(maxSize - written));
+		if (n == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			return written > 0 ? written : -1;
+		}
+		written += n;
+	}
+	return written;
+}
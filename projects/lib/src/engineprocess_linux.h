@@ -0,0 +1,200 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ENGINEPROCESS_LINUX_H
+#define ENGINEPROCESS_LINUX_H
+
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QMutex>
+#include <QQueue>
+#include <sys/types.h>
+#include "linetimestampsource.h"
+class PipePoller;
+
+
+/*!
+ * \brief A replacement for QProcess on Linux
+ *
+ * QProcess reads the output of every engine in the event loop of the
+ * engine's thread, so with many concurrent games the engines' output
+ * waits for the busy event loops, and the waiting is charged to the
+ * engines' clocks. EngineProcess reads the output in a few shared
+ * PipePoller threads as soon as it arrives, and only notifies the
+ * engine's thread when a whole line is available. The interface is the
+ * same as QProcess' with some unneeded features left out.
+ *
+ * \sa QProcess
+ * \sa PipePoller
+ */
+class LIB_EXPORT EngineProcess : public QIODevice, public LineTimestampSource
+{
+	Q_OBJECT
+
+	public:
+		/*! The process' exit status. */
+		enum ExitStatus
+		{
+			NormalExit,	//!< The process exited normally
+			CrashExit	//!< The process crashed
+		};
+
+		/*! Creates a new EngineProcess. */
+		explicit EngineProcess(QObject* parent = nullptr);
+		/*!
+		 * Destructs the EngineProcess and frees all resources.
+		 * If the process is still running, it is killed.
+		 */
+		virtual ~EngineProcess();
+
+		// Inherited from QIODevice
+		virtual qint64 bytesAvailable() const;
+		virtual bool canReadLine() const;
+		virtual void close();
+		virtual bool isSequential() const;
+
+		// Inherited from LineTimestampSource
+		virtual qint64 takeLineTimestamp();
+
+		/*! Returns the exit code of the last process that finished. */
+		int exitCode() const;
+		/*! Returns the exit status of the last process that finished. */
+		ExitStatus exitStatus() const;
+
+		/*!
+		 * Returns the process' working directory.
+		 * Returns an empty string if the working directory wasn't
+		 * set with setWorkingDirectory().
+		 */
+		QString workingDirectory() const;
+		/*!
+		 * Sets the working directory to dir.
+		 * EngineProcess will start the process in this directory.
+		 */
+		void setWorkingDirectory(const QString& dir);
+		/*!
+		 * Redirects the process' standard error to the file fileName.
+		 * The file will be appended to if mode is Append; otherwise
+		 * it will be truncated.
+		 */
+		void setStandardErrorFile(const QString& fileName,
+					  OpenMode mode = Truncate);
+
+		/*!
+		 * Starts the program \a program in a new process, passing the
+		 * command line arguments in \a arguments. The OpenMode is set
+		 * to \a mode.
+		 *
+		 * \note Unlike the same function in QProcess, this one will
+		 * block until the program has been executed.
+		 *
+		 * \note To check if the process started successfully, call
+		 * the waitForStarted() method.
+		 */
+		void start(const QString& program,
+			   const QStringList& arguments,
+			   OpenMode mode = ReadWrite);
+		/*! Starts the program \a program with OpenMode \a mode. */
+		void start(const QString& program,
+			   OpenMode mode = ReadWrite);
+
+		/*!
+		 * Blocks until the process has finished and the finished()
+		 * signal has been emitted.
+		 *
+		 * Times out after \a msecs milliseconds. If \a msecs is -1
+		 * the function will not time out.
+		 *
+		 * \return true if the process finished.
+		 */
+		bool waitForFinished(int msecs = 30000);
+
+		/*!
+		 * Returns true if the process started successfully.
+		 * Doesn't really wait for anything since the start() method
+		 * already did the waiting.
+		 */
+		bool waitForStarted(int msecs = 30000);
+
+		/*!
+		 * Restricts the running process to the logical CPU \a cpu.
+		 *
+		 * Returns true if successful.
+		 */
+		bool setCpuAffinity(int cpu);
+
+	public slots:
+		/*! Kills the process, causing it to exit immediately. */
+		void kill();
+
+	signals:
+		/*!
+		 * Emitted when the process finishes.
+		 * \param exitCode exit code of the process
+		 * \param exitStatus exit status of the process
+		 */
+		void finished(int exitCode, ExitStatus exitStatus);
+
+	protected:
+		// Inherited from QIODevice
+		virtual qint64 readData(char* data, qint64 maxSize);
+		virtual qint64 writeData(const char* data, qint64 maxSize);
+
+	private slots:
+		void onOutput();
+		void onOutputClosed();
+		void onFinished();
+
+	private:
+		friend class PipePoller;
+
+		static QString unquote(QString str);
+		static void closeFd(int* fd);
+
+		/*!
+		 * Called by the pipe poller when \a size bytes of \a data
+		 * were read from the process at \a timestamp.
+		 */
+		void appendOutput(const char* data, int size, qint64 timestamp);
+		/*! Called by the pipe poller when the output pipe closes. */
+		void closeOutput();
+		bool reap(bool block);
+		void cleanup();
+
+		bool m_started;
+		bool m_finished;
+		int m_exitCode;
+		ExitStatus m_exitStatus;
+		QString m_workDir;
+		QString m_stdErrFile;
+		OpenMode m_stdErrFileMode;
+		pid_t m_pid;
+		int m_inWrite;
+		int m_outRead;
+		PipePoller* m_poller;
+
+		mutable QMutex m_outputMutex;
+		QByteArray m_output;
+		int m_outputPos;
+		QQueue<qint64> m_lineTimes;
+		bool m_outputPending;
+};
+
+#endif // ENGINEPROCESS_LINUX_H
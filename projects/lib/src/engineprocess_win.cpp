@@ -78,6 +78,13 @@ bool EngineProcess::canReadLine() const
 	return m_reader->canReadLine() || QIODevice::canReadLine();
 }
 
+qint64 EngineProcess::takeLineTimestamp()
+{
+	if (!m_started)
+		return -1;
+	return m_reader->takeLineTimestamp();
+}
+
 void EngineProcess::killHandle(HANDLE* handle)
 {
 	if (*handle == INVALID_HANDLE_VALUE)
@@ -376,6 +383,16 @@ void EngineProcess::kill()
 		TerminateProcess(m_processInfo.hProcess, 0xf291);
 }
 
+bool EngineProcess::setCpuAffinity(int cpu)
+{
+	if (!m_started || m_finished
+	||  cpu < 0 || cpu >= int(sizeof(DWORD_PTR) * 8))
+		return false;
+
+	return SetProcessAffinityMask(m_processInfo.hProcess,
+				      DWORD_PTR(1) << cpu) != FALSE;
+}
+
 void EngineProcess::onFinished()
 {
 	if (!m_started || m_finished)
@@ -23,6 +23,7 @@
 #include <QIODevice>
 #include <QString>
 #include <QMutex>
+#include "linetimestampsource.h"
 class PipeReader;
 
 
@@ -34,12 +35,13 @@ class PipeReader;
  * new data immediately (no polling) when it's available. The interface is
  * the same as QProcess' with some unneeded features left out.
  *
- * On non-Windows platforms EngineProcess is just a typedef to QProcess.
+ * On Linux EngineProcess is implemented with PipePoller threads, and
+ * on other platforms it is just a typedef to QProcess.
  *
  * \sa QProcess
  * \sa PipeReader
  */
-class LIB_EXPORT EngineProcess : public QIODevice
+class LIB_EXPORT EngineProcess : public QIODevice, public LineTimestampSource
 {
 	Q_OBJECT
 
@@ -62,6 +64,9 @@ class LIB_EXPORT EngineProcess : public QIODevice
 		// Inherited from QIODevice
 		virtual qint64 bytesAvailable() const;
 		virtual bool canReadLine() const;
+
+		// Inherited from LineTimestampSource
+		virtual qint64 takeLineTimestamp();
 		virtual void close();
 		virtual bool isSequential() const;
 
@@ -125,6 +130,13 @@ class LIB_EXPORT EngineProcess : public QIODevice
 		 */
 		bool waitForStarted(int msecs = 30000);
 
+		/*!
+		 * Restricts the running process to the logical CPU \a cpu.
+		 *
+		 * Returns true if successful.
+		 */
+		bool setCpuAffinity(int cpu);
+
 	public slots:
 		/*! Kills the process, causing it to exit immediately. */
 		void kill();
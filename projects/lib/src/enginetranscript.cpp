@@ -0,0 +1,133 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "enginetranscript.h"
+#include <cstring>
+#include <QFile>
+
+EngineTranscript::EngineTranscript(int capacity)
+	: m_buffer(qMax(capacity, HeaderSize + 1), '\0'),
+	  m_start(0),
+	  m_size(0),
+	  m_lineCount(0)
+{
+	m_timer.start();
+}
+
+int EngineTranscript::capacity() const
+{
+	return m_buffer.size();
+}
+
+int EngineTranscript::lineCount() const
+{
+	return m_lineCount;
+}
+
+void EngineTranscript::write(int pos, const char* data, int size)
+{
+	pos %= m_buffer.size();
+	int first = qMin(size, m_buffer.size() - pos);
+	memcpy(m_buffer.data() + pos, data, first);
+	memcpy(m_buffer.data(), data + first, size - first);
+}
+
+void EngineTranscript::read(int pos, char* data, int size) const
+{
+	pos %= m_buffer.size();
+	int first = qMin(size, m_buffer.size() - pos);
+	memcpy(data, m_buffer.constData() + pos, first);
+	memcpy(data + first, m_buffer.constData(), size - first);
+}
+
+void EngineTranscript::dropFirst()
+{
+	Q_ASSERT(m_lineCount > 0);
+
+	quint32 length = 0;
+	read(m_start + 9, reinterpret_cast<char*>(&length), 4);
+
+	int recordSize = HeaderSize + int(length);
+	m_start = (m_start + recordSize) % m_buffer.size();
+	m_size -= recordSize;
+	m_lineCount--;
+}
+
+void EngineTranscript::append(Direction direction, const char* line, int length)
+{
+	length = qMin(length, m_buffer.size() - HeaderSize);
+	while (m_size + HeaderSize + length > m_buffer.size())
+		dropFirst();
+
+	qint64 time = m_timer.elapsed();
+	char dir = char(direction);
+	quint32 size = quint32(length);
+
+	int pos = m_start + m_size;
+	write(pos, reinterpret_cast<const char*>(&time), 8);
+	write(pos + 8, &dir, 1);
+	write(pos + 9, reinterpret_cast<const char*>(&size), 4);
+	write(pos + HeaderSize, line, length);
+
+	m_size += HeaderSize + length;
+	m_lineCount++;
+}
+
+void EngineTranscript::append(Direction direction, const QByteArray& line)
+{
+	append(direction, line.constData(), line.size());
+}
+
+void EngineTranscript::clear()
+{
+	m_start = 0;
+	m_size = 0;
+	m_lineCount = 0;
+}
+
+bool EngineTranscript::dump(const QString& fileName, const QString& title) const
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+		return false;
+
+	QByteArray text(title.toLocal8Bit() + '\n');
+	QByteArray line;
+	int pos = m_start;
+	for (int i = 0; i < m_lineCount; i++)
+	{
+		qint64 time = 0;
+		char dir = 0;
+		quint32 length = 0;
+		read(pos, reinterpret_cast<char*>(&time), 8);
+		read(pos + 8, &dir, 1);
+		read(pos + 9, reinterpret_cast<char*>(&length), 4);
+
+		line.resize(int(length));
+		read(pos + HeaderSize, line.data(), int(length));
+		pos += HeaderSize + int(length);
+
+		// The lines are written as they were sent or received
+		text += QByteArray::number(double(time) / 1000.0, 'f', 3);
+		text += (dir == Input ? " > " : " < ");
+		text += line.trimmed();
+		text += '\n';
+	}
+
+	file.write(text);
+	return file.error() == QFile::NoError;
+}
@@ -0,0 +1,93 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ENGINETRANSCRIPT_H
+#define ENGINETRANSCRIPT_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+
+/*!
+ * \brief A ring buffer of the lines sent to and received from an engine
+ *
+ * Every line is stored as a binary record with the time it was sent or
+ * received, so recording costs a copy of the line and nothing else.
+ * When the buffer is full the oldest lines are dropped. The transcript
+ * can be written to a text file when the engine crashes or stalls, or
+ * whenever it's needed.
+ */
+class LIB_EXPORT EngineTranscript
+{
+	public:
+		/*! The direction of a line. */
+		enum Direction
+		{
+			Input,	//!< A line sent to the engine
+			Output	//!< A line received from the engine
+		};
+
+		/*! The default capacity in bytes. */
+		static const int DefaultCapacity = 256 * 1024;
+
+		/*! Creates an empty transcript of \a capacity bytes. */
+		explicit EngineTranscript(int capacity = DefaultCapacity);
+
+		/*! Returns the capacity in bytes. */
+		int capacity() const;
+		/*! Returns the number of stored lines. */
+		int lineCount() const;
+
+		/*!
+		 * Stores \a line with the current time.
+		 *
+		 * A line that doesn't fit the buffer on its own is
+		 * truncated.
+		 */
+		void append(Direction direction, const char* line, int length);
+		/*! Stores \a line with the current time. */
+		void append(Direction direction, const QByteArray& line);
+		/*! Removes all lines. */
+		void clear();
+
+		/*!
+		 * Appends the stored lines to the text file \a fileName,
+		 * one per line with the time in seconds since the
+		 * transcript was created. Lines sent to the engine are
+		 * marked with '>' and lines received with '<', like in
+		 * the debug output. \a title is written first.
+		 *
+		 * Returns true if successful.
+		 */
+		bool dump(const QString& fileName, const QString& title) const;
+
+	private:
+		// Time, direction and length of a line
+		static const int HeaderSize = 8 + 1 + 4;
+
+		void write(int pos, const char* data, int size);
+		void read(int pos, char* data, int size) const;
+		void dropFirst();
+
+		QByteArray m_buffer;
+		int m_start;
+		int m_size;
+		int m_lineCount;
+		QElapsedTimer m_timer;
+};
+
+#endif // ENGINETRANSCRIPT_H
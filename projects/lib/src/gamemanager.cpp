@@ -17,11 +17,15 @@
 */
 
 #include "gamemanager.h"
+#include <QMetaMethod>
+#include <QElapsedTimer>
 #include <QThread>
 #include <algorithm>
 #include "playerbuilder.h"
 #include "chessgame.h"
 #include "chessplayer.h"
+#include "chessengine.h"
+#include "engineprocess.h"
 
 class GameInitializer : public QObject
 {
@@ -29,7 +33,8 @@ class GameInitializer : public QObject
 
 	public:
 		GameInitializer(const PlayerBuilder* white,
-				const PlayerBuilder* black);
+				const PlayerBuilder* black,
+				GameManager* manager);
 		virtual ~GameInitializer();
 
 		const PlayerBuilder* whiteBuilder() const;
@@ -50,7 +55,9 @@ class GameInitializer : public QObject
 
 	private:
 		void deletePlayer(int index);
+		void pinPlayer(ChessPlayer* player);
 
+		GameManager* m_manager;
 		int m_playerCount;
 		bool m_finishing;
 		const PlayerBuilder* m_builder[2];
@@ -59,8 +66,10 @@ class GameInitializer : public QObject
 };
 
 GameInitializer::GameInitializer(const PlayerBuilder* white,
-				 const PlayerBuilder* black)
-	: m_playerCount(0),
+				 const PlayerBuilder* black,
+				 GameManager* manager)
+	: m_manager(manager),
+	  m_playerCount(0),
 	  m_finishing(false),
 	  m_game(nullptr)
 {
@@ -123,6 +132,31 @@ void GameInitializer::deletePlayer(int index)
 	}
 }
 
+void GameInitializer::pinPlayer(ChessPlayer* player)
+{
+#if defined(Q_OS_WIN32) || defined(Q_OS_LINUX)
+	ChessEngine* engine = qobject_cast<ChessEngine*>(player);
+	if (engine == nullptr)
+		return;
+	EngineProcess* process = qobject_cast<EngineProcess*>(engine->device());
+	if (process == nullptr)
+		return;
+
+	GameManager* manager = m_manager;
+	int cpu = manager->acquireCpu();
+	if (!process->setCpuAffinity(cpu))
+		qWarning("Cannot pin engine %s to CPU %d",
+			 qUtf8Printable(player->name()), cpu);
+
+	connect(player, &QObject::destroyed, manager, [=]()
+	{
+		manager->releaseCpu(cpu);
+	});
+#else
+	Q_UNUSED(player);
+#endif
+}
+
 void GameInitializer::initializeGame()
 {
 	for (int i = 0; i < 2; i++)
@@ -138,10 +172,14 @@ void GameInitializer::initializeGame()
 		if (m_player[i] == nullptr)
 		{
 			QString error;
-			m_player[i] = m_builder[i]->create(thread()->parent(),
-							   SIGNAL(debugMessage(QString)),
+			const char* method = nullptr;
+			if (m_manager->hasDebugReceivers())
+				method = SIGNAL(debugMessage(QString));
+			m_player[i] = m_builder[i]->create(m_manager, method,
 							   this, &error);
 			m_game->setError(error);
+			if (m_player[i] != nullptr && m_manager->cpuPinning())
+				pinPlayer(m_player[i]);
 
 			if (m_player[i] == nullptr)
 			{
@@ -190,16 +228,24 @@ void GameInitializer::onPlayerQuit()
 }
 
 
-class GameThread : public QThread
+/*
+ * A game slot. Its games and players live in a thread of its own, or
+ * in a shard thread shared with other game slots.
+ */
+class GameThread : public QObject
 {
 	Q_OBJECT
 
 	public:
 		GameThread(const PlayerBuilder* white,
 			   const PlayerBuilder* black,
-			   QObject* parent);
+			   QThread* shard,
+			   GameManager* parent);
 		virtual ~GameThread();
 
+		QThread* workerThread() const;
+		bool isRunning() const;
+		void start();
 		bool isReady() const;
 		void newGame(ChessGame* game);
 		void finish();
@@ -216,11 +262,17 @@ class GameThread : public QThread
 	signals:
 		void gameInitialized(bool success);
 		void ready();
+		void finished();
 
 	private slots:
 		void onGameDestroyed();
+		void onInitializerDestroyed();
+		void onThreadFinished();
 
 	private:
+		QThread* m_thread;
+		bool m_ownsThread;
+		bool m_running;
 		bool m_ready;
 		GameManager::StartMode m_startMode;
 		GameManager::CleanupMode m_cleanupMode;
@@ -230,27 +282,75 @@ class GameThread : public QThread
 
 GameThread::GameThread(const PlayerBuilder* white,
 		       const PlayerBuilder* black,
-		       QObject* parent)
-	: QThread(parent),
+		       QThread* shard,
+		       GameManager* parent)
+	: QObject(parent),
+	  m_thread(shard),
+	  m_ownsThread(shard == nullptr),
+	  m_running(false),
 	  m_ready(true),
 	  m_startMode(GameManager::StartImmediately),
 	  m_cleanupMode(GameManager::DeletePlayers),
 	  m_game(nullptr),
-	  m_initializer(new GameInitializer(white, black))
+	  m_initializer(new GameInitializer(white, black, parent))
 {
+	if (m_ownsThread)
+	{
+		m_thread = new QThread(this);
+		connect(m_thread, SIGNAL(finished()),
+			this, SLOT(onThreadFinished()));
+	}
+
 	connect(m_initializer, SIGNAL(gameInitialized(bool)),
 		this, SIGNAL(gameInitialized(bool)));
 	connect(m_initializer, SIGNAL(finished()),
 		m_initializer, SLOT(deleteLater()),
 		Qt::QueuedConnection);
 	connect(m_initializer, SIGNAL(destroyed()),
-		this, SLOT(quit()),
+		this, SLOT(onInitializerDestroyed()),
 		Qt::QueuedConnection);
-	m_initializer->moveToThread(this);
+	m_initializer->moveToThread(m_thread);
 }
 
 GameThread::~GameThread()
 {
+	if (m_ownsThread)
+	{
+		m_thread->quit();
+		m_thread->wait();
+	}
+}
+
+QThread* GameThread::workerThread() const
+{
+	return m_thread;
+}
+
+bool GameThread::isRunning() const
+{
+	return m_running;
+}
+
+void GameThread::start()
+{
+	m_running = true;
+	if (m_ownsThread)
+		m_thread->start();
+}
+
+void GameThread::onInitializerDestroyed()
+{
+	// A shard thread keeps running for the other game slots
+	if (m_ownsThread)
+		m_thread->quit();
+	else
+		onThreadFinished();
+}
+
+void GameThread::onThreadFinished()
+{
+	m_running = false;
+	emit finished();
 }
 
 bool GameThread::isReady() const
@@ -334,8 +434,24 @@ GameManager::GameManager(QObject* parent)
 	: QObject(parent),
 	  m_finishing(false),
 	  m_concurrency(1),
-	  m_activeQueuedGameCount(0)
+	  m_activeQueuedGameCount(0),
+	  m_shardCount(0),
+	  m_cpuPinning(false),
+	  m_finishedGames(nullptr)
+{
+}
+
+GameManager::~GameManager()
 {
+	stopShards();
+
+	FinishedGame* node = m_finishedGames.fetchAndStoreAcquire(nullptr);
+	while (node != nullptr)
+	{
+		FinishedGame* next = node->next;
+		delete node;
+		node = next;
+	}
 }
 
 QList<ChessGame*> GameManager::activeGames() const
@@ -348,11 +464,190 @@ int GameManager::concurrency() const
 	return m_concurrency;
 }
 
+bool GameManager::hasDebugReceivers() const
+{
+	static const QMetaMethod s_debugMessage =
+		QMetaMethod::fromSignal(&GameManager::debugMessage);
+	return isSignalConnected(s_debugMessage);
+}
+
 void GameManager::setConcurrency(int concurrency)
 {
 	m_concurrency = concurrency;
 }
 
+int GameManager::shardCount() const
+{
+	return m_shardCount;
+}
+
+void GameManager::setShardCount(int count)
+{
+	Q_ASSERT(count >= 0);
+	m_shardCount = count;
+}
+
+bool GameManager::cpuPinning() const
+{
+	return m_cpuPinning;
+}
+
+void GameManager::setCpuPinning(bool enabled)
+{
+	m_cpuPinning = enabled;
+}
+
+QThread* GameManager::shardThread()
+{
+	if (m_shardCount <= 0)
+		return nullptr;
+
+	if (m_shards.size() < m_shardCount)
+	{
+		QThread* shard = new QThread(this);
+		shard->start();
+		m_shards << shard;
+		return shard;
+	}
+
+	// The shard with the fewest game slots
+	QThread* shard = nullptr;
+	int minCount = 0;
+	for (QThread* tmp : qAsConst(m_shards))
+	{
+		int count = 0;
+		for (GameThread* thread : qAsConst(m_threads))
+		{
+			if (thread != nullptr && thread->workerThread() == tmp)
+				count++;
+		}
+		if (shard == nullptr || count < minCount)
+		{
+			shard = tmp;
+			minCount = count;
+		}
+	}
+	return shard;
+}
+
+void GameManager::stopShards()
+{
+	for (QThread* shard : qAsConst(m_shards))
+	{
+		shard->quit();
+		shard->wait();
+		delete shard;
+	}
+	m_shards.clear();
+}
+
+int GameManager::acquireCpu()
+{
+	QMutexLocker locker(&m_cpuMutex);
+
+	if (m_cpuEngineCount.isEmpty())
+		m_cpuEngineCount.fill(0, qMax(QThread::idealThreadCount(), 1));
+
+	int cpu = int(std::min_element(m_cpuEngineCount.begin(),
+				       m_cpuEngineCount.end())
+		      - m_cpuEngineCount.begin());
+	m_cpuEngineCount[cpu]++;
+	return cpu;
+}
+
+void GameManager::releaseCpu(int cpu)
+{
+	QMutexLocker locker(&m_cpuMutex);
+
+	if (cpu >= 0 && cpu < m_cpuEngineCount.size()
+	&&  m_cpuEngineCount[cpu] > 0)
+		m_cpuEngineCount[cpu]--;
+}
+
+void GameManager::onGameFinished(ChessGame* game)
+{
+	// Called in the game's thread. Only the first game of a batch
+	// wakes up the manager's thread.
+	postGameEvent(game, GameEvent::GameEnded);
+
+	FinishedGame* node = new FinishedGame;
+	node->game = game;
+
+	FinishedGame* head;
+	do
+	{
+		head = m_finishedGames.loadAcquire();
+		node->next = head;
+	}
+	while (!m_finishedGames.testAndSetRelease(head, node));
+
+	if (head == nullptr)
+		QMetaObject::invokeMethod(this, "emitFinishedGames",
+					  Qt::QueuedConnection);
+}
+
+void GameManager::emitFinishedGames()
+{
+	FinishedGame* node = m_finishedGames.fetchAndStoreAcquire(nullptr);
+
+	// The newest game is first in the list
+	QList<ChessGame*> games;
+	while (node != nullptr)
+	{
+		games.prepend(node->game);
+		FinishedGame* next = node->next;
+		delete node;
+		node = next;
+	}
+
+	for (ChessGame* game : qAsConst(games))
+		emit gameFinished(game);
+}
+
+void GameManager::postGameEvent(ChessGame* game,
+				GameEvent::Type type,
+				const Chess::GenericMove& move)
+{
+	// Called in the game's thread
+	static const QMetaMethod s_gameEvents =
+		QMetaMethod::fromSignal(&GameManager::gameEvents);
+	if (!isSignalConnected(s_gameEvents))
+		return;
+
+	GameEvent event;
+	event.game = game;
+	event.type = type;
+	event.move = move;
+	event.ply = game->moves().size();
+	for (int i = 0; i < 2; i++)
+	{
+		ChessPlayer* player = game->player(Chess::Side::Type(i));
+		event.timeLeft[i] = player ? player->timeControl()->timeLeft() : 0;
+	}
+	QElapsedTimer clock;
+	clock.start();
+	event.time = clock.msecsSinceReference();
+	if (type == GameEvent::GameEnded)
+		event.result = game->result().toShortString();
+
+	QMutexLocker locker(&m_gameEventMutex);
+	m_gameEvents.append(event);
+	if (m_gameEvents.size() == 1)
+		QMetaObject::invokeMethod(this, "emitGameEvents",
+					  Qt::QueuedConnection);
+}
+
+void GameManager::emitGameEvents()
+{
+	QVector<GameEvent> events;
+	m_gameEventMutex.lock();
+	events.swap(m_gameEvents);
+	m_gameEventMutex.unlock();
+
+	if (!events.isEmpty())
+		emit gameEvents(events);
+}
+
 void GameManager::cleanupIdleThreads()
 {
 	QList<GameThread*>::iterator it = m_activeThreads.begin();
@@ -387,6 +682,7 @@ void GameManager::cleanup()
 
 	if (m_threads.isEmpty())
 	{
+		stopShards();
 		emit finished();
 		return;
 	}
@@ -445,6 +741,7 @@ void GameManager::onThreadQuit()
 	if (m_threads.isEmpty())
 	{
 		m_finishing = false;
+		stopShards();
 		emit finished();
 	}
 }
@@ -500,10 +797,22 @@ void GameManager::onGameInitialized(bool success)
 	if (gameThread->startMode() == Enqueue)
 		cleanupIdleThreads();
 
-	game->moveToThread(gameThread);
+	game->moveToThread(gameThread->workerThread());
 	connect(game, SIGNAL(started(ChessGame*)),
 		this, SIGNAL(gameStarted(ChessGame*)),
 		Qt::QueuedConnection);
+	connect(game, SIGNAL(finished(ChessGame*)),
+		this, SLOT(onGameFinished(ChessGame*)),
+		Qt::DirectConnection);
+	connect(game, &ChessGame::moveMade, this,
+		[=](const Chess::GenericMove& move)
+	{
+		postGameEvent(game, GameEvent::MoveMade, move);
+	}, Qt::DirectConnection);
+	connect(game, &ChessGame::fenChanged, this, [=]()
+	{
+		postGameEvent(game, GameEvent::PositionReset);
+	}, Qt::DirectConnection);
 	QMetaObject::invokeMethod(game, "start", Qt::QueuedConnection);
 
 	startQueuedGame();
@@ -528,7 +837,7 @@ GameThread* GameManager::getThread(const PlayerBuilder* white,
 			return thread;
 	}
 
-	GameThread* gameThread = new GameThread(white, black, this);
+	GameThread* gameThread = new GameThread(white, black, shardThread(), this);
 	m_threads << gameThread;
 	m_activeThreads << gameThread;
 	connect(gameThread, SIGNAL(ready()),
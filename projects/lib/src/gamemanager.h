@@ -22,6 +22,12 @@
 #include <QObject>
 #include <QList>
 #include <QPointer>
+#include <QAtomicPointer>
+#include <QMutex>
+#include <QVector>
+#include <QString>
+#include "board/genericmove.h"
+class QThread;
 class ChessGame;
 class ChessPlayer;
 class PlayerBuilder;
@@ -69,8 +75,47 @@ class LIB_EXPORT GameManager : public QObject
 			ReusePlayers
 		};
 
+		/*!
+		 * \brief A compact report of a change in a running game
+		 *
+		 * \sa gameEvents()
+		 */
+		struct GameEvent
+		{
+			/*! The type of the event. */
+			enum Type
+			{
+				/*! A move was made. */
+				MoveMade,
+				/*! The board was reset to the starting position. */
+				PositionReset,
+				/*! The game ended. */
+				GameEnded
+			};
+
+			/*! The game, which may have been destroyed since. */
+			ChessGame* game;
+			/*! The type of the event. */
+			Type type;
+			/*! The move of a MoveMade event. */
+			Chess::GenericMove move;
+			/*! The number of moves played in the game. */
+			int ply;
+			/*! The time left for white and black, in milliseconds. */
+			int timeLeft[2];
+			/*!
+			 * The time of the event in the reference clock of
+			 * QElapsedTimer, in milliseconds.
+			 */
+			qint64 time;
+			/*! The result of a GameEnded event. */
+			QString result;
+		};
+
 		/*! Creates a new game manager. */
 		GameManager(QObject* parent = nullptr);
+		/*! Stops the shard threads and destroys the game manager. */
+		virtual ~GameManager();
 
 		/*!
 		 * Returns the list of active games.
@@ -98,6 +143,47 @@ class LIB_EXPORT GameManager : public QObject
 		 */
 		void setConcurrency(int concurrency);
 
+		/*!
+		 * Returns the number of shared threads that play the games,
+		 * or 0 if every game slot has a thread of its own.
+		 *
+		 * \sa setShardCount()
+		 */
+		int shardCount() const;
+		/*!
+		 * Plays the games in \a count shared threads (shards) instead
+		 * of one thread per game slot. Each shard runs the event loop
+		 * of several games and their engines. If \a count is 0, every
+		 * game slot gets a thread of its own. This is the default.
+		 *
+		 * \note The shard count only affects games started after
+		 * calling this function.
+		 */
+		void setShardCount(int count);
+
+		/*!
+		 * Returns true if engine processes are pinned to CPU cores.
+		 *
+		 * \sa setCpuPinning()
+		 */
+		bool cpuPinning() const;
+		/*!
+		 * If \a enabled is true, each new engine process is pinned to
+		 * the CPU core with the fewest engines, so that concurrent
+		 * engines don't take each other's time. Pinning is supported
+		 * on Linux and Windows.
+		 */
+		void setCpuPinning(bool enabled);
+
+		/*!
+		 * Returns true if anything is connected to the
+		 * debugMessage() signal.
+		 *
+		 * The players' debugging messages are only passed on if
+		 * this is true when the players are created.
+		 */
+		bool hasDebugReceivers() const;
+
 		/*!
 		 * Cleans up and deletes all idle game threads
 		 *
@@ -157,6 +243,14 @@ class LIB_EXPORT GameManager : public QObject
 	signals:
 		/*! This signal is emitted when a new game starts. */
 		void gameStarted(ChessGame* game);
+		/*!
+		 * This signal is emitted in the game manager's thread when
+		 * \a game has finished.
+		 *
+		 * Games finishing in other threads are handed over without
+		 * locking, and a batch of them is passed on at once.
+		 */
+		void gameFinished(ChessGame* game);
 		/*!
 		 * This signal is emitted when a game is destroyed.
 		 *
@@ -164,6 +258,16 @@ class LIB_EXPORT GameManager : public QObject
 		 * behavior, so this signal should only be used for cleanup.
 		 */
 		void gameDestroyed(ChessGame* game);
+		/*!
+		 * This signal is emitted in the game manager's thread with
+		 * the moves, board resets and results of the active games
+		 * since the previous emission.
+		 *
+		 * The events are only collected while something is connected
+		 * to this signal. This lets a view of many concurrent games
+		 * follow them without connecting to each game.
+		 */
+		void gameEvents(const QVector<GameManager::GameEvent>& events);
 		/*!
 		 * This signal is emitted after a game has started
 		 * or after a game has ended, if there are free
@@ -187,8 +291,12 @@ class LIB_EXPORT GameManager : public QObject
 		void onThreadReady();
 		void onThreadQuit();
 		void onGameInitialized(bool success);
+		void onGameFinished(ChessGame* game);
+		void emitFinishedGames();
+		void emitGameEvents();
 
 	private:
+		friend class GameInitializer;
 		struct GameEntry
 		{
 			ChessGame* game;
@@ -202,11 +310,32 @@ class LIB_EXPORT GameManager : public QObject
 				      const PlayerBuilder* black);
 		void startGame(const GameEntry& entry);
 		void startQueuedGame();
+		struct FinishedGame
+		{
+			ChessGame* game;
+			FinishedGame* next;
+		};
+
+		QThread* shardThread();
+		void stopShards();
+		int acquireCpu();
+		void releaseCpu(int cpu);
+		void postGameEvent(ChessGame* game,
+				   GameEvent::Type type,
+				   const Chess::GenericMove& move = Chess::GenericMove());
 		void cleanup();
 
 		bool m_finishing;
 		int m_concurrency;
 		int m_activeQueuedGameCount;
+		int m_shardCount;
+		bool m_cpuPinning;
+		QList<QThread*> m_shards;
+		QMutex m_cpuMutex;
+		QVector<int> m_cpuEngineCount;
+		QAtomicPointer<FinishedGame> m_finishedGames;
+		QMutex m_gameEventMutex;
+		QVector<GameEvent> m_gameEvents;
 		QList< QPointer<GameThread> > m_threads;
 		QList<GameThread*> m_activeThreads;
 		QList<GameEntry> m_gameEntries;
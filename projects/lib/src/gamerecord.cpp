@@ -0,0 +1,300 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gamerecord.h"
+#include <QRegularExpression>
+#include "pgngame.h"
+#include "board/board.h"
+
+namespace {
+
+// The evaluation comment of ChessGame, see evalString() in chessgame.cpp
+const QRegularExpression s_evalRegExp(
+	"^(?:([+-]?)(?:M(\\d+)|(\\d+\\.\\d+))?/(\\d+) )?(\\d+(?:\\.\\d+)?)s$");
+
+const char* s_resultStrings[] = { "*", "1-0", "0-1", "1/2-1/2" };
+
+} // anonymous namespace
+
+GameRecord::GameRecord()
+	: m_result(Unfinished),
+	  m_hasEvaluations(false)
+{
+}
+
+GameRecord::GameRecord(const PgnGame& pgn)
+	: m_result(Unfinished),
+	  m_hasEvaluations(true)
+{
+	const QList< QPair<QString, QString> > tags = pgn.tags();
+	for (const auto& tag : tags)
+	{
+		if (tag.first == "FEN")
+			m_startingFen = tag.second;
+		else if (tag.first == "Result")
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				if (tag.second == s_resultStrings[i])
+					m_result = Result(i);
+			}
+		}
+		else if (tag.first != "SetUp")
+			m_tags << tag;
+	}
+
+	const QVector<PgnGame::MoveData>& moves = pgn.moves();
+	m_moves.reserve(moves.size());
+	for (int i = 0; i < moves.size(); i++)
+	{
+		MoveData data;
+		data.move = moves.at(i).move;
+
+		// The result description is appended to the last comment
+		QString comment(moves.at(i).comment);
+		if (i == moves.size() - 1 && !parseComment(comment, &data))
+		{
+			int pos = comment.indexOf(", ");
+			if (pos == -1)
+			{
+				m_resultDescription = comment;
+				comment.clear();
+			}
+			else
+			{
+				m_resultDescription = comment.mid(pos + 2);
+				comment.truncate(pos);
+			}
+		}
+
+		if (!parseComment(comment, &data))
+			m_hasEvaluations = false;
+		m_moves << data;
+	}
+}
+
+bool GameRecord::isNull() const
+{
+	return m_tags.isEmpty() && m_moves.isEmpty();
+}
+
+GameRecord::Result GameRecord::result() const
+{
+	return m_result;
+}
+
+void GameRecord::setResult(Result result)
+{
+	m_result = result;
+}
+
+QString GameRecord::resultDescription() const
+{
+	return m_resultDescription;
+}
+
+void GameRecord::setResultDescription(const QString& description)
+{
+	m_resultDescription = description;
+}
+
+QString GameRecord::startingFenString() const
+{
+	return m_startingFen;
+}
+
+void GameRecord::setStartingFenString(const QString& fen)
+{
+	m_startingFen = fen;
+}
+
+QList< QPair<QString, QString> > GameRecord::tags() const
+{
+	return m_tags;
+}
+
+void GameRecord::addTag(const QString& tag, const QString& value)
+{
+	m_tags.append(qMakePair(tag, value));
+}
+
+const QVector<GameRecord::MoveData>& GameRecord::moves() const
+{
+	return m_moves;
+}
+
+void GameRecord::addMove(const MoveData& move)
+{
+	m_moves.append(move);
+}
+
+bool GameRecord::hasEvaluations() const
+{
+	return m_hasEvaluations;
+}
+
+void GameRecord::setEvaluationsEnabled(bool enabled)
+{
+	m_hasEvaluations = enabled;
+}
+
+bool GameRecord::parseComment(const QString& comment, MoveData* data)
+{
+	data->score = NullScore;
+	data->depth = 0;
+	data->time = 0;
+
+	if (comment.isEmpty())
+		return true;
+	if (comment == "book")
+	{
+		data->score = BookScore;
+		return true;
+	}
+
+	QRegularExpressionMatch match(s_evalRegExp.match(comment));
+	if (!match.hasMatch())
+		return false;
+
+	int depth = match.captured(4).toInt();
+	double time = match.captured(5).toDouble();
+	if (depth > 0xff || time > 4.0e6)
+		return false;
+	data->depth = quint8(depth);
+	data->time = quint32(qRound(time * 1000.0));
+
+	bool negative = match.captured(1) == "-";
+	if (!match.captured(2).isEmpty())
+	{
+		int moves = qMin(match.captured(2).toInt(), 199);
+		data->score = qint16(negative ? moves - MateScore : MateScore - moves);
+	}
+	else if (!match.captured(3).isEmpty())
+	{
+		int score = qRound(match.captured(3).toDouble() * 100.0);
+		score = qMin(score, int(MateScore) - 1000);
+		data->score = qint16(negative ? -score : score);
+	}
+	else
+		data->score = TimeOnlyScore;
+
+	return true;
+}
+
+QString GameRecord::comment(const MoveData& data)
+{
+	if (data.score == NullScore)
+		return QString();
+	if (data.score == BookScore)
+		return "book";
+
+	QString str;
+	if (data.score != TimeOnlyScore)
+	{
+		if (data.score > 0)
+			str += "+";
+		if (qAbs(int(data.score)) > MateScore - 200)
+		{
+			if (data.score < 0)
+				str += "-";
+			str += "M" + QString::number(MateScore - qAbs(int(data.score)));
+		}
+		else
+			str += QString::number(data.score / 100.0, 'f', 2);
+	}
+	if (data.depth > 0)
+		str += "/" + QString::number(data.depth) + " ";
+
+	quint32 t = data.time;
+	if (t == 0)
+		return str + "0s";
+
+	int precision = 0;
+	if (t < 100)
+		precision = 3;
+	else if (t < 1000)
+		precision = 2;
+	else if (t < 10000)
+		precision = 1;
+	return str + QString::number(t / 1000.0, 'f', precision) + 's';
+}
+
+bool GameRecord::toPgn(PgnGame* pgn) const
+{
+	Q_ASSERT(pgn != nullptr);
+
+	pgn->clear();
+	for (const auto& tag : m_tags)
+		pgn->setTag(tag.first, tag.second);
+	pgn->setTag("Result", s_resultStrings[m_result]);
+	if (!m_startingFen.isEmpty())
+		pgn->setTag("FEN", m_startingFen);
+
+	Chess::Board* board = pgn->createBoard();
+	if (board == nullptr)
+		return false;
+	if (!m_startingFen.isEmpty())
+		pgn->setStartingFenString(board->sideToMove(), m_startingFen);
+
+	bool ok = true;
+	for (const MoveData& data : m_moves)
+	{
+		Chess::Move move(board->moveFromGenericMove(data.move));
+		if (move.isNull() || !board->isLegalMove(move))
+		{
+			ok = false;
+			break;
+		}
+
+		PgnGame::MoveData md;
+		md.key = board->key();
+		md.move = data.move;
+		md.moveString = board->moveString(move, Chess::Board::StandardChinese);
+		md.comment = m_hasEvaluations ? comment(data) : QString();
+		pgn->addMove(md);
+		board->makeMove(move);
+	}
+	delete board;
+
+	pgn->setResultDescription(m_resultDescription);
+	return ok;
+}
+
+quint16 GameRecord::packMove(const Chess::GenericMove& move)
+{
+	Q_ASSERT(canPackMove(move));
+
+	const Chess::Square source(move.sourceSquare());
+	const Chess::Square target(move.targetSquare());
+	return quint16(source.file() | source.rank() << 4
+		     | target.file() << 8 | target.rank() << 12);
+}
+
+Chess::GenericMove GameRecord::unpackMove(quint16 move)
+{
+	return Chess::GenericMove(Chess::Square(move & 0xf, (move >> 4) & 0xf),
+				  Chess::Square((move >> 8) & 0xf, move >> 12));
+}
+
+bool GameRecord::canPackMove(const Chess::GenericMove& move)
+{
+	const Chess::Square source(move.sourceSquare());
+	const Chess::Square target(move.targetSquare());
+	return source.isValid() && target.isValid()
+	    && source.file() < 16 && source.rank() < 16
+	    && target.file() < 16 && target.rank() < 16;
+}
@@ -0,0 +1,160 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include "board/genericmove.h"
+class PgnGame;
+
+/*!
+ * \brief A finished game in a compact, binary-friendly form
+ *
+ * GameRecord holds the same game as a PgnGame, but without the move
+ * strings: the moves are generic moves that can be packed into 16
+ * bits each, and the engines' evaluations are numbers instead of
+ * PGN comments. GameRecordStream reads and writes the records.
+ *
+ * A record is created from a PgnGame written by ChessGame, and can be
+ * converted back to an equal PgnGame with toPgn(), which replays the
+ * moves to get the move strings.
+ *
+ * \sa GameRecordStream
+ * \sa PgnGame
+ */
+class LIB_EXPORT GameRecord
+{
+	public:
+		/*! The game result, as stored in the record header. */
+		enum Result
+		{
+			Unfinished,	//!< "*"
+			WhiteWins,	//!< "1-0"
+			BlackWins,	//!< "0-1"
+			Draw		//!< "1/2-1/2"
+		};
+
+		/*! Score of a move that has no evaluation. */
+		static const qint16 NullScore = -32768;
+		/*! Score of a book move. */
+		static const qint16 BookScore = -32767;
+		/*! Score of an evaluation that has a time but no score. */
+		static const qint16 TimeOnlyScore = -32766;
+		/*!
+		 * Mate scores are stored as MateScore - n for a mate in
+		 * n moves and n - MateScore for being mated in n moves.
+		 */
+		static const qint16 MateScore = 32000;
+
+		/*! \brief A move and the mover's evaluation. */
+		struct MoveData
+		{
+			/*! The move. */
+			Chess::GenericMove move;
+			/*! The score in centipawns, or one of the special scores. */
+			qint16 score;
+			/*! The search depth, or 0 if unknown. */
+			quint8 depth;
+			/*! The thinking time in milliseconds. */
+			quint32 time;
+		};
+
+		/*! Creates a new empty record. */
+		GameRecord();
+		/*!
+		 * Creates a record of \a pgn.
+		 *
+		 * The evaluations are read from the move comments written by
+		 * ChessGame. If a comment isn't an evaluation, the record has
+		 * no evaluations.
+		 */
+		explicit GameRecord(const PgnGame& pgn);
+
+		/*! Returns true if the record has no tags and no moves. */
+		bool isNull() const;
+
+		/*! Returns the game result. */
+		Result result() const;
+		/*! Sets the game result to \a result. */
+		void setResult(Result result);
+		/*!
+		 * Returns the description of the result, which is appended
+		 * to the last move's comment in PGN.
+		 */
+		QString resultDescription() const;
+		/*! Sets the description of the result to \a description. */
+		void setResultDescription(const QString& description);
+		/*!
+		 * Returns the FEN string of the starting position, or an
+		 * empty string if the game started from the default position.
+		 */
+		QString startingFenString() const;
+		/*! Sets the starting position's FEN string to \a fen. */
+		void setStartingFenString(const QString& fen);
+
+		/*!
+		 * Returns the PGN tags other than FEN, SetUp and Result,
+		 * which are stored separately.
+		 */
+		QList< QPair<QString, QString> > tags() const;
+		/*! Adds tag \a tag with value \a value. */
+		void addTag(const QString& tag, const QString& value);
+
+		/*! Returns the moves of the game. */
+		const QVector<MoveData>& moves() const;
+		/*! Adds \a move to the game. */
+		void addMove(const MoveData& move);
+		/*! Returns true if the moves have evaluations. */
+		bool hasEvaluations() const;
+		/*! Sets the evaluations mode to \a enabled. */
+		void setEvaluationsEnabled(bool enabled);
+
+		/*!
+		 * Converts the record to a PGN game and stores it in \a pgn.
+		 *
+		 * Returns false if the variant is unknown or a move is illegal.
+		 */
+		bool toPgn(PgnGame* pgn) const;
+
+		/*!
+		 * Packs \a move into 16 bits: 4 bits for each file and rank,
+		 * the source square in the low byte.
+		 * \note The files and ranks must be less than 16.
+		 */
+		static quint16 packMove(const Chess::GenericMove& move);
+		/*! Unpacks a move packed with packMove(). */
+		static Chess::GenericMove unpackMove(quint16 move);
+		/*! Returns true if \a move can be packed. */
+		static bool canPackMove(const Chess::GenericMove& move);
+
+	private:
+		static bool parseComment(const QString& comment, MoveData* data);
+		static QString comment(const MoveData& data);
+
+		Result m_result;
+		QString m_resultDescription;
+		QString m_startingFen;
+		QList< QPair<QString, QString> > m_tags;
+		QVector<MoveData> m_moves;
+		bool m_hasEvaluations;
+};
+
+#endif // GAMERECORD_H
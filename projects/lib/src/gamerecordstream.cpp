@@ -0,0 +1,321 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gamerecordstream.h"
+#include <QDataStream>
+#include <QFile>
+#include <QIODevice>
+#include "gamerecord.h"
+
+namespace {
+
+const char s_magic[] = "CCGR";
+const quint32 s_noString = 0xffffffff;
+
+// Size of the type and size fields of a chunk
+const int s_chunkHeaderSize = 5;
+// Larger chunks are treated as corrupt data
+const quint32 s_maxChunkSize = 0x1000000;
+
+void writeString(QDataStream& out, const QString& str)
+{
+	const QByteArray utf8(str.toUtf8().left(0xffff));
+	out << quint16(utf8.size());
+	out.writeRawData(utf8.constData(), utf8.size());
+}
+
+QString readString(QDataStream& in)
+{
+	quint16 size = 0;
+	in >> size;
+	QByteArray utf8(size, Qt::Uninitialized);
+	if (in.readRawData(utf8.data(), size) != size)
+	{
+		in.setStatus(QDataStream::ReadPastEnd);
+		return QString();
+	}
+	return QString::fromUtf8(utf8);
+}
+
+} // anonymous namespace
+
+GameRecordStream::GameRecordStream(QIODevice* device)
+	: m_device(device),
+	  m_status(Ok),
+	  m_hasHeader(false)
+{
+}
+
+QIODevice* GameRecordStream::device() const
+{
+	return m_device;
+}
+
+void GameRecordStream::setDevice(QIODevice* device)
+{
+	m_device = device;
+	m_status = Ok;
+}
+
+GameRecordStream::Status GameRecordStream::status() const
+{
+	return m_status;
+}
+
+void GameRecordStream::reset()
+{
+	m_hasHeader = false;
+	m_writeStrings.clear();
+	m_readStrings.clear();
+	m_status = Ok;
+}
+
+bool GameRecordStream::writeChunk(ChunkType type, const QByteArray& data)
+{
+	QByteArray header;
+	QDataStream out(&header, QIODevice::WriteOnly);
+	out.setByteOrder(QDataStream::LittleEndian);
+	out << quint8(type) << quint32(data.size());
+
+	if (m_device->write(header) != header.size()
+	||  m_device->write(data) != data.size())
+	{
+		m_status = WriteFailed;
+		return false;
+	}
+	return true;
+}
+
+quint32 GameRecordStream::stringIndex(const QString& str)
+{
+	if (str.isEmpty())
+		return s_noString;
+
+	auto it = m_writeStrings.constFind(str);
+	if (it != m_writeStrings.constEnd())
+		return it.value();
+
+	quint32 index = quint32(m_writeStrings.size());
+	if (!writeChunk(StringChunk, str.toUtf8()))
+		return s_noString;
+	m_writeStrings.insert(str, index);
+	return index;
+}
+
+bool GameRecordStream::writeRecord(const GameRecord& record)
+{
+	Q_ASSERT(m_device != nullptr);
+
+	const QVector<GameRecord::MoveData>& moves = record.moves();
+	if (moves.size() > 0xffff)
+		return false;
+	for (const GameRecord::MoveData& md : moves)
+	{
+		if (!GameRecord::canPackMove(md.move))
+			return false;
+	}
+
+	if (!m_hasHeader)
+	{
+		QByteArray data(s_magic, 4);
+		data.append(char(Version & 0xff));
+		data.append(char(Version >> 8));
+		if (!writeChunk(HeaderChunk, data))
+			return false;
+		m_hasHeader = true;
+	}
+
+	// The new strings go before the game
+	const QList< QPair<QString, QString> > tags = record.tags();
+	QVector<quint32> tagIndexes;
+	tagIndexes.reserve(tags.size());
+	for (const auto& tag : tags)
+		tagIndexes << stringIndex(tag.first);
+	quint32 fenIndex = stringIndex(record.startingFenString());
+	quint32 descriptionIndex = stringIndex(record.resultDescription());
+	if (m_status != Ok)
+		return false;
+
+	QByteArray data;
+	QDataStream out(&data, QIODevice::WriteOnly);
+	out.setByteOrder(QDataStream::LittleEndian);
+
+	bool hasEvaluations = record.hasEvaluations();
+	out << quint8(record.result())
+	    << quint8(hasEvaluations ? 1 : 0)
+	    << fenIndex
+	    << descriptionIndex
+	    << quint16(moves.size());
+	for (const GameRecord::MoveData& md : moves)
+		out << GameRecord::packMove(md.move);
+	if (hasEvaluations)
+	{
+		for (const GameRecord::MoveData& md : moves)
+			out << md.score << md.depth << md.time;
+	}
+
+	out << quint16(qMin(tags.size(), 0xffff));
+	for (int i = 0; i < tags.size() && i < 0xffff; i++)
+	{
+		out << tagIndexes.at(i);
+		writeString(out, tags.at(i).second);
+	}
+
+	return writeChunk(GameChunk, data);
+}
+
+bool GameRecordStream::parseGame(const QByteArray& data, GameRecord* record) const
+{
+	QDataStream in(data);
+	in.setByteOrder(QDataStream::LittleEndian);
+
+	quint8 result = 0;
+	quint8 flags = 0;
+	quint32 fenIndex = 0;
+	quint32 descriptionIndex = 0;
+	quint16 plyCount = 0;
+	in >> result >> flags >> fenIndex >> descriptionIndex >> plyCount;
+	if (result > GameRecord::Draw)
+		return false;
+
+	auto string = [this](quint32 index, bool* ok)
+	{
+		if (index == s_noString)
+			return QString();
+		if (index >= quint32(m_readStrings.size()))
+		{
+			*ok = false;
+			return QString();
+		}
+		return m_readStrings.at(int(index));
+	};
+
+	bool ok = true;
+	*record = GameRecord();
+	record->setResult(GameRecord::Result(result));
+	record->setStartingFenString(string(fenIndex, &ok));
+	record->setResultDescription(string(descriptionIndex, &ok));
+
+	QVector<GameRecord::MoveData> moves(plyCount);
+	for (GameRecord::MoveData& md : moves)
+	{
+		quint16 move = 0;
+		in >> move;
+		md.move = GameRecord::unpackMove(move);
+		md.score = GameRecord::NullScore;
+		md.depth = 0;
+		md.time = 0;
+	}
+	record->setEvaluationsEnabled(flags & 1);
+	if (flags & 1)
+	{
+		for (GameRecord::MoveData& md : moves)
+			in >> md.score >> md.depth >> md.time;
+	}
+	for (const GameRecord::MoveData& md : qAsConst(moves))
+		record->addMove(md);
+
+	quint16 tagCount = 0;
+	in >> tagCount;
+	for (int i = 0; i < tagCount; i++)
+	{
+		quint32 nameIndex = 0;
+		in >> nameIndex;
+		QString name(string(nameIndex, &ok));
+		record->addTag(name, readString(in));
+	}
+
+	return ok && in.status() == QDataStream::Ok;
+}
+
+bool GameRecordStream::readRecord(GameRecord* record)
+{
+	Q_ASSERT(m_device != nullptr);
+	Q_ASSERT(record != nullptr);
+
+	while (m_status == Ok)
+	{
+		QByteArray header(m_device->read(s_chunkHeaderSize));
+		if (header.isEmpty())
+		{
+			m_status = ReadPastEnd;
+			break;
+		}
+		if (header.size() != s_chunkHeaderSize)
+		{
+			m_status = ReadCorruptData;
+			break;
+		}
+
+		QDataStream in(header);
+		in.setByteOrder(QDataStream::LittleEndian);
+		quint8 type = 0;
+		quint32 size = 0;
+		in >> type >> size;
+
+		if (size > s_maxChunkSize || (!m_hasHeader && type != HeaderChunk))
+		{
+			m_status = ReadCorruptData;
+			break;
+		}
+		QByteArray data(m_device->read(size));
+		if (quint32(data.size()) != size)
+		{
+			m_status = ReadCorruptData;
+			break;
+		}
+
+		switch (type)
+		{
+		case HeaderChunk:
+			if (size < 6 || !data.startsWith(s_magic)
+			||  (quint8(data.at(4)) | quint8(data.at(5)) << 8) > Version)
+			{
+				m_status = ReadCorruptData;
+				break;
+			}
+			m_readStrings.clear();
+			m_hasHeader = true;
+			break;
+		case StringChunk:
+			m_readStrings << QString::fromUtf8(data);
+			break;
+		case GameChunk:
+			if (parseGame(data, record))
+				return true;
+			m_status = ReadCorruptData;
+			break;
+		default:
+			// Unknown chunks from newer versions are skipped
+			break;
+		}
+	}
+
+	return false;
+}
+
+bool GameRecordStream::isGameRecordFile(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QByteArray header(file.read(s_chunkHeaderSize + 4));
+	return header.size() == s_chunkHeaderSize + 4
+	    && header.at(0) == char(HeaderChunk)
+	    && header.endsWith(s_magic);
+}
@@ -0,0 +1,123 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMERECORDSTREAM_H
+#define GAMERECORDSTREAM_H
+
+#include <QtGlobal>
+#include <QHash>
+#include <QStringList>
+class QIODevice;
+class GameRecord;
+
+/*!
+ * \brief A class for reading and writing games in a compact binary format
+ *
+ * The binary game format is meant for saving millions of games and
+ * scanning them quickly. A file is a sequence of chunks; every chunk
+ * starts with a 1-byte type and the 32-bit size of the data that
+ * follows, so unknown chunks can be skipped. All numbers are
+ * little-endian and all strings are UTF-8.
+ *
+ * - Header (type 0): the bytes "CCGR" and a 16-bit format version.
+ *   It starts the file and every section appended to it later, and
+ *   clears the string table.
+ * - String (type 1): a string that gets the next index in the string
+ *   table. Strings that repeat from game to game (tag names, starting
+ *   positions and result descriptions) are stored only once.
+ * - Game (type 2): a 12-byte header (8-bit GameRecord::Result, 8-bit
+ *   flags, 32-bit string index of the starting FEN, 32-bit string index
+ *   of the result description and 16-bit number of plies) followed by
+ *   the moves packed with GameRecord::packMove(). If flag bit 0 is set,
+ *   a 16-bit score, an 8-bit depth and a 32-bit time in milliseconds
+ *   follow for every move. Last come the 16-bit number of tags and for
+ *   each tag the string index of its name and its value as a 16-bit
+ *   length and the bytes. A string index of 0xffffffff means none.
+ *
+ * \sa GameRecord
+ */
+class LIB_EXPORT GameRecordStream
+{
+	public:
+		/*! The current status of the stream. */
+		enum Status
+		{
+			Ok,		//!< The stream is operating normally.
+			ReadPastEnd,	//!< There are no more records to read.
+			ReadCorruptData,//!< The data isn't in the binary game format.
+			WriteFailed	//!< The device couldn't be written to.
+		};
+
+		/*! The format version written by this class. */
+		static const quint16 Version = 1;
+
+		/*! Creates a new stream on \a device. */
+		explicit GameRecordStream(QIODevice* device = nullptr);
+
+		/*! Returns the device the stream operates on. */
+		QIODevice* device() const;
+		/*!
+		 * Sets the device to \a device.
+		 *
+		 * The string table is kept, so the same stream can be used
+		 * to write consecutive parts of one file to different devices.
+		 */
+		void setDevice(QIODevice* device);
+		/*! Returns the status of the stream. */
+		Status status() const;
+		/*!
+		 * Forgets the strings written so far, so that the next record
+		 * starts a new section with its own header.
+		 */
+		void reset();
+
+		/*!
+		 * Reads the next game into \a record.
+		 * Returns false at the end of the data or on error.
+		 */
+		bool readRecord(GameRecord* record);
+		/*!
+		 * Writes \a record to the device.
+		 *
+		 * Returns false if the record has a move that can't be
+		 * packed or the device couldn't be written to.
+		 */
+		bool writeRecord(const GameRecord& record);
+
+		/*! Returns true if \a fileName starts with a binary game header. */
+		static bool isGameRecordFile(const QString& fileName);
+
+	private:
+		enum ChunkType
+		{
+			HeaderChunk,
+			StringChunk,
+			GameChunk
+		};
+
+		bool writeChunk(ChunkType type, const QByteArray& data);
+		quint32 stringIndex(const QString& str);
+		bool parseGame(const QByteArray& data, GameRecord* record) const;
+
+		QIODevice* m_device;
+		Status m_status;
+		bool m_hasHeader;
+		QHash<QString, quint32> m_writeStrings;
+		QStringList m_readStrings;
+};
+
+#endif // GAMERECORDSTREAM_H
@@ -0,0 +1,396 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gamewriter.h"
+#include <QBuffer>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <climits>
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "gamerecord.h"
+
+namespace {
+
+bool syncFile(QFile* file)
+{
+	if (!file->isOpen() || !file->flush())
+		return false;
+#ifdef Q_OS_WIN32
+	HANDLE handle = HANDLE(_get_osfhandle(file->handle()));
+	return FlushFileBuffers(handle) != FALSE;
+#else
+	return ::fsync(file->handle()) == 0;
+#endif
+}
+
+} // anonymous namespace
+
+GameWriter::GameWriter(QObject* parent)
+	: QThread(parent),
+	  m_stopping(false),
+	  m_pgnMode(PgnGame::Verbose),
+	  m_maxQueueSize(1024),
+	  m_peakQueueSize(0),
+	  m_syncInterval(0),
+	  m_syncGameCount(0),
+	  m_unsyncedGameCount(0),
+	  m_writtenGameCount(0),
+	  m_writtenByteCount(0),
+	  m_writeTime(0)
+{
+}
+
+GameWriter::~GameWriter()
+{
+	finish();
+}
+
+void GameWriter::setPgnOutput(const QString& fileName, PgnGame::PgnMode mode)
+{
+	QMutexLocker locker(&m_mutex);
+	m_pgnFileName = fileName;
+	m_pgnMode = mode;
+}
+
+void GameWriter::setBinaryOutput(const QString& fileName)
+{
+	QMutexLocker locker(&m_mutex);
+	m_binaryFileName = fileName;
+}
+
+void GameWriter::setEpdOutput(const QString& fileName)
+{
+	QMutexLocker locker(&m_mutex);
+	m_epdFileName = fileName;
+}
+
+QString GameWriter::pgnOutput() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_pgnFileName;
+}
+
+QString GameWriter::binaryOutput() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_binaryFileName;
+}
+
+QString GameWriter::epdOutput() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_epdFileName;
+}
+
+void GameWriter::setMaxQueueSize(int count)
+{
+	Q_ASSERT(count > 0);
+
+	QMutexLocker locker(&m_mutex);
+	m_maxQueueSize = count;
+	m_queueNotFull.wakeAll();
+}
+
+void GameWriter::setSyncInterval(int msecs, int gameCount)
+{
+	Q_ASSERT(msecs >= 0);
+	Q_ASSERT(gameCount >= 0);
+
+	QMutexLocker locker(&m_mutex);
+	m_syncInterval = msecs;
+	m_syncGameCount = gameCount;
+	m_queueNotEmpty.wakeAll();
+}
+
+void GameWriter::waitForSpace()
+{
+	while (isRunning()
+	&&     m_pgnQueue.size() + m_epdQueue.size() >= m_maxQueueSize)
+		m_queueNotFull.wait(&m_mutex);
+}
+
+void GameWriter::addPgnGame(const PgnGame& game)
+{
+	QMutexLocker locker(&m_mutex);
+	if (m_pgnFileName.isEmpty() && m_binaryFileName.isEmpty())
+		return;
+
+	waitForSpace();
+	m_pgnQueue.append(game);
+	m_pgnQueue.last().setTagReceiver(nullptr);
+	m_peakQueueSize = qMax(m_peakQueueSize,
+			       m_pgnQueue.size() + m_epdQueue.size());
+	m_queueNotEmpty.wakeOne();
+
+	if (!isRunning())
+		start();
+}
+
+void GameWriter::addEpdPosition(const QString& fen)
+{
+	QMutexLocker locker(&m_mutex);
+	if (m_epdFileName.isEmpty())
+		return;
+
+	waitForSpace();
+	m_epdQueue.append(fen);
+	m_peakQueueSize = qMax(m_peakQueueSize,
+			       m_pgnQueue.size() + m_epdQueue.size());
+	m_queueNotEmpty.wakeOne();
+
+	if (!isRunning())
+		start();
+}
+
+void GameWriter::finish()
+{
+	m_mutex.lock();
+	m_stopping = true;
+	m_queueNotEmpty.wakeAll();
+	m_mutex.unlock();
+
+	wait();
+
+	QMutexLocker locker(&m_mutex);
+	m_stopping = false;
+}
+
+int GameWriter::queueSize() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_pgnQueue.size() + m_epdQueue.size();
+}
+
+int GameWriter::peakQueueSize() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_peakQueueSize;
+}
+
+qint64 GameWriter::writtenGameCount() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_writtenGameCount;
+}
+
+qint64 GameWriter::writtenByteCount() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_writtenByteCount;
+}
+
+qint64 GameWriter::writeTime() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_writeTime;
+}
+
+bool GameWriter::openFile(QFile* file, const QString& fileName,
+			  const char* type)
+{
+	if (file->fileName() != fileName)
+	{
+		file->close();
+		file->setFileName(fileName);
+	}
+
+	bool isOpen = file->isOpen();
+	if (isOpen && file->exists())
+		return true;
+
+	if (isOpen)
+	{
+		qWarning("%s file %s does not exist. Reopening...",
+			 type, qUtf8Printable(fileName));
+		file->close();
+	}
+
+	if (!file->open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		qWarning("Could not open %s file %s",
+			 type, qUtf8Printable(fileName));
+		return false;
+	}
+	return true;
+}
+
+bool GameWriter::writeBatch(QFile* file, const QString& fileName,
+			    const QByteArray& data, const char* type)
+{
+	if (!openFile(file, fileName, type))
+		return false;
+
+	if (file->write(data) != data.size()
+	||  !file->flush()
+	||  file->error() != QFile::NoError)
+	{
+		qWarning("Could not write to %s file %s",
+			 type, qUtf8Printable(fileName));
+		file->unsetError();
+		return false;
+	}
+	return true;
+}
+
+bool GameWriter::isSyncDue() const
+{
+	if (m_unsyncedGameCount <= 0)
+		return false;
+	return (m_syncGameCount > 0 && m_unsyncedGameCount >= m_syncGameCount)
+	    || (m_syncInterval > 0 && m_syncTimer.elapsed() >= m_syncInterval);
+}
+
+void GameWriter::syncFiles()
+{
+	if ((m_pgnFile.isOpen() && !syncFile(&m_pgnFile))
+	||  (m_binaryFile.isOpen() && !syncFile(&m_binaryFile))
+	||  (m_epdFile.isOpen() && !syncFile(&m_epdFile)))
+		qWarning("Could not sync the game files to disk");
+	m_unsyncedGameCount = 0;
+}
+
+void GameWriter::run()
+{
+	QMutexLocker locker(&m_mutex);
+
+	forever
+	{
+		if (m_pgnQueue.isEmpty() && m_epdQueue.isEmpty())
+		{
+			if (m_stopping)
+				break;
+
+			// Wake up in time for a timed sync
+			unsigned long timeout = ULONG_MAX;
+			if (m_unsyncedGameCount > 0 && m_syncInterval > 0)
+				timeout = ulong(qMax(m_syncInterval
+					  - m_syncTimer.elapsed(), qint64(1)));
+			m_queueNotEmpty.wait(&m_mutex, timeout);
+
+			if (m_pgnQueue.isEmpty() && m_epdQueue.isEmpty())
+			{
+				if (isSyncDue())
+				{
+					QElapsedTimer timer;
+					timer.start();
+					locker.unlock();
+					syncFiles();
+					locker.relock();
+					m_writeTime += timer.elapsed();
+				}
+				continue;
+			}
+		}
+
+		// Take everything that's queued as one batch
+		QList<PgnGame> games;
+		QStringList positions;
+		games.swap(m_pgnQueue);
+		positions.swap(m_epdQueue);
+		const QString pgnFileName(m_pgnFileName);
+		const QString binaryFileName(m_binaryFileName);
+		const QString epdFileName(m_epdFileName);
+		const PgnGame::PgnMode pgnMode(m_pgnMode);
+		m_queueNotFull.wakeAll();
+		locker.unlock();
+
+		QElapsedTimer timer;
+		timer.start();
+		qint64 byteCount = 0;
+
+		if (!games.isEmpty() && !pgnFileName.isEmpty())
+		{
+			QByteArray data;
+			QTextStream out(&data, QIODevice::WriteOnly);
+			for (const PgnGame& game : qAsConst(games))
+			{
+				if (!game.write(out, pgnMode))
+					qWarning("Could not write an empty PGN game");
+			}
+			out.flush();
+			if (writeBatch(&m_pgnFile, pgnFileName, data, "PGN"))
+				byteCount += data.size();
+		}
+		if (!games.isEmpty() && !binaryFileName.isEmpty())
+		{
+			// A new or reopened file starts a new section
+			bool wasOpen = m_binaryFile.isOpen()
+				    && m_binaryFile.fileName() == binaryFileName
+				    && m_binaryFile.exists();
+			if (openFile(&m_binaryFile, binaryFileName, "binary"))
+			{
+				if (!wasOpen)
+					m_recordStream.reset();
+
+				QByteArray data;
+				QBuffer buffer(&data);
+				buffer.open(QIODevice::WriteOnly);
+				m_recordStream.setDevice(&buffer);
+				for (const PgnGame& game : qAsConst(games))
+				{
+					if (!m_recordStream.writeRecord(GameRecord(game)))
+						qWarning("Could not write a binary game");
+				}
+				m_recordStream.setDevice(nullptr);
+
+				if (writeBatch(&m_binaryFile, binaryFileName, data, "binary"))
+					byteCount += data.size();
+				else
+					m_recordStream.reset();
+			}
+		}
+		if (!positions.isEmpty())
+		{
+			QByteArray data;
+			QTextStream out(&data, QIODevice::WriteOnly);
+			for (const QString& fen : qAsConst(positions))
+				out << fen << "\n";
+			out.flush();
+			if (writeBatch(&m_epdFile, epdFileName, data, "EPD"))
+				byteCount += data.size();
+		}
+
+		locker.relock();
+		if (m_unsyncedGameCount == 0)
+			m_syncTimer.start();
+		m_unsyncedGameCount += qMax(games.size(), positions.size());
+		if (isSyncDue())
+		{
+			locker.unlock();
+			syncFiles();
+			locker.relock();
+		}
+
+		m_writtenGameCount += games.size();
+		m_writtenByteCount += byteCount;
+		m_writeTime += timer.elapsed();
+	}
+
+	bool sync = m_unsyncedGameCount > 0
+		 && (m_syncInterval > 0 || m_syncGameCount > 0);
+	locker.unlock();
+	if (sync)
+		syncFiles();
+	m_pgnFile.close();
+	m_binaryFile.close();
+	m_epdFile.close();
+}
@@ -0,0 +1,154 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMEWRITER_H
+#define GAMEWRITER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QStringList>
+#include "pgngame.h"
+#include "gamerecordstream.h"
+
+/*!
+ * \brief A thread that writes finished games to PGN, binary and EPD files
+ *
+ * The games and positions are queued by the thread that finishes the
+ * games, and written in batches by GameWriter's own thread, so that
+ * formatting the games and waiting for the disk don't stall the
+ * scheduling of new games.
+ *
+ * The queue is bounded: when it's full, addPgnGame() and
+ * addEpdPosition() block until the writer has caught up. The files are
+ * synced to disk every syncInterval() milliseconds or every
+ * syncGameCount() games, whichever comes first.
+ *
+ * \sa Tournament
+ */
+class LIB_EXPORT GameWriter : public QThread
+{
+	Q_OBJECT
+
+	public:
+		/*! Creates a new GameWriter. */
+		explicit GameWriter(QObject* parent = nullptr);
+		/*! Writes the queued games and stops the thread. */
+		virtual ~GameWriter();
+
+		/*!
+		 * Sets the PGN output file to \a fileName and the PGN mode
+		 * to \a mode. An empty \a fileName disables PGN output.
+		 */
+		void setPgnOutput(const QString& fileName,
+				  PgnGame::PgnMode mode = PgnGame::Verbose);
+		/*!
+		 * Sets the binary game output file to \a fileName.
+		 * An empty \a fileName disables binary output.
+		 *
+		 * \sa GameRecordStream
+		 */
+		void setBinaryOutput(const QString& fileName);
+		/*!
+		 * Sets the EPD output file to \a fileName.
+		 * An empty \a fileName disables EPD output.
+		 */
+		void setEpdOutput(const QString& fileName);
+		/*! Returns the PGN output file name. */
+		QString pgnOutput() const;
+		/*! Returns the binary game output file name. */
+		QString binaryOutput() const;
+		/*! Returns the EPD output file name. */
+		QString epdOutput() const;
+
+		/*!
+		 * Sets the maximum number of games and positions waiting
+		 * to be written to \a count. The default is 1024.
+		 */
+		void setMaxQueueSize(int count);
+		/*!
+		 * Syncs the files to disk every \a msecs milliseconds and
+		 * every \a gameCount games. A value of 0 disables the
+		 * condition; by default the files are never synced.
+		 */
+		void setSyncInterval(int msecs, int gameCount = 0);
+
+		/*! Queues \a game to be written to the PGN and binary files. */
+		void addPgnGame(const PgnGame& game);
+		/*! Queues \a fen to be written to the EPD file. */
+		void addEpdPosition(const QString& fen);
+
+		/*!
+		 * Writes all queued games and positions, syncs the files and
+		 * stops the thread. The writer is restarted by the next
+		 * addPgnGame() or addEpdPosition() call.
+		 */
+		void finish();
+
+		/*! Returns the number of games and positions in the queue. */
+		int queueSize() const;
+		/*! Returns the largest queue size seen so far. */
+		int peakQueueSize() const;
+		/*! Returns the number of games written so far. */
+		qint64 writtenGameCount() const;
+		/*! Returns the number of bytes written so far. */
+		qint64 writtenByteCount() const;
+		/*! Returns the time spent writing and syncing in milliseconds. */
+		qint64 writeTime() const;
+
+	protected:
+		// Inherited from QThread
+		virtual void run();
+
+	private:
+		bool openFile(QFile* file, const QString& fileName,
+			      const char* type);
+		bool writeBatch(QFile* file, const QString& fileName,
+				const QByteArray& data, const char* type);
+		bool isSyncDue() const;
+		void syncFiles();
+		void waitForSpace();
+
+		mutable QMutex m_mutex;
+		QWaitCondition m_queueNotEmpty;
+		QWaitCondition m_queueNotFull;
+		bool m_stopping;
+		QString m_pgnFileName;
+		QString m_binaryFileName;
+		QString m_epdFileName;
+		QFile m_pgnFile;
+		QFile m_binaryFile;
+		QFile m_epdFile;
+		GameRecordStream m_recordStream;
+		PgnGame::PgnMode m_pgnMode;
+		QList<PgnGame> m_pgnQueue;
+		QStringList m_epdQueue;
+		int m_maxQueueSize;
+		int m_peakQueueSize;
+		int m_syncInterval;
+		int m_syncGameCount;
+		int m_unsyncedGameCount;
+		QElapsedTimer m_syncTimer;
+		qint64 m_writtenGameCount;
+		qint64 m_writtenByteCount;
+		qint64 m_writeTime;
+};
+
+#endif // GAMEWRITER_H
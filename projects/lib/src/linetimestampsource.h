@@ -0,0 +1,49 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LINETIMESTAMPSOURCE_H
+#define LINETIMESTAMPSOURCE_H
+
+#include <QtGlobal>
+
+/*!
+ * \brief Arrival times of the lines read from an engine
+ *
+ * A device that reads the engine's output in its own thread knows when
+ * each line actually arrived, which can be well before the game thread
+ * gets to read it. ChessEngine uses these timestamps to stop the clock
+ * at the arrival of the engine's move instead of when it's processed.
+ *
+ * \sa ChessEngine::setDevice()
+ */
+class LineTimestampSource
+{
+	public:
+		/*! Destroys the timestamp source. */
+		virtual ~LineTimestampSource() {}
+
+		/*!
+		 * Returns the TimeControl::currentTime() when the oldest
+		 * line that wasn't timestamped yet arrived, and moves on to
+		 * the next line.
+		 *
+		 * Returns -1 if the arrival time isn't known.
+		 */
+		virtual qint64 takeLineTimestamp() = 0;
+};
+
+#endif // LINETIMESTAMPSOURCE_H
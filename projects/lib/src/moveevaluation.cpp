@@ -17,6 +17,7 @@
 */
 
 #include "moveevaluation.h"
+#include "pvconverter.h"
 
 MoveEvaluation::MoveEvaluation()
 	: m_isBookEval(false),
@@ -30,7 +31,8 @@ MoveEvaluation::MoveEvaluation()
 	  m_ponderhitRate(0),
 	  m_nodeCount(0),
 	  m_nps(0),
-	  m_tbHits(0)
+	  m_tbHits(0),
+	  m_pvKey(0)
 {
 }
 
@@ -182,9 +184,21 @@ QString MoveEvaluation::ponderMove() const
 
 QString MoveEvaluation::pv() const
 {
+	if (m_pvConverter)
+	{
+		m_pv = m_pvConverter->convert(m_pvKey, m_rawPv);
+		m_pvConverter.clear();
+	}
 	return m_pv;
 }
 
+QString MoveEvaluation::rawPv() const
+{
+	if (m_rawPv.isEmpty())
+		return m_pv;
+	return m_rawPv;
+}
+
 int MoveEvaluation::pvNumber() const
 {
 	return m_pvNumber;
@@ -203,7 +217,10 @@ void MoveEvaluation::clear()
 	m_tbHits = 0;
 	m_hashUsage = 0;
 	m_ponderhitRate = 0;
+	m_pvKey = 0;
 	m_pv.clear();
+	m_rawPv.clear();
+	m_pvConverter.clear();
 	m_ponderMove.clear();
 }
 
@@ -269,7 +286,20 @@ void MoveEvaluation::setPonderMove(const QString& san)
 
 void MoveEvaluation::setPv(const QString& pv)
 {
+	m_pvKey = 0;
 	m_pv = pv;
+	m_rawPv.clear();
+	m_pvConverter.clear();
+}
+
+void MoveEvaluation::setRawPv(const QString& pv,
+			      const QSharedPointer<PvConverter>& converter,
+			      quint64 key)
+{
+	m_pvKey = key;
+	m_pv.clear();
+	m_rawPv = pv;
+	m_pvConverter = converter;
 }
 
 void MoveEvaluation::setPvNumber(int number)
@@ -296,8 +326,13 @@ void MoveEvaluation::merge(const MoveEvaluation& other)
 		m_ponderhitRate = other.m_ponderhitRate;
 	if (!other.m_ponderMove.isEmpty())
 		m_ponderMove = other.m_ponderMove;
-	if (!other.m_pv.isEmpty())
+	if (!other.m_pv.isEmpty() || !other.m_rawPv.isEmpty())
+	{
+		m_pvKey = other.m_pvKey;
 		m_pv = other.m_pv;
+		m_rawPv = other.m_rawPv;
+		m_pvConverter = other.m_pvConverter;
+	}
 	if (other.m_pvNumber)
 		m_pvNumber = other.m_pvNumber;
 	if (other.m_score != NULL_SCORE)
@@ -21,6 +21,9 @@
 
 #include <QString>
 #include <QMetaType>
+#include <QSharedPointer>
+
+class PvConverter;
 
 /*!
  * \brief Evaluation data for a chess move.
@@ -124,10 +127,19 @@ class LIB_EXPORT MoveEvaluation
 		 * The principal variation.
 		 * This is a sequence of moves that an engine
 		 * expects to be played next.
+		 *
+		 * A PV set with setRawPv() is converted to Chinese
+		 * notation by the first call.
 		 * \note For human players this is always empty.
 		 */
 		QString pv() const;
 
+		/*!
+		 * The principal variation in the engine's own notation,
+		 * or pv() if it wasn't set with setRawPv().
+		 */
+		QString rawPv() const;
+
 		/*!
 		 * Returns the principal variation number (default 0).
 		 * \note For human players this is always 0.
@@ -177,6 +189,16 @@ class LIB_EXPORT MoveEvaluation
 		/*! Sets the principal variation to \a pv. */
 		void setPv(const QString& pv);
 
+		/*!
+		 * Sets the principal variation to \a pv, a list of moves
+		 * in the engine's notation from the position \a key of
+		 * \a converter. The moves are converted only when pv()
+		 * is called.
+		 */
+		void setRawPv(const QString& pv,
+			      const QSharedPointer<PvConverter>& converter,
+			      quint64 key);
+
 		/*! Sets the principal variation number to \a number. */
 		void setPvNumber(int number);
 
@@ -196,7 +218,10 @@ class LIB_EXPORT MoveEvaluation
 		quint64 m_nodeCount;
 		quint64 m_nps;
 		quint64 m_tbHits;
-		QString m_pv;
+		quint64 m_pvKey;
+		mutable QString m_pv;
+		QString m_rawPv;
+		mutable QSharedPointer<PvConverter> m_pvConverter;
 		QString m_ponderMove;
 };
 
@@ -24,11 +24,43 @@
 #include "pgngame.h"
 #include "pgnstream.h"
 #include "mersenne.h"
+#include "compiledbook.h"
 
 //#include "ConnectionPool.h"
-//#include "databasemanager.h"
+#include "databasemanager.h"
 
+namespace {
 
+const char* s_entriesSql = "select vmove, vscore, vvalid from bhobk where vkey = ?";
+
+QString bookConnectionName(const QString& fileName)
+{
+	return QString("OpeningBook:%1").arg(fileName);
+}
+
+// Returns true if some index on bhobk starts with the vkey column.
+// Without one, every probe is a full table scan.
+bool hasKeyIndex(const QSqlDatabase& db)
+{
+	QSqlQuery indexes(db);
+	if (!indexes.exec("PRAGMA index_list(bhobk)"))
+		return false;
+
+	while (indexes.next())
+	{
+		QString name = indexes.value("name").toString();
+		QSqlQuery columns(db);
+		if (!columns.exec(QString("PRAGMA index_info(\"%1\")").arg(name)))
+			continue;
+		if (columns.next()
+		&&  columns.value("name").toString().compare("vkey", Qt::CaseInsensitive) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+} // anonymous namespace
 
 QDataStream& operator>>(QDataStream& in, OpeningBook* book)
 {
@@ -60,41 +92,37 @@ OpeningBook::~OpeningBook()
 {
 }
 
-QString getRandomString(int length)
-{
-	qsrand(QDateTime::currentMSecsSinceEpoch());//Ϊֵ趨һseed
-
-	const char chrs[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
-	int chrs_size = sizeof(chrs);
-
-	char* ch = new char[length + 1];
-	memset(ch, 0, length + 1);
-	int randomx = 0;
-	for (int i = 0; i < length; ++i)
-	{
-		randomx = rand() % (chrs_size - 1);
-		ch[i] = chrs[randomx];
-	}
-
-	QString ret(ch);
-	delete[] ch;
-	return ret;
-}
-
 bool OpeningBook::read(const QString& filename)
 {
    
 	this->m_filename = filename;
 
-	QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", getRandomString(10));
-	db.setDatabaseName(this->m_filename);
-	
-	if (!db.open()) {
+	if (CompiledBook::isCompiledBook(m_filename)) {
+		m_compiled = CompiledBook::open(m_filename);
+		if (m_compiled.isNull()) {
+			qWarning("Cannot open compiled opening book %s",
+				 qUtf8Printable(m_filename));
+			return false;
+		}
+		return true;
+	}
+	m_compiled.reset();
+
+	// The connection stays open: later lookups from this thread reuse
+	// it, and every other thread gets its own read-only handle.
+	QSqlDatabase db = DatabaseManager::database(bookConnectionName(m_filename),
+						    m_filename, true);
+	if (!db.isOpen()) {
 		qWarning("򲻿ֿļ %s",
 			qUtf8Printable(this->m_filename));
 		return false;
 	}
-	db.close();
+
+	if (!hasKeyIndex(db))
+		qWarning("Opening book %s has no index on bhobk.vkey; "
+			 "every lookup scans the whole table",
+			 qUtf8Printable(m_filename));
+
 	return true;
 }
 
@@ -185,41 +213,36 @@ QList<OpeningBook::Entry> OpeningBook::entriesFromDisk(quint64 key) const
 {
 	QList<Entry> entries;
 
-	QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", getRandomString(10));
-	db.setDatabaseName(this->m_filename);
-	if (!db.open()) {
-		qWarning("򲻿ֿļ %s",
+	QSqlQuery* query = DatabaseManager::preparedQuery(
+		bookConnectionName(m_filename), m_filename, s_entriesSql);
+	if (query == nullptr) {
+		qWarning("Cannot query opening book %s",
 			qUtf8Printable(this->m_filename));
 		return entries;
 	}
 
-	QSqlQuery query(db);
-
 	//key = 0x628d04d7c9c144ae;						// ֳʼhash
 	//qint64 ikey = 0xa1ead1f6470e07ee;
 	//quint64 ukey = 0xa1ead1f6470e07ee;
 
-	QString sql = "select * from bhobk where vkey = ?";
-	query.prepare(sql);
 	qint64 ikey = key;
 	if (ikey > 0) {		
-		query.bindValue(0, key);
+		query->bindValue(0, key);
 	}
 	else {
 		double dkey;
 		memcpy(&dkey, &key, sizeof(qint64));	// SQlite3 ϸ uint64 key
-		query.bindValue(0, dkey);
+		query->bindValue(0, dkey);
 	}
 
 
-	if (query.exec()) {
+	if (query->exec()) {
 
 		Entry entry;
 
-		query.first();
-		while (query.isValid()) {
+		while (query->next()) {
 
-			quint32 mbh = query.value("vmove").toInt();
+			quint32 mbh = query->value(0).toInt();
 
 			// Ҫתһ
 			int from = mbh >> 8;
@@ -236,11 +259,11 @@ QList<OpeningBook::Entry> OpeningBook::entriesFromDisk(quint64 key) const
 
 			//Chess::Move move = m_board->moveFromGenericMove(bookMove);				// 
 
-			entry.vscore = query.value("vscore").toInt();
+			entry.vscore = query->value(1).toInt();
 			//entry.win_count = query.value("vwin").toInt();
 			//entry.draw_count = query.value("vdraw").toInt();
 			//entry.lost_connt = query.value("vlost").toInt();
-			entry.valid = query.value("vvalid").toInt();
+			entry.valid = query->value(2).toInt();
 			//entry.comments = query.value("vmemo").toString();
 			//entry.vindex = query.value("vindex").toInt();
 
@@ -251,20 +274,41 @@ QList<OpeningBook::Entry> OpeningBook::entriesFromDisk(quint64 key) const
 			if(entry.vscore > 0 && entry.valid == 1){  // ֻѡ0֣Ч岽
 				entries << entry;
 			}
-
-			if (!query.next()) {   // ƶһжǲǵδβ
-				break;
-			}
 		}		
 	}
 
-	db.close();
+	// Release the read lock but keep the statement prepared
+	query->finish();
+
+	return entries;
+}
+
+QList<OpeningBook::Entry> OpeningBook::entriesFromCompiled(quint64 key) const
+{
+	QList<Entry> entries;
+
+	int count = 0;
+	const CompiledBook::Record* record = m_compiled->find(key, &count);
+	for (int i = 0; i < count; i++, record++)
+	{
+		// Same filter as the SQL path
+		if (record->score <= 0 || record->valid != 1)
+			continue;
+
+		Entry entry;
+		entry.move = CompiledBook::genericMove(record->move);
+		entry.vscore = record->score;
+		entry.valid = record->valid;
+		entries << entry;
+	}
 
 	return entries;
 }
 
 QList<OpeningBook::Entry> OpeningBook::entries(quint64 key) const
 {
+	if (!m_compiled.isNull())
+		return entriesFromCompiled(key);
 	return entriesFromDisk(key);
 }
 
@@ -22,6 +22,7 @@
 #include <QtGlobal>
 #include <QMultiMap>
 #include <QtSql>
+#include <QSharedPointer>
 #include "board/genericmove.h"
 
 //#include "sqlite3.h"
@@ -31,6 +32,7 @@ class QString;
 class QDataStream;
 class PgnGame;
 class PgnStream;
+class CompiledBook;
 
 
 /*!
@@ -130,6 +132,11 @@ class LIB_EXPORT OpeningBook
 
 		/*!
 		 * Reads a book from \a filename.
+		 *
+		 * \a filename can be a bhobk SQLite database or a book
+		 * compiled with CompiledBook::compile(); the format is
+		 * detected from the file header.
+		 *
 		 * Returns true if successful; otherwise returns false.
 		 */
 		bool read(const QString& filename);
@@ -170,10 +177,12 @@ class LIB_EXPORT OpeningBook
 
 	private:
 		QList<Entry> entriesFromDisk(quint64 key) const;
+		QList<Entry> entriesFromCompiled(quint64 key) const;
 
 		BookMoveMode m_mode;
 		QString m_filename;
 		Map m_map;
+		QSharedPointer<const CompiledBook> m_compiled;
 		bool useBerKeyDB;	    	// 
 		bool useSqlliteDB;
 		//QSqlDatabase DB[2];         // ڶ 
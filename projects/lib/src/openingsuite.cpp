@@ -1,11 +1,38 @@
 
 #include "openingsuite.h"
+#include <climits>
+#include <cstring>
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
 #include <QTextStream>
 #include "pgnstream.h"
 #include "epdrecord.h"
 #include "mersenne.h"
 
+namespace {
+
+const char s_indexMagic[8] = { 'C', 'C', 'X', 'Q', 'O', 'I', 'D', 'X' };
+const quint32 s_indexVersion = 1;
+const quint32 s_byteOrder = 0x01020304;
+
+// The index is read and written in native byte order
+struct IndexHeader
+{
+	char magic[8];
+	quint32 version;
+	quint32 byteOrder;
+	quint32 format;
+	quint32 count;
+	// Size and modification time of the suite when it was indexed
+	qint64 fileSize;
+	qint64 modified;
+};
+
+Q_STATIC_ASSERT(sizeof(IndexHeader) == 40);
+
+} // anonymous namespace
+
 OpeningSuite::OpeningSuite(const QString& fen)
 	: m_format(EpdFormat),
 	  m_order(SequentialOrder),
@@ -15,7 +42,10 @@ OpeningSuite::OpeningSuite(const QString& fen)
 	  m_fen(fen),
 	  m_file(nullptr),
 	  m_epdStream(nullptr),
-	  m_pgnStream(nullptr)
+	  m_pgnStream(nullptr),
+	  m_indexFile(nullptr),
+	  m_index(nullptr),
+	  m_indexCount(0)
 {
 }
 
@@ -31,7 +61,10 @@ OpeningSuite::OpeningSuite(const QString& fileName,
 	  m_fileName(fileName),
 	  m_file(nullptr),
 	  m_epdStream(nullptr),
-	  m_pgnStream(nullptr)
+	  m_pgnStream(nullptr),
+	  m_indexFile(nullptr),
+	  m_index(nullptr),
+	  m_indexCount(0)
 {
 }
 
@@ -47,6 +80,7 @@ OpeningSuite::~OpeningSuite()
 		delete m_pgnStream->device();
 		delete m_pgnStream;
 	}
+	closeIndex();
 }
 
 OpeningSuite::Format OpeningSuite::format() const
@@ -72,6 +106,8 @@ bool OpeningSuite::initialize()
 	m_gamesRead = 0;
 	m_gameIndex = 0;
 	m_filePositions.clear();
+	m_shuffled.clear();
+	closeIndex();
 
 	if (m_epdStream != nullptr)
 	{
@@ -98,9 +134,9 @@ bool OpeningSuite::initialize()
 	if (m_format == PgnFormat)
 		m_pgnStream = new PgnStream(m_file);
 
-	if (m_order == RandomOrder)
+	if (m_order == RandomOrder && !loadIndex())
 	{
-		// Create a shuffled vector of file positions
+		// Parse the file positions and index them for the next run
 		for (;;)
 		{
 			FilePosition pos;
@@ -111,30 +147,9 @@ bool OpeningSuite::initialize()
 
 			if (pos.pos == -1)
 				break;
-
-			int i = Mersenne::random() % (m_filePositions.size() + 1);
-			if (i == m_filePositions.size())
-				m_filePositions.append(pos);
-			else
-			{
-				m_filePositions.append(m_filePositions.at(i));
-				m_filePositions[i] = pos;
-			}
-		}
-	}
-	else if (m_order == SequentialOrder)
-	{
-		for (int i = 0; i < m_startIndex; i++)
-		{
-			FilePosition pos;
-			if (m_format == EpdFormat)
-				pos = getEpdPos();
-			else if (m_format == PgnFormat)
-				pos = getPgnPos();
-
-			if (pos.pos == -1)
-				break;
+			m_filePositions.append(pos);
 		}
+		saveIndex();
 	}
 
 	if (m_format == EpdFormat)
@@ -143,6 +158,37 @@ bool OpeningSuite::initialize()
 		m_epdStream = new QTextStream(m_file);
 	}
 
+	if (m_order == SequentialOrder && m_startIndex > 0)
+	{
+		FilePosition pos = { -1, -1 };
+		if (loadIndex())
+		{
+			// Go straight to the first opening
+			pos.pos = m_file->size();
+			if (m_startIndex < positionCount())
+				pos = filePosition(m_startIndex);
+			closeIndex();
+		}
+		else
+		{
+			for (int i = 0; i <= m_startIndex; i++)
+			{
+				if (m_format == EpdFormat)
+					pos = getEpdPos();
+				else if (m_format == PgnFormat)
+					pos = getPgnPos();
+
+				if (pos.pos == -1)
+					break;
+			}
+		}
+
+		if (pos.pos != -1 && m_format == EpdFormat)
+			m_epdStream->seek(pos.pos);
+		else if (pos.pos != -1 && m_format == PgnFormat)
+			m_pgnStream->seek(pos.pos, pos.lineNumber);
+	}
+
 	return true;
 }
 
@@ -159,12 +205,8 @@ PgnGame OpeningSuite::nextGame(int maxPlies)
 		return game;
 
 	FilePosition pos = { -1, -1 };
-	if (m_order == RandomOrder)
-	{
-		pos = m_filePositions.at(m_gameIndex++);
-		if (m_gameIndex >= m_filePositions.size())
-			m_gameIndex = 0;
-	}
+	if (m_order == RandomOrder && positionCount() > 0)
+		pos = filePosition(randomPosition());
 
 	bool ok = false;
 	if (m_format == EpdFormat)
@@ -268,3 +310,113 @@ OpeningSuite::FilePosition OpeningSuite::getEpdPos()
 
 	return pos;
 }
+
+QString OpeningSuite::indexFileName() const
+{
+	return m_fileName + ".idx";
+}
+
+bool OpeningSuite::loadIndex()
+{
+	closeIndex();
+
+	QFileInfo info(m_fileName);
+	QFile* file = new QFile(indexFileName());
+	if (!file->open(QIODevice::ReadOnly)
+	||  file->size() < qint64(sizeof(IndexHeader)))
+	{
+		delete file;
+		return false;
+	}
+
+	const uchar* data = file->map(0, file->size());
+	IndexHeader header;
+	if (data != nullptr)
+		memcpy(&header, data, sizeof(header));
+
+	// A stale or foreign index is ignored and rebuilt
+	if (data == nullptr
+	||  memcmp(header.magic, s_indexMagic, sizeof(s_indexMagic)) != 0
+	||  header.version != s_indexVersion
+	||  header.byteOrder != s_byteOrder
+	||  header.format != quint32(m_format)
+	||  header.count > quint32(INT_MAX)
+	||  header.fileSize != info.size()
+	||  header.modified != info.lastModified().toMSecsSinceEpoch()
+	||  file->size() != qint64(sizeof(header) + header.count * sizeof(FilePosition)))
+	{
+		delete file;
+		return false;
+	}
+
+	m_indexFile = file;
+	m_index = reinterpret_cast<const FilePosition*>(data + sizeof(header));
+	m_indexCount = int(header.count);
+	return true;
+}
+
+void OpeningSuite::saveIndex() const
+{
+	QFileInfo info(m_fileName);
+	IndexHeader header;
+	memcpy(header.magic, s_indexMagic, sizeof(s_indexMagic));
+	header.version = s_indexVersion;
+	header.byteOrder = s_byteOrder;
+	header.format = quint32(m_format);
+	header.count = quint32(m_filePositions.size());
+	header.fileSize = info.size();
+	header.modified = info.lastModified().toMSecsSinceEpoch();
+
+	// The suite can be in a read-only directory, so failing to
+	// write the index isn't an error
+	QSaveFile file(indexFileName());
+	if (!file.open(QIODevice::WriteOnly))
+		return;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(m_filePositions.constData()),
+		   m_filePositions.size() * sizeof(FilePosition));
+	file.commit();
+}
+
+void OpeningSuite::closeIndex()
+{
+	delete m_indexFile;
+	m_indexFile = nullptr;
+	m_index = nullptr;
+	m_indexCount = 0;
+}
+
+int OpeningSuite::positionCount() const
+{
+	if (m_index != nullptr)
+		return m_indexCount;
+	return m_filePositions.size();
+}
+
+OpeningSuite::FilePosition OpeningSuite::filePosition(int index) const
+{
+	if (m_index != nullptr)
+		return m_index[index];
+	return m_filePositions.at(index);
+}
+
+int OpeningSuite::randomPosition()
+{
+	int count = positionCount();
+	if (m_gameIndex >= count)
+	{
+		m_gameIndex = 0;
+		m_shuffled.clear();
+	}
+
+	// One step of a Fisher-Yates shuffle of the positions. Only the
+	// entries that differ from the identity permutation are stored.
+	int i = m_gameIndex++;
+	int j = i + int(Mersenne::random() % quint32(count - i));
+	int picked = m_shuffled.value(j, j);
+	if (j != i)
+		m_shuffled[j] = m_shuffled.value(i, i);
+	m_shuffled.remove(i);
+
+	return picked;
+}
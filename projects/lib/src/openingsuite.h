@@ -20,6 +20,7 @@
 #define OPENINGSUITE_H
 
 #include <QVector>
+#include <QHash>
 #include "pgngame.h"
 class QString;
 class QFile;
@@ -34,6 +35,12 @@ class PgnStream;
  * reads positions and games from a text stream (eg. a text file)
  * and returns the opening as a PgnGame object.
  *
+ * The file positions of the openings are kept in a sidecar index
+ * file next to the suite (the suite's file name with ".idx"
+ * appended), so that picking openings in random order doesn't need
+ * to parse the whole suite every time. The index is rebuilt when the
+ * suite's size or modification time changes.
+ *
  * \sa EpdRecord
  * \sa PgnGame
  */
@@ -94,8 +101,9 @@ class LIB_EXPORT OpeningSuite
 		 * If \a order is SequentialOrder, this function just opens
 		 * the opening suite file and gets ready to read data. If
 		 * \a order is RandomOrder, the file positions of all the
-		 * openings are parsed from the file, which could take some
-		 * time if the file is large.
+		 * openings are read from the index file, or parsed from the
+		 * suite and saved to a new index file if there's no valid
+		 * index, which could take some time if the file is large.
 		 *
 		 * Returns true if successful; otherwise returns false.
 		 */
@@ -103,6 +111,10 @@ class LIB_EXPORT OpeningSuite
 		/*!
 		 * Reads a new opening from the suite and returns it.
 		 * A maximum of \a maxPlies plies (halfmoves) are read.
+		 *
+		 * In random order every opening is picked once before any
+		 * of them is picked again. The order only depends on the
+		 * state of the Mersenne generator.
 		 */
 		PgnGame nextGame(int maxPlies);
 
@@ -115,6 +127,13 @@ class LIB_EXPORT OpeningSuite
 
 		FilePosition getPgnPos();
 		FilePosition getEpdPos();
+		QString indexFileName() const;
+		bool loadIndex();
+		void saveIndex() const;
+		void closeIndex();
+		int positionCount() const;
+		FilePosition filePosition(int index) const;
+		int randomPosition();
 
 		Format m_format;
 		Order m_order;
@@ -127,6 +146,10 @@ class LIB_EXPORT OpeningSuite
 		QTextStream* m_epdStream;
 		PgnStream* m_pgnStream;
 		QVector<FilePosition> m_filePositions;
+		QFile* m_indexFile;
+		const FilePosition* m_index;
+		int m_indexCount;
+		QHash<int, int> m_shuffled;
 };
 
 #endif // OPENINGSUITE_H
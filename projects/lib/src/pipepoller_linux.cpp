@@ -0,0 +1,191 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pipepoller_linux.h"
+#include <QMutexLocker>
+#include <QList>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include "engineprocess_linux.h"
+#include "timecontrol.h"
+
+namespace {
+
+class PollerPool
+{
+	public:
+		~PollerPool()
+		{
+			qDeleteAll(pollers);
+		}
+
+		QMutex mutex;
+		QList<PipePoller*> pollers;
+};
+
+Q_GLOBAL_STATIC(PollerPool, s_pool)
+
+} // anonymous namespace
+
+PipePoller::PipePoller(QObject* parent)
+	: QThread(parent),
+	  m_epoll(epoll_create1(EPOLL_CLOEXEC)),
+	  m_wakeup(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+	  m_stopping(false)
+{
+	Q_ASSERT(m_epoll != -1);
+	Q_ASSERT(m_wakeup != -1);
+
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.fd = m_wakeup;
+	epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event);
+}
+
+PipePoller::~PipePoller()
+{
+	stop();
+	::close(m_wakeup);
+	::close(m_epoll);
+}
+
+PipePoller* PipePoller::acquire()
+{
+	PollerPool* pool = s_pool();
+	QMutexLocker locker(&pool->mutex);
+
+	PipePoller* poller = nullptr;
+	for (PipePoller* p : qAsConst(pool->pollers))
+	{
+		if (poller == nullptr || p->pipeCount() < poller->pipeCount())
+			poller = p;
+	}
+
+	if (poller == nullptr
+	||  (poller->pipeCount() > 0 && pool->pollers.size() < maxPollers()))
+	{
+		poller = new PipePoller();
+		poller->start();
+		pool->pollers.append(poller);
+	}
+
+	return poller;
+}
+
+int PipePoller::maxPollers()
+{
+	return qBound(1, QThread::idealThreadCount() / 4, 4);
+}
+
+void PipePoller::addPipe(int fd, EngineProcess* process)
+{
+	Q_ASSERT(process != nullptr);
+
+	QMutexLocker locker(&m_mutex);
+
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.fd = fd;
+	if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) == -1)
+	{
+		qWarning("epoll_ctl failed with %d", errno);
+		return;
+	}
+	m_pipes[fd] = process;
+}
+
+void PipePoller::removePipe(int fd)
+{
+	QMutexLocker locker(&m_mutex);
+
+	if (m_pipes.remove(fd) > 0)
+		epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+int PipePoller::pipeCount() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_pipes.size();
+}
+
+void PipePoller::stop()
+{
+	if (!isRunning())
+		return;
+
+	m_mutex.lock();
+	m_stopping = true;
+	m_mutex.unlock();
+
+	quint64 one = 1;
+	if (::write(m_wakeup, &one, sizeof(one)) == -1)
+		qWarning("Can't wake up the pipe poller");
+	wait();
+}
+
+void PipePoller::dispatch(int fd, qint64 timestamp)
+{
+	EngineProcess* process = m_pipes.value(fd);
+	if (process == nullptr)
+		return;
+
+	ssize_t n = ::read(fd, m_buf, BufSize);
+	if (n > 0)
+	{
+		process->appendOutput(m_buf, int(n), timestamp);
+		return;
+	}
+	if (n == -1 && (errno == EAGAIN || errno == EINTR))
+		return;
+
+	// End of file or a broken pipe
+	m_pipes.remove(fd);
+	epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+	process->closeOutput();
+}
+
+void PipePoller::run()
+{
+	static const int MaxEvents = 64;
+	epoll_event events[MaxEvents];
+
+	for (;;)
+	{
+		int n = epoll_wait(m_epoll, events, MaxEvents, -1);
+		if (n == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			qWarning("epoll_wait failed with %d", errno);
+			return;
+		}
+		qint64 timestamp = TimeControl::currentTime();
+
+		QMutexLocker locker(&m_mutex);
+		for (int i = 0; i < n; i++)
+		{
+			int fd = events[i].data.fd;
+			if (fd != m_wakeup)
+				dispatch(fd, timestamp);
+			else if (m_stopping)
+				return;
+		}
+	}
+}
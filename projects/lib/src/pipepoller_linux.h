@@ -0,0 +1,92 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIPEPOLLER_LINUX_H
+#define PIPEPOLLER_LINUX_H
+
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+class EngineProcess;
+
+
+/*!
+ * \brief A thread that reads the output of many engines
+ *
+ * PipePoller waits for the output pipes of its engine processes with
+ * epoll(7) and reads whatever arrives into the processes' buffers, so
+ * the engines' threads don't have to watch their pipes. A few pollers
+ * are shared by all engines; acquire() picks the least busy one.
+ *
+ * \note This class is for Linux only
+ * \sa EngineProcess
+ */
+class LIB_EXPORT PipePoller : public QThread
+{
+	Q_OBJECT
+
+	public:
+		/*! Creates a new PipePoller. Call start() to start polling. */
+		PipePoller(QObject* parent = nullptr);
+		/*! Stops polling and destroys the poller. */
+		virtual ~PipePoller();
+
+		/*!
+		 * Returns the poller with the fewest pipes, or starts a new
+		 * one if there are fewer than maxPollers() pollers and all
+		 * of them are in use.
+		 */
+		static PipePoller* acquire();
+		/*!
+		 * Returns the maximum number of shared pollers, a quarter
+		 * of the cores but at least one and at most four.
+		 */
+		static int maxPollers();
+
+		/*! Starts reading \a fd, the output pipe of \a process. */
+		void addPipe(int fd, EngineProcess* process);
+		/*!
+		 * Stops reading \a fd.
+		 *
+		 * When this function returns, the poller doesn't access
+		 * the pipe's process anymore.
+		 */
+		void removePipe(int fd);
+		/*! Returns the number of pipes being read. */
+		int pipeCount() const;
+
+		/*! Stops the polling thread and waits for it to exit. */
+		void stop();
+
+	protected:
+		virtual void run();
+
+	private:
+		static const int BufSize = 0x10000;
+
+		void dispatch(int fd, qint64 timestamp);
+
+		int m_epoll;
+		int m_wakeup;
+		bool m_stopping;
+		mutable QMutex m_mutex;
+		QHash<int, EngineProcess*> m_pipes;
+		char m_buf[BufSize];
+};
+
+#endif // PIPEPOLLER_LINUX_H
@@ -18,6 +18,7 @@
 
 #include "pipereader_win.h"
 #include <QMutexLocker>
+#include "timecontrol.h"
 
 
 PipeReader::PipeReader(HANDLE pipe, QObject* parent)
@@ -44,6 +45,14 @@ bool PipeReader::canReadLine() const
 	return m_lastNewLine <= m_usedBytes.available();
 }
 
+qint64 PipeReader::takeLineTimestamp()
+{
+	QMutexLocker locker(&m_mutex);
+	if (m_lineTimes.isEmpty())
+		return -1;
+	return m_lineTimes.dequeue();
+}
+
 qint64 PipeReader::readData(char* data, qint64 maxSize)
 {
 	int n = qMin(int(maxSize), m_usedBytes.available());
@@ -95,6 +104,7 @@ void PipeReader::run()
 				qWarning("ReadFile failed with 0x%x", int(err));
 			return;
 		}
+		qint64 readTime = TimeControl::currentTime();
 
 		m_end += dwRead;
 		Q_ASSERT(m_end <= m_bufEnd);
@@ -102,12 +112,12 @@ void PipeReader::run()
 		QMutexLocker locker(&m_mutex);
 
 		m_lastNewLine += dwRead;
-		for (int i = 1; i <= int(dwRead); i++)
+		for (int i = int(dwRead); i >= 1; i--)
 		{
 			if (*(m_end - i) == '\n')
 			{
 				m_lastNewLine = i;
-				break;
+				m_lineTimes.enqueue(readTime);
 			}
 		}
 
@@ -23,6 +23,7 @@
 #include <QThread>
 #include <QMutex>
 #include <QSemaphore>
+#include <QQueue>
 
 
 /*!
@@ -58,6 +59,13 @@ class LIB_EXPORT PipeReader : public QThread
 		/*! Returns true if a complete line of data can be read. */
 		bool canReadLine() const;
 
+		/*!
+		 * Returns the TimeControl::currentTime() when the oldest
+		 * line that wasn't timestamped yet was read from the pipe,
+		 * or -1 if there are no such lines.
+		 */
+		qint64 takeLineTimestamp();
+
 	signals:
 		/*! There's a new line of data available. */
 		void readyRead();
@@ -77,6 +85,7 @@ class LIB_EXPORT PipeReader : public QThread
 		QSemaphore m_freeBytes;
 		QSemaphore m_usedBytes;
 		int m_lastNewLine;
+		QQueue<qint64> m_lineTimes;
 };
 
 #endif // PIPEREADER_WIN_H
@@ -0,0 +1,131 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pvconverter.h"
+#include <QMutexLocker>
+#include <QStringList>
+#include "board/board.h"
+
+namespace {
+
+// The positions of the current and the previous few searches are kept,
+// so evaluations that arrive late can still be converted
+const int s_maxPositions = 4;
+
+// Limit for the memoized PV prefixes of one position
+const int s_maxPrefixes = 4096;
+
+} // anonymous namespace
+
+PvConverter::PvConverter(const QString& owner)
+	: m_owner(owner)
+{
+}
+
+PvConverter::~PvConverter()
+{
+	for (const Position& position : qAsConst(m_positions))
+		delete position.board;
+}
+
+quint64 PvConverter::addPosition(const Chess::Board* board,
+				 const Chess::Move& move)
+{
+	Q_ASSERT(board != nullptr);
+
+	Chess::Board* copy = board->copy();
+	if (!move.isNull())
+		copy->makeMove(move);
+	quint64 key = copy->key();
+
+	QMutexLocker locker(&m_mutex);
+
+	if (m_positions.contains(key))
+	{
+		delete copy;
+		return key;
+	}
+
+	while (m_keys.size() >= s_maxPositions)
+	{
+		Position old = m_positions.take(m_keys.takeFirst());
+		delete old.board;
+	}
+
+	Position& position = m_positions[key];
+	position.board = copy;
+	m_keys << key;
+
+	return key;
+}
+
+QString PvConverter::convert(quint64 key, const QString& pv)
+{
+	QMutexLocker locker(&m_mutex);
+
+	auto pos = m_positions.find(key);
+	if (pos == m_positions.end())
+		return pv;
+
+	auto full = pos->prefixes.constFind(pv);
+	if (full != pos->prefixes.constEnd())
+		return full->pv;
+
+	Chess::Board* board = pos->board;
+	const QStringList tokens = pv.split(' ', QString::SkipEmptyParts);
+	QString prefix;
+	QString result;
+	int movesMade = 0;
+
+	for (const QString& token : tokens)
+	{
+		if (!prefix.isEmpty())
+			prefix += ' ';
+		prefix += token;
+
+		CachedMove cached = pos->prefixes.value(prefix);
+		if (cached.move.isNull())
+		{
+			cached.move = board->moveFromString(token);
+			if (cached.move.isNull())
+			{
+				qWarning("Illegal PV move %s from %s",
+					 qUtf8Printable(token),
+					 qUtf8Printable(m_owner));
+				qWarning("PV: %s", qUtf8Printable(pv));
+				break;
+			}
+
+			cached.pv = result;
+			if (!cached.pv.isEmpty())
+				cached.pv += ' ';
+			cached.pv += board->moveString(cached.move,
+						       Chess::Board::StandardChinese);
+			if (pos->prefixes.size() < s_maxPrefixes)
+				pos->prefixes.insert(prefix, cached);
+		}
+
+		result = cached.pv;
+		board->makeMove(cached.move);
+		movesMade++;
+	}
+
+	for (int i = 0; i < movesMade; i++)
+		board->undoMove();
+
+	return result;
+}
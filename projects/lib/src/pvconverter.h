@@ -0,0 +1,94 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PVCONVERTER_H
+#define PVCONVERTER_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include "board/move.h"
+
+namespace Chess { class Board; }
+
+/*!
+ * \brief Converts engine PVs to Chinese notation on demand
+ *
+ * Engines send their principal variations in coordinate notation many
+ * times per second, but only a few of them are ever displayed. A
+ * PvConverter keeps a private copy of each position an engine searched,
+ * so that MoveEvaluation can convert a PV when it's asked for instead
+ * of when the engine sends it.
+ *
+ * The moves of every converted PV prefix are memoized per position, so
+ * the PVs of successive search depths, which mostly share their first
+ * moves, only parse and format the moves that are new.
+ *
+ * PvConverter is thread-safe: the engine adds positions in its own
+ * thread while the GUI converts PVs in another one.
+ */
+class LIB_EXPORT PvConverter
+{
+	public:
+		/*!
+		 * Creates a new converter. \a owner is the name used in
+		 * the warnings about illegal PV moves.
+		 */
+		explicit PvConverter(const QString& owner = QString());
+		/*! Destroys the converter. */
+		~PvConverter();
+
+		/*!
+		 * Adds a copy of \a board with \a move made on it, or of
+		 * \a board itself if \a move is null.
+		 *
+		 * Returns the position key that convert() takes.
+		 */
+		quint64 addPosition(const Chess::Board* board,
+				    const Chess::Move& move = Chess::Move());
+		/*!
+		 * Converts \a pv, a space separated list of moves in the
+		 * engine's notation, to Chinese notation. The moves are
+		 * made from the position \a key.
+		 *
+		 * The conversion stops at the first illegal move. Returns
+		 * \a pv unchanged if the position is no longer known.
+		 */
+		QString convert(quint64 key, const QString& pv);
+
+	private:
+		struct CachedMove
+		{
+			Chess::Move move;
+			QString pv;
+		};
+		struct Position
+		{
+			Chess::Board* board;
+			QHash<QString, CachedMove> prefixes;
+		};
+
+		Q_DISABLE_COPY(PvConverter)
+
+		QString m_owner;
+		QMutex m_mutex;
+		QHash<quint64, Position> m_positions;
+		QList<quint64> m_keys;
+};
+
+#endif // PVCONVERTER_H
@@ -6,6 +6,7 @@ HEADERS += $$PWD/chessengine.h \
     $$PWD/chessplayer.h \
     $$PWD/engineconfiguration.h \
     $$PWD/openingbook.h \
+    $$PWD/compiledbook.h \
     $$PWD/pgnstream.h \
     $$PWD/pgngame.h \
     $$PWD/polyglotbook.h \
@@ -13,9 +14,13 @@ HEADERS += $$PWD/chessengine.h \
     $$PWD/uciengine.h \
     $$PWD/xboardengine.h \
     $$PWD/moveevaluation.h \
+    $$PWD/pvconverter.h \
     $$PWD/enginemanager.h \
     $$PWD/humanplayer.h \
     $$PWD/engineoption.h \
+    $$PWD/enginelinereader.h \
+    $$PWD/linetimestampsource.h \
+    $$PWD/enginetranscript.h \
     $$PWD/enginespinoption.h \
     $$PWD/enginecombooption.h \
     $$PWD/enginecheckoption.h \
@@ -23,6 +28,9 @@ HEADERS += $$PWD/chessengine.h \
     $$PWD/enginebuttonoption.h \
     $$PWD/pgngameentry.h \
     $$PWD/gamemanager.h \
+    $$PWD/gamewriter.h \
+    $$PWD/gamerecord.h \
+    $$PWD/gamerecordstream.h \
     $$PWD/playerbuilder.h \
     $$PWD/enginebuilder.h \
     $$PWD/classregistry.h \
@@ -51,6 +59,7 @@ SOURCES += $$PWD/chessengine.cpp \
     $$PWD/chessplayer.cpp \
     $$PWD/engineconfiguration.cpp \
     $$PWD/openingbook.cpp \
+    $$PWD/compiledbook.cpp \
     $$PWD/pgnstream.cpp \
     $$PWD/pgngame.cpp \
     $$PWD/polyglotbook.cpp \
@@ -58,9 +67,12 @@ SOURCES += $$PWD/chessengine.cpp \
     $$PWD/uciengine.cpp \
     $$PWD/xboardengine.cpp \
     $$PWD/moveevaluation.cpp \
+    $$PWD/pvconverter.cpp \
     $$PWD/enginemanager.cpp \
     $$PWD/humanplayer.cpp \
     $$PWD/engineoption.cpp \
+    $$PWD/enginelinereader.cpp \
+    $$PWD/enginetranscript.cpp \
     $$PWD/enginespinoption.cpp \
     $$PWD/enginecombooption.cpp \
     $$PWD/enginecheckoption.cpp \
@@ -68,6 +80,9 @@ SOURCES += $$PWD/chessengine.cpp \
     $$PWD/enginebuttonoption.cpp \
     $$PWD/pgngameentry.cpp \
     $$PWD/gamemanager.cpp \
+    $$PWD/gamewriter.cpp \
+    $$PWD/gamerecord.cpp \
+    $$PWD/gamerecordstream.cpp \
     $$PWD/playerbuilder.cpp \
     $$PWD/enginebuilder.cpp \
     $$PWD/enginefactory.cpp \
@@ -96,3 +111,9 @@ win32 {
     SOURCES += $$PWD/engineprocess_win.cpp \
 	$$PWD/pipereader_win.cpp
 }
+linux { 
+    HEADERS += $$PWD/engineprocess_linux.h \
+	$$PWD/pipepoller_linux.h
+    SOURCES += $$PWD/engineprocess_linux.cpp \
+	$$PWD/pipepoller_linux.cpp
+}
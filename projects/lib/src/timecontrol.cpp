@@ -52,9 +52,13 @@ TimeControl::TimeControl()
 	  m_plyLimit(0),
 	  m_nodeLimit(0),
 	  m_lastMoveTime(0),
+	  m_lastMoveOverhead(0),
+	  m_lastMoveLag(0),
 	  m_expiryMargin(0),
 	  m_expired(false),
-	  m_infinite(false)
+	  m_infinite(false),
+	  m_clockStart(-1),
+	  m_startTime(-1)
 {
 }
 
@@ -68,9 +72,13 @@ TimeControl::TimeControl(const QString& str)
 	  m_plyLimit(0),
 	  m_nodeLimit(0),
 	  m_lastMoveTime(0),
+	  m_lastMoveOverhead(0),
+	  m_lastMoveLag(0),
 	  m_expiryMargin(0),
 	  m_expired(false),
-	  m_infinite(false)
+	  m_infinite(false),
+	  m_clockStart(-1),
+	  m_startTime(-1)
 {
 	if (str == "inf")
 	{
@@ -317,21 +325,47 @@ void TimeControl::setExpiryMargin(int expiryMargin)
 	m_expiryMargin = expiryMargin;
 }
 
+qint64 TimeControl::currentTime()
+{
+	QElapsedTimer timer;
+	timer.start();
+	return timer.msecsSinceReference();
+}
+
 void TimeControl::startTimer()
 {
-	m_time.start();
+	m_clockStart = currentTime();
+	m_startTime = m_clockStart;
 }
 
-void TimeControl::update(bool applyIncrement)
+void TimeControl::setStartTime(qint64 timestamp)
 {
+	if (m_clockStart >= 0 && timestamp > m_clockStart)
+		m_startTime = timestamp;
+}
+
+void TimeControl::update(bool applyIncrement, qint64 timestamp)
+{
+	qint64 now = currentTime();
+	if (timestamp < 0 || timestamp > now)
+		timestamp = now;
+
 	/*
 	 * This will overflow after roughly 49 days however it's unlikely
 	 * we'll ever hit that limit.
 	 */
-	if (m_time.isValid())
-		m_lastMoveTime = (int)m_time.elapsed();
+	if (m_startTime >= 0)
+	{
+		m_lastMoveTime = (int)qMax(timestamp - m_startTime, qint64(0));
+		m_lastMoveOverhead = (int)(m_startTime - m_clockStart);
+		m_lastMoveLag = (int)(now - timestamp);
+	}
 	else
+	{
 		m_lastMoveTime = 0;
+		m_lastMoveOverhead = 0;
+		m_lastMoveLag = 0;
+	}
 
 	if (!m_infinite && m_lastMoveTime > m_timeLeft + m_expiryMargin)
 		m_expired = true;
@@ -364,6 +398,16 @@ int TimeControl::lastMoveTime() const
 	return m_lastMoveTime;
 }
 
+int TimeControl::lastMoveOverhead() const
+{
+	return m_lastMoveOverhead;
+}
+
+int TimeControl::lastMoveLag() const
+{
+	return m_lastMoveLag;
+}
+
 bool TimeControl::expired() const
 {
 	return m_expired;
@@ -371,8 +415,8 @@ bool TimeControl::expired() const
 
 int TimeControl::activeTimeLeft() const
 {
-	if (m_time.isValid())
-		return m_timeLeft - m_time.elapsed();
+	if (m_startTime >= 0)
+		return m_timeLeft - (int)(currentTime() - m_startTime);
 	return m_timeLeft;
 }
 
@@ -171,8 +171,24 @@ class LIB_EXPORT TimeControl
 		void setExpiryMargin(int expiryMargin);
 
 		
+		/*!
+		 * Returns the current time of the monotonic clock used by
+		 * the time controls, in milliseconds.
+		 */
+		static qint64 currentTime();
+
 		/*! Start the timer. */
 		void startTimer();
+		/*!
+		 * Starts billing the move at \a timestamp instead of when
+		 * the timer was started.
+		 *
+		 * Players use this when the command to start thinking
+		 * actually reaches the engine, so that the time spent before
+		 * that isn't charged to the engine. \a timestamp is a
+		 * currentTime() value.
+		 */
+		void setStartTime(qint64 timestamp);
 		
 		/*!
 		 * Update the time control with the elapsed time.
@@ -180,11 +196,24 @@ class LIB_EXPORT TimeControl
 		 * \a applyIncrement is true. This is the default.
 		 * Set this value to false if no increment is necessary for
 		 * the current move, e.g. for a book move.
+		 *
+		 * The move time ends at \a timestamp, the currentTime() when
+		 * the move arrived, or now if \a timestamp is negative.
 		 */
-		void update(bool applyIncrement = true);
+		void update(bool applyIncrement = true, qint64 timestamp = -1);
 
 		/*! Returns the last elapsed move time. */
 		int lastMoveTime() const;
+		/*!
+		 * Returns the time between starting the timer and the start
+		 * of billing for the last move, see setStartTime().
+		 */
+		int lastMoveOverhead() const;
+		/*!
+		 * Returns the time between the arrival of the last move and
+		 * the update() call that processed it.
+		 */
+		int lastMoveLag() const;
 
 		/*! Returns true if the allotted time has expired. */
 		bool expired() const;
@@ -214,10 +243,13 @@ class LIB_EXPORT TimeControl
 		int m_plyLimit;
 		qint64 m_nodeLimit;
 		int m_lastMoveTime;
+		int m_lastMoveOverhead;
+		int m_lastMoveLag;
 		int m_expiryMargin;
 		bool m_expired;
 		bool m_infinite;
-		QElapsedTimer m_time;
+		qint64 m_clockStart;
+		qint64 m_startTime;
 };
 
 #endif // TIMECONTROL_H
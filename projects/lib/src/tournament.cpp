@@ -30,6 +30,7 @@
 #include "openingbook.h"
 #include "sprt.h"
 #include "elo.h"
+#include "gamewriter.h"
 
 Tournament::Tournament(GameManager* gameManager, QObject *parent)
 	: QObject(parent),
@@ -53,16 +54,21 @@ Tournament::Tournament(GameManager* gameManager, QObject *parent)
 	  m_recover(false),
 	  m_pgnCleanup(true),
 	  m_pgnWriteUnfinishedGames(true),
+	  m_pgnOrder(true),
 	  m_finished(false),
 	  m_bookOwnership(false),
 	  m_openingSuite(nullptr),
 	  m_sprt(new Sprt),
+	  m_writer(new GameWriter(this)),
 	  m_repetitionCounter(0),
 	  m_swapSides(true),
-	  m_pgnOutMode(PgnGame::Verbose),
 	  m_pair(nullptr)
 {
 	Q_ASSERT(gameManager != nullptr);
+
+	// Finished games are handed over by the manager in batches
+	connect(m_gameManager, SIGNAL(gameFinished(ChessGame*)),
+		this, SLOT(onGameFinished(ChessGame*)));
 }
 
 Tournament::~Tournament()
@@ -85,12 +91,7 @@ Tournament::~Tournament()
 
 	delete m_openingSuite;
 	delete m_sprt;
-
-	if (m_pgnFile.isOpen())
-		m_pgnFile.close();
-
-	if (m_epdFile.isOpen())
-		m_epdFile.close();
+	delete m_writer;
 }
 
 GameManager* Tournament::gameManager() const
@@ -98,6 +99,11 @@ GameManager* Tournament::gameManager() const
 	return m_gameManager;
 }
 
+const GameWriter* Tournament::gameWriter() const
+{
+	return m_writer;
+}
+
 bool Tournament::isFinished() const
 {
 	return m_finished;
@@ -247,12 +253,7 @@ void Tournament::setSeedCount(int seedCount)
 
 void Tournament::setPgnOutput(const QString& fileName, PgnGame::PgnMode mode)
 {
-	if (fileName != m_pgnFile.fileName())
-	{
-		m_pgnFile.close();
-		m_pgnFile.setFileName(fileName);
-	}
-	m_pgnOutMode = mode;
+	m_writer->setPgnOutput(fileName, mode);
 }
 
 void Tournament::setPgnWriteUnfinishedGames(bool enabled)
@@ -260,18 +261,29 @@ void Tournament::setPgnWriteUnfinishedGames(bool enabled)
 	m_pgnWriteUnfinishedGames = enabled;
 }
 
+void Tournament::setBinaryOutput(const QString& fileName)
+{
+	m_writer->setBinaryOutput(fileName);
+}
+
 void Tournament::setPgnCleanupEnabled(bool enabled)
 {
 	m_pgnCleanup = enabled;
 }
 
+void Tournament::setPgnOrderEnabled(bool enabled)
+{
+	m_pgnOrder = enabled;
+}
+
+void Tournament::setOutputSyncInterval(int msecs, int gameCount)
+{
+	m_writer->setSyncInterval(msecs, gameCount);
+}
+
 void Tournament::setEpdOutput(const QString& fileName)
 {
-	if (fileName != m_epdFile.fileName())
-	{
-		m_epdFile.close();
-		m_epdFile.setFileName(fileName);
-	}
+	m_writer->setEpdOutput(fileName);
 }
 
 void Tournament::setOpeningRepetitions(int count)
@@ -357,8 +369,6 @@ void Tournament::startGame(TournamentPair* pair)
 
 	connect(game, SIGNAL(started(ChessGame*)),
 		this, SLOT(onGameStarted(ChessGame*)));
-	connect(game, SIGNAL(finished(ChessGame*)),
-		this, SLOT(onGameFinished(ChessGame*)));
 
 	game->setTimeControl(white.timeControl(), Chess::Side::White);
 	game->setTimeControl(black.timeControl(), Chess::Side::Black);
@@ -483,88 +493,43 @@ bool Tournament::writePgn(PgnGame* pgn, int gameNumber)
 	Q_ASSERT(pgn != nullptr);
 	Q_ASSERT(gameNumber > 0);
 
-	if (m_pgnFile.fileName().isEmpty())
+	if (m_writer->pgnOutput().isEmpty() && m_writer->binaryOutput().isEmpty())
 		return true;
 
-	bool isOpen = m_pgnFile.isOpen();
-	if (!isOpen || !m_pgnFile.exists())
-	{
-		if (isOpen)
-		{
-			qWarning("PGN file %s does not exist. Reopening...",
-				 qUtf8Printable(m_pgnFile.fileName()));
-			m_pgnFile.close();
-		}
-
-		if (!m_pgnFile.open(QIODevice::WriteOnly | QIODevice::Append))
-		{
-			qWarning("Could not open PGN file %s",
-				 qUtf8Printable(m_pgnFile.fileName()));
-			return false;
-		}
-		m_pgnOut.setDevice(&m_pgnFile);
-	}
-
-	bool ok = true;
+	// The games are formatted and written in the writer's thread
 	m_pgnGames[gameNumber] = *pgn;
-	while (m_pgnGames.contains(m_savedGameCount + 1))
+	while (!m_pgnGames.isEmpty())
 	{
-		PgnGame tmp = m_pgnGames.take(++m_savedGameCount);
+		int number = m_savedGameCount + 1;
+		if (!m_pgnOrder)
+			number = m_pgnGames.firstKey();
+		else if (!m_pgnGames.contains(number))
+			break;
+
+		PgnGame tmp = m_pgnGames.take(number);
+		m_savedGameCount++;
 		Chess::Result::Type type = tmp.result().type();
 		if (!m_pgnWriteUnfinishedGames
 		&&  (tmp.result().isNone() || (m_stopping && faulty(type))))
 		{
-			qWarning("Omitted incomplete game %d", m_savedGameCount);
+			qWarning("Omitted incomplete game %d", number);
 			continue;
 		}
-		if (!tmp.write(m_pgnOut, m_pgnOutMode)
-		||  m_pgnFile.error() != QFile::NoError)
-		{
-			ok = false;
-			qWarning("Could not write PGN game %d", m_savedGameCount);
-		}
+		m_writer->addPgnGame(tmp);
 	}
 
-	return ok;
+	return true;
 }
 
 bool Tournament::writeEpd(ChessGame *game)
 {
 	Q_ASSERT(game != nullptr);
 
-	if (m_epdFile.fileName().isEmpty())
+	if (m_writer->epdOutput().isEmpty())
 		return true;
 
-	bool isOpen = m_epdFile.isOpen();
-	if (!isOpen || !m_epdFile.exists())
-	{
-		if (isOpen)
-		{
-			qWarning("EPD file %s does not exist. Reopening...",
-				 qUtf8Printable(m_epdFile.fileName()));
-			m_epdFile.close();
-		}
-
-		if (!m_epdFile.open(QIODevice::WriteOnly | QIODevice::Append))
-		{
-			qWarning("Could not open EPD file %s",
-				 qUtf8Printable(m_epdFile.fileName()));
-			return false;
-		}
-		m_epdOut.setDevice(&m_epdFile);
-	}
-
-	const QString& epdPos = game->board()->fenString();
-	m_epdOut << epdPos << "\n";
-	m_epdOut.flush();
-	bool ok = true;
-	if (m_epdFile.error() != QFile::NoError)
-	{
-		ok = false;
-		qWarning("Could not write EPD position");
-	}
-
-	return ok;
+	m_writer->addEpdPosition(game->board()->fenString());
+	return true;
 }
 
 void Tournament::addScore(int player, int score)
@@ -590,11 +555,14 @@ void Tournament::onGameFinished(ChessGame* game)
 {
 	Q_ASSERT(game != nullptr);
 
+	// Games of other tournaments sharing the manager
+	if (!m_gameData.contains(game))
+		return;
+
 	PgnGame* pgn(game->pgn());
 
 	m_finishedGameCount++;
 
-	Q_ASSERT(m_gameData.contains(game));
 	GameData* data = m_gameData.take(game);
 	int gameNumber = data->number;
 	Sprt::GameResult sprtResult = Sprt::NoResult;
@@ -686,6 +654,7 @@ void Tournament::onGameStartFailed(ChessGame* game)
 void Tournament::onFinished()
 {
 	m_gameManager->cleanupIdleThreads();
+	m_writer->finish();
 	m_finished = true;
 	emit finished();
 }
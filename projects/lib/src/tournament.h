@@ -37,6 +37,7 @@ class ChessGame;
 class OpeningBook;
 class OpeningSuite;
 class Sprt;
+class GameWriter;
 
 /*!
  * \brief Base class for chess tournaments
@@ -72,6 +73,8 @@ class LIB_EXPORT Tournament : public QObject
 		virtual QString type() const = 0;
 		/*! Returns the GameManager that manages the tournament's games. */
 		GameManager* gameManager() const;
+		/*! Returns the GameWriter that saves the finished games. */
+		const GameWriter* gameWriter() const;
 		/*! Returns true if the tournament is finished; otherwise returns false. */
 		bool isFinished() const;
 		/*! Returns a detailed description of the error. */
@@ -195,6 +198,15 @@ class LIB_EXPORT Tournament : public QObject
 		 */
 		void setPgnWriteUnfinishedGames(bool enabled);
 
+		/*!
+		 * Sets the binary game output file to \a fileName.
+		 *
+		 * The games are saved in the compact format of
+		 * GameRecordStream, in addition to any PGN output. The PGN
+		 * output mode settings apply to the binary output too.
+		 */
+		void setBinaryOutput(const QString& fileName);
+
 		/*!
 		 * Sets PgnGame cleanup mode to \a enabled.
 		 *
@@ -203,6 +215,24 @@ class LIB_EXPORT Tournament : public QObject
 		 */
 		void setPgnCleanupEnabled(bool enabled);
 
+		/*!
+		 * Sets the PGN output order mode to \a enabled.
+		 *
+		 * If \a enabled is true (the default) then the games are
+		 * saved in the order they were started. Otherwise they are
+		 * saved as soon as they finish.
+		 */
+		void setPgnOrderEnabled(bool enabled);
+
+		/*!
+		 * Syncs the PGN and EPD files to disk every \a msecs
+		 * milliseconds and every \a gameCount games.
+		 *
+		 * A value of 0 disables the condition. By default the
+		 * files are never synced.
+		 */
+		void setOutputSyncInterval(int msecs, int gameCount = 0);
+
 		/*!
 		 * Sets the EPD output file for the end positions to \a fileName.
 		 *
@@ -464,19 +494,16 @@ class LIB_EXPORT Tournament : public QObject
 		bool m_recover;
 		bool m_pgnCleanup;
 		bool m_pgnWriteUnfinishedGames;
+		bool m_pgnOrder;
 		bool m_finished;
 		bool m_bookOwnership;
 		GameAdjudicator m_adjudicator;
 		OpeningSuite* m_openingSuite;
 		Sprt* m_sprt;
-		QFile m_pgnFile;
-		QTextStream m_pgnOut;
-		QFile m_epdFile;
-		QTextStream m_epdOut;
+		GameWriter* m_writer;
 		QString m_startFen;
 		int m_repetitionCounter;
 		int m_swapSides;
-		PgnGame::PgnMode m_pgnOutMode;
 		TournamentPair* m_pair;
 		QMap< QPair<int, int>, TournamentPair* > m_pairs;
 		QList<TournamentPlayer> m_players;
@@ -23,6 +23,7 @@
 #include "board/board.h"
 #include "board/boardfactory.h"
 #include "timecontrol.h"
+#include "pvconverter.h"
 
 #include "enginebuttonoption.h"
 #include "enginecheckoption.h"
@@ -85,6 +86,8 @@ QStringRef joinTokens(const QVarLengthArray<QStringRef>& tokens)
 UciEngine::UciEngine(QObject* parent)
 	: ChessEngine(parent),
 	  m_useDirectPv(false),
+	  m_pvKey(0),
+	  m_hasPvKey(false),
 	  m_sendOpponentsName(false),
 	  m_canPonder(false),
 	  m_ponderState(NotPondering),
@@ -140,6 +143,8 @@ void UciEngine::startGame()   // 
 	m_bmBuffer.clear();
 	m_moveStrings.clear();
 	m_useDirectPv = directPvList.contains(board()->variant());
+	m_pvConverter.reset(new PvConverter(name()));
+	m_hasPvKey = false;
 
 	//if (board()->isRandomVariant())
 	//	m_startFen = board()->fenString(Chess::Board::ShredderFen);
@@ -231,10 +236,13 @@ void UciEngine::startThinking()
 	if (m_ponderState == PonderHit)
 	{
 		m_ponderState = NotPondering;
-		write("ponderhit");
+		writeGo("ponderhit");
 		return;
 	}
 
+	// A new search, its PVs start from a new position
+	m_hasPvKey = false;
+
 	const TimeControl* whiteTc = nullptr;
 	const TimeControl* blackTc = nullptr;
 	const TimeControl* myTc = timeControl();
@@ -282,7 +290,7 @@ void UciEngine::startThinking()
 	if (myTc->nodeLimit() > 0)
 		command += QString(" nodes %1").arg(myTc->nodeLimit());
 
-	write(command);
+	writeGo(command);
 }
 
 void UciEngine::startPondering()
@@ -361,7 +369,7 @@ QStringRef UciEngine::parseUciTokens(const QStringRef& first,
 	return token;
 }
 
-void UciEngine::parseInfo(const QVarLengthArray<QStringRef>& tokens,
+void UciEngine::parseInfo(const TokenList& tokens,
 			  int type,
 			  MoveEvaluation* eval)
 {
@@ -391,22 +399,25 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringRef>& tokens,
 	switch (type)
 	{
 	case InfoDepth:
-		eval->setDepth(tokens[0].toString().toInt());
+		eval->setDepth(tokens[0].toInt());
 		break;
 	case InfoSelDepth:
-		eval->setSelectiveDepth(tokens[0].toString().toInt());
+		eval->setSelectiveDepth(tokens[0].toInt());
 		break;
 	case InfoTime:
-		eval->setTime(tokens[0].toString().toInt());
+		eval->setTime(tokens[0].toInt());
 		break;
 	case InfoNodes:
-		eval->setNodeCount(tokens[0].toString().toULongLong());
+		eval->setNodeCount(quint64(tokens[0].toLongLong()));
 		break;
 	case InfoMultiPv:
-		eval->setPvNumber(tokens[0].toString().toInt());
+		eval->setPvNumber(tokens[0].toInt());
 		break;
 	case InfoPv:
-		eval->setPv(m_useDirectPv ?  directPv(tokens) : sanPv(tokens));
+		if (m_useDirectPv)
+			eval->setPv(directPv(tokens));
+		else
+			setRawPv(tokens, eval);
 		break;
 	case InfoScore:
 		{
@@ -415,10 +426,14 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringRef>& tokens,
 			//{
 			int i = 1;
 			if (tokens[i - 1] == "cp")
-				score = tokens[i].toString().toInt();
+			{
+				if (tokens.size() > i)
+					score = tokens[i].toInt();
+			}
 			else if (tokens[i - 1] == "mate")
 			{
-				score = tokens[i].toString().toInt();
+				if (tokens.size() > i)
+					score = tokens[i].toInt();
 				if (score > 0)
 					score = eval->MATE_SCORE + 1 - score * 2;
 				else if (score < 0)
@@ -428,7 +443,7 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringRef>& tokens,
 				|| tokens[i - 1] == "upperbound")
 				return;
 			else {
-				score = tokens[i-1].toString().toInt();
+				score = tokens[i-1].toInt();
 			}
 			//i++;
 			//}
@@ -438,30 +453,31 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringRef>& tokens,
 		}
 		break;
 	case InfoNps:
-		eval->setNps(tokens[0].toString().toULongLong());
+		eval->setNps(quint64(tokens[0].toLongLong()));
 		break;
 	case InfoTbHits:
-		eval->setTbHits(tokens[0].toString().toULongLong());
+		eval->setTbHits(quint64(tokens[0].toLongLong()));
 		break;
 	case InfoHashFull:
-		eval->setHashUsage(tokens[0].toString().toInt());
+		eval->setHashUsage(tokens[0].toInt());
 		break;
 	default:
 		break;
 	}
 }
 
-void UciEngine::parseInfo(const QStringRef& line)
+void UciEngine::parseInfo(const EngineLineReader& line,
+			  const EngineToken& command)
 {
-	static const QString types[] =
+	static const char* const s_keywords[] =
 	{
-		"depth",			//
+		"depth",
 		"seldepth",
 		"time",
 		"nodes",
-		"score",				// by LGL
+		"score",
 		"pv",
-		"multipv",		
+		"multipv",
 		"currmove",
 		"currmovenumber",
 		"hashfull",
@@ -472,10 +488,11 @@ void UciEngine::parseInfo(const QStringRef& line)
 		"refutation",
 		"currline"
 	};
-	
+	static const int s_keywordCount = int(sizeof(s_keywords) / sizeof(s_keywords[0]));
+
 	int type = -1;
-	QStringRef token(nextToken(line));
-	QVarLengthArray<QStringRef> tokens;
+	EngineToken token(line.nextToken(command));
+	TokenList tokens;
 	MoveEvaluation eval;
 
 	// The "string" info is not supported and it can't be parsed
@@ -483,11 +500,21 @@ void UciEngine::parseInfo(const QStringRef& line)
 	if (token == "string")
 		return;
 
-	while (!token.isNull())
+	for (; !token.isNull(); token = line.nextToken(token))
 	{
-		token = parseUciTokens(token, types, 16, tokens, type);
-		parseInfo(tokens, type, &eval);
+		int keyword = token.keyword(s_keywords, s_keywordCount);
+		if (keyword != -1)
+		{
+			if (type != -1)
+				parseInfo(tokens, type, &eval);
+			type = keyword;
+			tokens.clear();
+		}
+		else if (type != -1)
+			tokens.append(token);
 	}
+	if (type != -1)
+		parseInfo(tokens, type, &eval);
 	if (eval.isEmpty())
 		return;
 
@@ -597,15 +624,28 @@ EngineOption* UciEngine::parseOption(const QStringRef& line)
 	return nullptr;
 }
 
+bool UciEngine::parseRawLine(const EngineLineReader& line)
+{
+	const EngineToken command(line.firstToken());
+	if (command != "info")
+		return false;
+
+	if (!m_ignoreThinking)
+		parseInfo(line, command);
+	return true;
+}
+
 void UciEngine::parseLine(const QString& line)
 {
 	const QStringRef command(firstToken(line));
 
 	if (command == "info")
 	{
-		if (m_ignoreThinking)
-			return;
-		parseInfo(command);
+		// Info lines are normally parsed by parseRawLine()
+		EngineLineReader reader;
+		const QByteArray data(line.toLatin1());
+		reader.setLine(data.constData(), data.size());
+		parseRawLine(reader);
 	}
 	else if (command == "bestmove")
 	{
@@ -804,55 +844,38 @@ void UciEngine::setPonderMove(const QString& moveString)
 	}
 }
 
-QString UciEngine::directPv(const QVarLengthArray<QStringRef>& tokens)
+QString UciEngine::directPv(const TokenList& tokens)
 {
 	QString pv;
-	for( auto token : tokens)
+	for (const auto& token : tokens)
 	{
 		pv += " ";
-		pv += token.toString();
+		pv += QLatin1String(token.begin(), token.size());
 	}
 	return pv;
 }
 
-QString UciEngine::sanPv(const QVarLengthArray<QStringRef>& tokens)
+void UciEngine::setRawPv(const TokenList& tokens, MoveEvaluation* eval)
 {
-	Chess::Board* board = this->board();
-	QString pv;
-	int movesMade = 0;
-
-	if (pondering() && !m_ponderMove.isNull())
+	// The PVs are converted to Chinese notation only if someone
+	// asks for them, see MoveEvaluation::pv()
+	if (!m_hasPvKey)
 	{
-		board->makeMove(m_ponderMove);
-		movesMade++;
+		Chess::Move ponderMove;
+		if (pondering())
+			ponderMove = m_ponderMove;
+		m_pvKey = m_pvConverter->addPosition(board(), ponderMove);
+		m_hasPvKey = true;
 	}
 
-	for (auto token : tokens)
+	QString pv;
+	for (const auto& token : tokens)
 	{
-		auto move = board->moveFromString(token.toString());
-		if (move.isNull())
-		{
-			QString tokenString(token.toString());
-			qWarning("Illegal PV move %s from %s (%d)",
-				 qUtf8Printable(tokenString),
-				 qUtf8Printable(name()),
-				 id());
-			qWarning("PV: %s %s",
-				 qUtf8Printable(pv),
-				 qUtf8Printable(tokenString));
-			break;
-		}
 		if (!pv.isEmpty())
-			pv += " ";
-		pv += board->moveString(move, Chess::Board::StandardChinese);
-		board->makeMove(move);
-		movesMade++;
+			pv += ' ';
+		pv += QLatin1String(token.begin(), token.size());
 	}
-
-	for (int i = 0; i < movesMade; i++)
-		board->undoMove();
-
-	return pv;
+	eval->setRawPv(pv, m_pvConverter, m_pvKey);
 }
 
 void UciEngine::sendOption(const QString& name, const QVariant& value)
@@ -20,6 +20,7 @@
 
 #include "chessengine.h"
 #include <QVarLengthArray>
+#include <QSharedPointer>
 
 
 /*!
@@ -52,6 +53,7 @@ class LIB_EXPORT UciEngine : public ChessEngine
 		virtual void startGame();
 		virtual void startThinking();
 		virtual void parseLine(const QString& line);
+		virtual bool parseRawLine(const EngineLineReader& line);
 		virtual void sendOption(const QString& name, const QVariant& value);
 		virtual bool isPondering() const;
 		
@@ -68,23 +70,29 @@ class LIB_EXPORT UciEngine : public ChessEngine
 						 int typeCount,
 						 QVarLengthArray<QStringRef>& tokens,
 						 int& type);
-		void parseInfo(const QVarLengthArray<QStringRef>& tokens,
+		typedef QVarLengthArray<EngineToken, 64> TokenList;
+
+		void parseInfo(const TokenList& tokens,
 			       int type,
 			       MoveEvaluation* eval);
-		void parseInfo(const QStringRef& line);
+		void parseInfo(const EngineLineReader& line,
+			       const EngineToken& command);
 		EngineOption* parseOption(const QStringRef& line);
 		void addVariantsFromOption(const EngineOption* option);
 		void setVariant(const QString& variant);
 		QString positionString();
 		void sendPosition();
 		void setPonderMove(const QString& moveString);
-		QString directPv(const QVarLengthArray<QStringRef>& tokens);
-		QString sanPv(const QVarLengthArray<QStringRef>& tokens);
+		QString directPv(const TokenList& tokens);
+		void setRawPv(const TokenList& tokens, MoveEvaluation* eval);
 		
 		QString m_variantOption;
 		QString m_startFen;
 		QString m_moveStrings;
 		bool m_useDirectPv;
+		QSharedPointer<PvConverter> m_pvConverter;
+		quint64 m_pvKey;
+		bool m_hasPvKey;
 		// Write buffer for messages that will be flushed to the engine
 		// after it sends a "bestmove"
 		QStringList m_bmBuffer;
@@ -2,6 +2,7 @@
 #include <QtConcurrentRun>
 #include <board/board.h>
 #include <board/boardfactory.h>
+#include <board/standardboard.h>
 
 
 class tst_Board: public QObject
@@ -20,10 +21,17 @@ class tst_Board: public QObject
 		
 		void results_data() const;
 		void results();
+		void xiangqiResults_data() const;
+		void xiangqiResults();
 
 		void perft_data() const;
 		void perft();
 
+		void xiangqiPerft_data() const;
+		void xiangqiPerft();
+		void xiangqiPerftBenchmark_data() const;
+		void xiangqiPerftBenchmark();
+
 		void cleanupTestCase();
 	
 	private:
@@ -100,6 +108,35 @@ static quint64 smpPerft(Chess::Board* board, int depth)
 	return nodeCount;
 }
 
+namespace {
+
+/*
+ * A Xiangqi board that can also filter its moves the way every board
+ * did before the dedicated legal move generator: make each
+ * pseudo-legal move, check the position and undo the move.
+ */
+class MakeMoveBoard : public Chess::StandardBoard
+{
+	public:
+		quint64 perft(int depth)
+		{
+			QVarLengthArray<Chess::Move> moves;
+			generateMoves(moves);
+
+			quint64 nodeCount = 0;
+			for (int i = 0; i < moves.size(); i++)
+			{
+				makeMove(moves[i]);
+				if (isLegalPosition())
+					nodeCount += depth <= 1 ? 1 : perft(depth - 1);
+				undoMove();
+			}
+
+			return nodeCount;
+		}
+};
+
+} // anonymous namespace
 
 void tst_Board::zobristKeys_data() const
 {
@@ -1001,6 +1038,59 @@ void tst_Board::results()
 	QCOMPARE(m_board->result().toShortString(), result);
 }
 
+void tst_Board::xiangqiResults_data() const
+{
+	QTest::addColumn<QString>("fen");
+	QTest::addColumn<QString>("moves");
+	QTest::addColumn<QString>("result");
+
+	QTest::newRow("startpos")
+		<< "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1"
+		<< "b0c2 b9c7"
+		<< "*";
+	QTest::newRow("king takes the last rook")
+		<< "3k5/9/9/9/9/9/9/9/4r4/4K4 w - - 0 1"
+		<< "e0e1"
+		<< "1/2-1/2";
+	QTest::newRow("xiang left")
+		<< "3k5/9/4b4/9/9/9/9/9/4r4/4K4 w - - 0 1"
+		<< "e0e1"
+		<< "*";
+	QTest::newRow("checkmate")
+		<< "4k4/R8/9/9/9/9/9/9/9/1R1K5 w - - 0 1"
+		<< "b0b9"
+		<< "1-0";
+}
+
+/*
+ * Plays \a moves and checks the result, then takes the moves back and
+ * checks that the material count followed.
+ */
+void tst_Board::xiangqiResults()
+{
+	QFETCH(QString, fen);
+	QFETCH(QString, moves);
+	QFETCH(QString, result);
+
+	setVariant("standard");
+	QVERIFY(m_board->setFenString(fen));
+	QCOMPARE(m_board->result().toShortString(), QString("*"));
+
+	const QStringList moveList = moves.split(' ');
+	for (const QString& str : moveList)
+	{
+		Chess::Move move = m_board->moveFromString(str);
+		QVERIFY2(!move.isNull(), qPrintable(str));
+		m_board->makeMove(move);
+	}
+	QCOMPARE(m_board->result().toShortString(), result);
+
+	for (int i = 0; i < moveList.size(); i++)
+		m_board->undoMove();
+	QCOMPARE(m_board->result().toShortString(), QString("*"));
+	QCOMPARE(m_board->fenString(), fen);
+}
+
 void tst_Board::perft_data() const
 {
 	QTest::addColumn<QString>("variant");
@@ -1620,5 +1710,75 @@ void tst_Board::perft()
 	QCOMPARE(smpPerft(m_board, depth), nodecount);
 }
 
+void tst_Board::xiangqiPerft_data() const
+{
+	QTest::addColumn<QString>("fen");
+	QTest::addColumn<int>("depth");
+	QTest::addColumn<quint64>("nodecount");
+
+	QTest::newRow("startpos")
+		<< "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1"
+		<< 3 // 1 ply: 44, 2 plies: 1920, 4 plies: 3290240
+		<< Q_UINT64_C(79666);
+}
+
+void tst_Board::xiangqiPerft()
+{
+	QFETCH(QString, fen);
+	QFETCH(int, depth);
+	QFETCH(quint64, nodecount);
+
+	setVariant("standard");
+	QVERIFY(m_board->setFenString(fen));
+	QCOMPARE(perftVal(m_board, depth), nodecount);
+
+	MakeMoveBoard board;
+	board.initialize();
+	QVERIFY(board.setFenString(fen));
+	QCOMPARE(board.perft(depth), nodecount);
+
+	// The square array alone, without the bitboard
+	board.setBitboardEnabled(false);
+	QCOMPARE(perftVal(&board, depth), nodecount);
+	QCOMPARE(board.perft(depth), nodecount);
+	board.setBitboardEnabled(true);
+	QCOMPARE(perftVal(&board, depth), nodecount);
+}
+
+void tst_Board::xiangqiPerftBenchmark_data() const
+{
+	QTest::addColumn<QString>("fen");
+	QTest::addColumn<bool>("makeMove");
+
+	const QString startpos = "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1";
+	const QString middlegame = "r1bakab1r/9/1cn4c1/p1p1p1p1p/9/2P6/P3P1P1P/1C2C1N2/9/RNBAKAB1R b - - 0 1";
+
+	QTest::newRow("startpos legal") << startpos << false;
+	QTest::newRow("startpos makemove") << startpos << true;
+	QTest::newRow("middlegame legal") << middlegame << false;
+	QTest::newRow("middlegame makemove") << middlegame << true;
+}
+
+/*
+ * Perft to depth 3 with the legal move generator and with the
+ * make/unmake filter it replaced.
+ */
+void tst_Board::xiangqiPerftBenchmark()
+{
+	QFETCH(QString, fen);
+	QFETCH(bool, makeMove);
+
+	MakeMoveBoard board;
+	board.initialize();
+	QVERIFY(board.setFenString(fen));
+
+	quint64 nodeCount = 0;
+	QBENCHMARK
+	{
+		nodeCount = makeMove ? board.perft(3) : perftVal(&board, 3);
+	}
+	QVERIFY(nodeCount > 0);
+}
+
 QTEST_MAIN(tst_Board)
 #include "tst_board.moc"
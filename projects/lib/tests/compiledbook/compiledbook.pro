@@ -0,0 +1,5 @@
+include(../tests.pri)
+
+QT += sql
+TARGET = tst_compiledbook
+SOURCES += tst_compiledbook.cpp
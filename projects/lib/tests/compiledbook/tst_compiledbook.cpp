@@ -0,0 +1,209 @@
+#include <QtTest/QtTest>
+#include <QtSql>
+#include <QTemporaryDir>
+#include <cstring>
+#include <polyglotbook.h>
+#include <compiledbook.h>
+
+class tst_CompiledBook: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+
+		void detect();
+		void roundTrip();
+		void misses();
+		void truncated();
+		void corruptBuckets();
+
+	private:
+		QStringList entries(const OpeningBook& book, quint64 key) const;
+
+		QTemporaryDir m_dir;
+		QString m_sqlFileName;
+		QString m_fileName;
+		QList<quint64> m_keys;
+};
+
+namespace {
+
+quint64 nextKey(quint64& state)
+{
+	state = state * Q_UINT64_C(6364136223846793005)
+	      + Q_UINT64_C(1442695040888963407);
+	return state;
+}
+
+int encodeSquare(int file, int rank)
+{
+	return (12 - rank) * 16 + file + 3;
+}
+
+// Binds \a key the way OpeningBook does
+QVariant sqlKey(quint64 key)
+{
+	if (qint64(key) > 0)
+		return key;
+
+	double dkey;
+	memcpy(&dkey, &key, sizeof(dkey));
+	return dkey;
+}
+
+} // anonymous namespace
+
+void tst_CompiledBook::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+	m_sqlFileName = m_dir.filePath("book.db");
+	m_fileName = m_dir.filePath("book.bin");
+
+	{
+		QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "create");
+		db.setDatabaseName(m_sqlFileName);
+		QVERIFY(db.open());
+
+		QSqlQuery query(db);
+		QVERIFY(query.exec("create table bhobk (vkey integer, vmove integer, "
+				   "vscore integer, vvalid integer)"));
+		QVERIFY(query.exec("create index bhobk_vkey on bhobk (vkey)"));
+
+		QVERIFY(db.transaction());
+		QVERIFY(query.prepare("insert into bhobk values (?, ?, ?, ?)"));
+		quint64 state = 7;
+		for (int i = 0; i < 500; i++)
+		{
+			// Both halves of the key space: negative keys are
+			// stored as doubles
+			quint64 key = nextKey(state);
+			m_keys << key;
+			for (int j = 0; j < 1 + i % 5; j++)
+			{
+				int from = encodeSquare(j, i % 10);
+				int to = encodeSquare(8 - j, 9 - i % 10);
+				query.bindValue(0, sqlKey(key));
+				query.bindValue(1, (from << 8) | to);
+				// Some rows are filtered out by the book
+				query.bindValue(2, (i + j) % 7 - 1);
+				query.bindValue(3, j == 3 ? 0 : 1);
+				QVERIFY(query.exec());
+			}
+		}
+		QVERIFY(db.commit());
+		db.close();
+	}
+	QSqlDatabase::removeDatabase("create");
+
+	QString error;
+	QVERIFY2(CompiledBook::compile(m_sqlFileName, m_fileName, &error),
+		 qPrintable(error));
+}
+
+QStringList tst_CompiledBook::entries(const OpeningBook& book, quint64 key) const
+{
+	QStringList ret;
+	for (const auto& entry : book.entries(key))
+	{
+		ret << QString("%1%2-%3%4:%5:%6")
+		       .arg(entry.move.sourceSquare().file())
+		       .arg(entry.move.sourceSquare().rank())
+		       .arg(entry.move.targetSquare().file())
+		       .arg(entry.move.targetSquare().rank())
+		       .arg(entry.vscore)
+		       .arg(entry.valid);
+	}
+	ret.sort();
+
+	return ret;
+}
+
+void tst_CompiledBook::detect()
+{
+	QVERIFY(CompiledBook::isCompiledBook(m_fileName));
+	QVERIFY(!CompiledBook::isCompiledBook(m_sqlFileName));
+	QVERIFY(!CompiledBook::isCompiledBook(m_dir.filePath("missing.bin")));
+
+	auto book = CompiledBook::open(m_fileName);
+	QVERIFY(!book.isNull());
+	QCOMPARE(CompiledBook::open(m_fileName), book);
+}
+
+void tst_CompiledBook::roundTrip()
+{
+	PolyglotBook sqlBook;
+	QVERIFY(sqlBook.read(m_sqlFileName));
+	PolyglotBook book;
+	QVERIFY(book.read(m_fileName));
+
+	int found = 0;
+	for (quint64 key : qAsConst(m_keys))
+	{
+		QStringList expected = entries(sqlBook, key);
+		QCOMPARE(entries(book, key), expected);
+		found += expected.size();
+	}
+	QVERIFY(found > 0);
+}
+
+void tst_CompiledBook::misses()
+{
+	PolyglotBook book;
+	QVERIFY(book.read(m_fileName));
+
+	quint64 state = 12345;
+	for (int i = 0; i < 1000; i++)
+	{
+		quint64 key = nextKey(state);
+		if (!m_keys.contains(key))
+			QVERIFY(book.entries(key).isEmpty());
+	}
+	QVERIFY(book.entries(0).isEmpty());
+	QVERIFY(book.entries(~Q_UINT64_C(0)).isEmpty());
+	QVERIFY(book.move(0).isNull());
+}
+
+void tst_CompiledBook::truncated()
+{
+	QFile source(m_fileName);
+	QVERIFY(source.open(QIODevice::ReadOnly));
+	QByteArray data = source.readAll();
+
+	QString fileName = m_dir.filePath("truncated.bin");
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write(data.left(data.size() - 8));
+	file.close();
+
+	QVERIFY(CompiledBook::isCompiledBook(fileName));
+	QVERIFY(CompiledBook::open(fileName).isNull());
+	PolyglotBook book;
+	QVERIFY(!book.read(fileName));
+}
+
+void tst_CompiledBook::corruptBuckets()
+{
+	QFile source(m_fileName);
+	QVERIFY(source.open(QIODevice::ReadOnly));
+	QByteArray data = source.readAll();
+
+	// Point the second bucket past the last record. The header is
+	// 32 bytes and the record count is at offset 16.
+	quint32 count;
+	memcpy(&count, data.constData() + 16, sizeof(count));
+	quint32 offset = count + 1;
+	memcpy(data.data() + 32 + sizeof(quint32), &offset, sizeof(offset));
+
+	QString fileName = m_dir.filePath("corrupt.bin");
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write(data);
+	file.close();
+
+	QVERIFY(CompiledBook::isCompiledBook(fileName));
+	QVERIFY(CompiledBook::open(fileName).isNull());
+}
+
+QTEST_MAIN(tst_CompiledBook)
+#include "tst_compiledbook.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_enginetranscript
+SOURCES += tst_enginetranscript.cpp
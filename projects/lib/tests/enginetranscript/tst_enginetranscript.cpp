@@ -0,0 +1,77 @@
+#include <QtTest/QtTest>
+#include <enginetranscript.h>
+
+class tst_EngineTranscript: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void dump();
+		void wrapAround();
+		void longLine();
+
+	private:
+		QStringList dumpedLines(const EngineTranscript& transcript);
+};
+
+QStringList tst_EngineTranscript::dumpedLines(const EngineTranscript& transcript)
+{
+	QTemporaryDir dir;
+	const QString fileName(dir.filePath("transcript.txt"));
+	if (!transcript.dump(fileName, "title"))
+		return QStringList();
+
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return QStringList();
+
+	QStringList lines;
+	const QStringList text = QString::fromLatin1(file.readAll())
+		.split('\n', QString::SkipEmptyParts);
+	for (const QString& line : text)
+		lines << line.section(' ', 1);
+	return lines;
+}
+
+void tst_EngineTranscript::dump()
+{
+	EngineTranscript transcript;
+	transcript.append(EngineTranscript::Input, QByteArray("uci\n"));
+	transcript.append(EngineTranscript::Output, QByteArray("uciok\r\n"));
+	QCOMPARE(transcript.lineCount(), 2);
+
+	const QStringList lines = dumpedLines(transcript);
+	QCOMPARE(lines, QStringList() << "" << "> uci" << "< uciok");
+}
+
+void tst_EngineTranscript::wrapAround()
+{
+	// Room for a bit more than three 20-byte lines
+	EngineTranscript transcript(3 * (13 + 20) + 10);
+	for (int i = 0; i < 10; i++)
+	{
+		QByteArray line(QByteArray::number(i).rightJustified(20, 'x'));
+		transcript.append(EngineTranscript::Output, line);
+	}
+	QCOMPARE(transcript.lineCount(), 3);
+
+	const QStringList lines = dumpedLines(transcript);
+	QCOMPARE(lines.size(), 4);
+	QCOMPARE(lines.at(1), QString("< %1").arg("7", 20, 'x'));
+	QCOMPARE(lines.at(3), QString("< %1").arg("9", 20, 'x'));
+}
+
+void tst_EngineTranscript::longLine()
+{
+	EngineTranscript transcript(64);
+	transcript.append(EngineTranscript::Input, QByteArray("short"));
+	transcript.append(EngineTranscript::Input, QByteArray(200, 'a'));
+	QCOMPARE(transcript.lineCount(), 1);
+
+	const QStringList lines = dumpedLines(transcript);
+	QCOMPARE(lines.size(), 2);
+	QCOMPARE(lines.at(1), "> " + QString(64 - 13, 'a'));
+}
+
+QTEST_MAIN(tst_EngineTranscript)
+#include "tst_enginetranscript.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_gamerecord
+SOURCES += tst_gamerecord.cpp
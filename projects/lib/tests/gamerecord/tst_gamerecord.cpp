@@ -0,0 +1,185 @@
+#include <QtTest/QtTest>
+#include <gamerecord.h>
+#include <gamerecordstream.h>
+#include <pgngame.h>
+#include <board/boardfactory.h>
+
+namespace {
+
+// Comments in the format of ChessGame's evaluations
+const char* s_comments[] =
+{
+	"book",
+	"+0.35/16 1.5s",
+	"-M5/30 0.045s",
+	"0.00/1 0s",
+	"",
+	"/12 13s",
+	"-1.20/9 0.25s"
+};
+
+PgnGame game(int round)
+{
+	PgnGame pgn;
+	pgn.setEvent("test");
+	pgn.setSite("here");
+	pgn.setRound(round);
+	pgn.setPlayerName(Chess::Side::White, "white");
+	pgn.setPlayerName(Chess::Side::Black, "black");
+
+	Chess::Board* board = Chess::BoardFactory::create("standard");
+	board->initialize();
+	board->setFenString(board->defaultFenString());
+
+	for (const char* comment : s_comments)
+	{
+		const QVector<Chess::Move> moves(board->legalMoves());
+		const Chess::Move& move = moves.at((board->plyCount() * 7 + round) % moves.size());
+
+		PgnGame::MoveData md;
+		md.key = board->key();
+		md.move = board->genericMove(move);
+		md.moveString = board->moveString(move, Chess::Board::StandardChinese);
+		md.comment = comment;
+		pgn.addMove(md);
+		board->makeMove(move);
+	}
+	delete board;
+
+	pgn.setResult(Chess::Result(Chess::Result::Adjudication, Chess::Side::White));
+	pgn.setResultDescription("White wins by adjudication");
+	return pgn;
+}
+
+QString pgnString(const PgnGame& pgn)
+{
+	QString str;
+	QTextStream out(&str);
+	pgn.write(out);
+	out.flush();
+	return str;
+}
+
+} // anonymous namespace
+
+class tst_GameRecord: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void packMove();
+		void evaluations();
+		void roundTrip();
+		void sections();
+		void corruptData();
+};
+
+void tst_GameRecord::packMove()
+{
+	Chess::GenericMove move(Chess::Square(1, 2), Chess::Square(8, 9));
+	QVERIFY(GameRecord::canPackMove(move));
+	QCOMPARE(GameRecord::unpackMove(GameRecord::packMove(move)), move);
+
+	QVERIFY(!GameRecord::canPackMove(Chess::GenericMove()));
+	QVERIFY(!GameRecord::canPackMove(
+		Chess::GenericMove(Chess::Square(0, 0), Chess::Square(16, 0))));
+}
+
+void tst_GameRecord::evaluations()
+{
+	GameRecord record(game(1));
+	QVERIFY(record.hasEvaluations());
+	QCOMPARE(record.result(), GameRecord::WhiteWins);
+	QCOMPARE(record.resultDescription(), QString("White wins by adjudication"));
+
+	const QVector<GameRecord::MoveData>& moves = record.moves();
+	QCOMPARE(moves.size(), 7);
+	QCOMPARE(int(moves.at(0).score), int(GameRecord::BookScore));
+	QCOMPARE(int(moves.at(1).score), 35);
+	QCOMPARE(int(moves.at(1).depth), 16);
+	QCOMPARE(moves.at(1).time, quint32(1500));
+	QCOMPARE(int(moves.at(2).score), 5 - GameRecord::MateScore);
+	QCOMPARE(moves.at(2).time, quint32(45));
+	QCOMPARE(int(moves.at(4).score), int(GameRecord::NullScore));
+	QCOMPARE(int(moves.at(5).score), int(GameRecord::TimeOnlyScore));
+	QCOMPARE(int(moves.at(6).score), -120);
+
+	// Comments that aren't evaluations can't be stored
+	PgnGame pgn(game(1));
+	PgnGame::MoveData md(pgn.moves().first());
+	md.comment = "a nice move";
+	pgn.setMove(0, md);
+	QVERIFY(!GameRecord(pgn).hasEvaluations());
+}
+
+void tst_GameRecord::roundTrip()
+{
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+	GameRecordStream out(&buffer);
+	for (int i = 1; i <= 3; i++)
+		QVERIFY(out.writeRecord(GameRecord(game(i))));
+	buffer.close();
+
+	buffer.open(QIODevice::ReadOnly);
+	GameRecordStream in(&buffer);
+	GameRecord record;
+	PgnGame pgn;
+	for (int i = 1; i <= 3; i++)
+	{
+		QVERIFY(in.readRecord(&record));
+		QVERIFY(record.toPgn(&pgn));
+		QCOMPARE(pgnString(pgn), pgnString(game(i)));
+	}
+	QVERIFY(!in.readRecord(&record));
+	QCOMPARE(in.status(), GameRecordStream::ReadPastEnd);
+
+	// The strings are only stored once
+	QString text;
+	for (int i = 1; i <= 3; i++)
+		text += pgnString(game(i));
+	QVERIFY(data.size() < text.toUtf8().size() / 2);
+}
+
+void tst_GameRecord::sections()
+{
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+	GameRecordStream out(&buffer);
+	QVERIFY(out.writeRecord(GameRecord(game(1))));
+
+	// An appended section has its own string table
+	GameRecordStream append(&buffer);
+	QVERIFY(append.writeRecord(GameRecord(game(2))));
+	QVERIFY(append.writeRecord(GameRecord(game(3))));
+	buffer.close();
+
+	buffer.open(QIODevice::ReadOnly);
+	GameRecordStream in(&buffer);
+	GameRecord record;
+	PgnGame pgn;
+	for (int i = 1; i <= 3; i++)
+	{
+		QVERIFY(in.readRecord(&record));
+		QVERIFY(record.toPgn(&pgn));
+		QCOMPARE(pgn.round(), i);
+	}
+	QVERIFY(!in.readRecord(&record));
+}
+
+void tst_GameRecord::corruptData()
+{
+	QByteArray data("[Event \"test\"]\n");
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::ReadOnly);
+
+	GameRecordStream in(&buffer);
+	GameRecord record;
+	QVERIFY(!in.readRecord(&record));
+	QCOMPARE(in.status(), GameRecordStream::ReadCorruptData);
+}
+
+QTEST_MAIN(tst_GameRecord)
+#include "tst_gamerecord.moc"
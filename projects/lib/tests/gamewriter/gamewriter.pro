@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_gamewriter
+SOURCES += tst_gamewriter.cpp
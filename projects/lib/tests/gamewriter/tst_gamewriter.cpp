@@ -0,0 +1,126 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <gamewriter.h>
+
+namespace {
+
+PgnGame game(int round)
+{
+	PgnGame pgn;
+	pgn.setEvent("test");
+	pgn.setRound(round);
+	pgn.setPlayerName(Chess::Side::White, "white");
+	pgn.setPlayerName(Chess::Side::Black, "black");
+	pgn.setResult(Chess::Result(Chess::Result::Draw));
+	return pgn;
+}
+
+QByteArray readFile(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return QByteArray();
+	return file.readAll();
+}
+
+} // anonymous namespace
+
+class tst_GameWriter: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void pgnOutput();
+		void epdOutput();
+		void boundedQueue();
+		void sync();
+};
+
+void tst_GameWriter::pgnOutput()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString fileName(dir.filePath("games.pgn"));
+
+	GameWriter writer;
+	writer.setPgnOutput(fileName, PgnGame::Minimal);
+	for (int i = 1; i <= 10; i++)
+		writer.addPgnGame(game(i));
+	writer.finish();
+
+	QByteArray expected;
+	QTextStream out(&expected, QIODevice::WriteOnly);
+	for (int i = 1; i <= 10; i++)
+		game(i).write(out, PgnGame::Minimal);
+	out.flush();
+
+	QCOMPARE(readFile(fileName), expected);
+	QCOMPARE(writer.writtenGameCount(), qint64(10));
+	QCOMPARE(writer.writtenByteCount(), qint64(expected.size()));
+	QCOMPARE(writer.queueSize(), 0);
+}
+
+void tst_GameWriter::epdOutput()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString fileName(dir.filePath("positions.epd"));
+	const QString fen("rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1");
+
+	GameWriter writer;
+	writer.setEpdOutput(fileName);
+	writer.addEpdPosition(fen);
+	writer.addEpdPosition(fen);
+	writer.finish();
+
+	// The writer appends to the file after it was restarted
+	writer.addEpdPosition(fen);
+	writer.finish();
+
+	QCOMPARE(readFile(fileName), QString(fen + "\n").repeated(3).toUtf8());
+	QCOMPARE(writer.writtenGameCount(), qint64(0));
+}
+
+void tst_GameWriter::boundedQueue()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString fileName(dir.filePath("games.pgn"));
+
+	GameWriter writer;
+	writer.setPgnOutput(fileName);
+	writer.setMaxQueueSize(2);
+	for (int i = 1; i <= 100; i++)
+	{
+		writer.addPgnGame(game(i));
+		QVERIFY(writer.queueSize() <= 2);
+	}
+	writer.finish();
+
+	QVERIFY(writer.peakQueueSize() <= 2);
+	QCOMPARE(writer.writtenGameCount(), qint64(100));
+	QCOMPARE(readFile(fileName).count("[Event \"test\"]"), 100);
+}
+
+void tst_GameWriter::sync()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString fileName(dir.filePath("games.pgn"));
+
+	GameWriter writer;
+	writer.setPgnOutput(fileName);
+	writer.setSyncInterval(10, 3);
+	for (int i = 1; i <= 5; i++)
+		writer.addPgnGame(game(i));
+
+	// The timed sync doesn't keep the writer from finishing
+	QTest::qSleep(30);
+	writer.finish();
+
+	QCOMPARE(writer.writtenGameCount(), qint64(5));
+	QCOMPARE(readFile(fileName).count("[Event \"test\"]"), 5);
+}
+
+QTEST_MAIN(tst_GameWriter)
+#include "tst_gamewriter.moc"
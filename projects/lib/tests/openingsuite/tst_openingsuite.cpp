@@ -0,0 +1,119 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <openingsuite.h>
+#include <mersenne.h>
+
+namespace {
+
+const int s_positionCount = 50;
+
+// A suite of positions that only differ by the move number
+QString writeSuite(const QTemporaryDir& dir)
+{
+	QString fileName(dir.filePath("suite.epd"));
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return QString();
+
+	QTextStream out(&file);
+	for (int i = 1; i <= s_positionCount; i++)
+	{
+		out << "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 "
+		    << i << "\n";
+		if (i % 10 == 0)
+			out << "\n";
+	}
+	return fileName;
+}
+
+int moveNumber(const PgnGame& game)
+{
+	return game.startingFenString().section(' ', 5, 5).toInt();
+}
+
+QList<int> randomOrder(const QString& fileName, quint32 seed, int count)
+{
+	Mersenne::initialize(seed);
+	OpeningSuite suite(fileName, OpeningSuite::EpdFormat,
+			   OpeningSuite::RandomOrder);
+	if (!suite.initialize())
+		return QList<int>();
+
+	QList<int> order;
+	for (int i = 0; i < count; i++)
+		order << moveNumber(suite.nextGame(0));
+	return order;
+}
+
+} // anonymous namespace
+
+class tst_OpeningSuite: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void randomOrder();
+		void staleIndex();
+		void startIndex();
+};
+
+void tst_OpeningSuite::randomOrder()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString fileName(writeSuite(dir));
+
+	QList<int> order(::randomOrder(fileName, 1, s_positionCount * 2));
+	QVERIFY(QFile::exists(fileName + ".idx"));
+
+	// Every opening is played once before any is repeated
+	for (int cycle = 0; cycle < 2; cycle++)
+	{
+		QList<int> numbers(order.mid(cycle * s_positionCount, s_positionCount));
+		std::sort(numbers.begin(), numbers.end());
+		for (int i = 0; i < s_positionCount; i++)
+			QCOMPARE(numbers.at(i), i + 1);
+	}
+
+	// The same seed gives the same order with the saved index
+	QCOMPARE(::randomOrder(fileName, 1, s_positionCount * 2), order);
+	QVERIFY(::randomOrder(fileName, 2, s_positionCount) != order.mid(0, s_positionCount));
+}
+
+void tst_OpeningSuite::staleIndex()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString fileName(writeSuite(dir));
+	QCOMPARE(::randomOrder(fileName, 1, 1).size(), 1);
+
+	// A shorter suite must not be read with the old index
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+	file.write("rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 7\n");
+	file.close();
+
+	QCOMPARE(::randomOrder(fileName, 1, 3), QList<int>() << 7 << 7 << 7);
+}
+
+void tst_OpeningSuite::startIndex()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QString fileName(writeSuite(dir));
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		OpeningSuite suite(fileName, OpeningSuite::EpdFormat,
+				   OpeningSuite::SequentialOrder, 24);
+		QVERIFY(suite.initialize());
+		QCOMPARE(moveNumber(suite.nextGame(0)), 25);
+		QCOMPARE(moveNumber(suite.nextGame(0)), 26);
+
+		// The second pass seeks with the index
+		::randomOrder(fileName, 1, 1);
+	}
+}
+
+QTEST_MAIN(tst_OpeningSuite)
+#include "tst_openingsuite.moc"
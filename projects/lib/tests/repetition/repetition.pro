@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_repetition
+SOURCES += tst_repetition.cpp
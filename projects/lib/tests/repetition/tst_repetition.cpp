@@ -0,0 +1,205 @@
+#include <QtTest/QtTest>
+#include <board/standardboard.h>
+
+namespace {
+
+/*
+ * StandardBoard with the repetition and perpetual check rules as they
+ * were before they became incremental: a full history scan for every
+ * repetition count and a board copy that is unwound move by move to
+ * rule on perpetual checks.
+ */
+class ReferenceBoard : public Chess::StandardBoard
+{
+	public:
+		virtual Chess::Board* copy() const
+		{
+			return new ReferenceBoard(*this);
+		}
+
+		using Chess::Board::generateMoves;
+		using Chess::StandardBoard::vIsLegalMove;
+
+		void play(const Chess::Move& move)
+		{
+			m_keys.append(key());
+			makeMove(move);
+		}
+
+		void takeBack()
+		{
+			m_keys.removeLast();
+			undoMove();
+		}
+
+		int referenceRepeatCount() const
+		{
+			if (plyCount() < 4)
+				return 0;
+
+			int count = 0;
+			for (int i = m_keys.size() - 1; i >= 0; i--)
+			{
+				if (m_keys.at(i) == key())
+					count++;
+			}
+			return count;
+		}
+
+		bool referenceIsLegalMove(const Chess::Move& move)
+		{
+			bool isBan = false;
+
+			play(move);
+			bool isLegal = isLegalPosition();
+			if (isLegal && referenceRepeatCount() >= 2)
+			{
+				ReferenceBoard* board = static_cast<ReferenceBoard*>(copy());
+				isBan = board->referenceIsBan();
+				delete board;
+			}
+			takeBack();
+
+			return isLegal && !isBan;
+		}
+
+	private:
+		bool referenceIsBan()
+		{
+			int n = 0;
+			int moCheck[2] = { 1, 1 };
+			quint64 lastKey = key();
+
+			for (int i = plyCount() - 1; i >= 0; i--)
+			{
+				if (!inCheck(sideToMove()))
+					moCheck[1 & n] = 0;
+
+				takeBack();
+				if (key() == lastKey)
+					break;
+				if (moCheck[0] + moCheck[1] == 0)
+					return false;
+				n++;
+			}
+
+			n--;
+			if (moCheck[0] + moCheck[1] == 2)
+				return false;
+			return moCheck[1 & n] != 0;
+		}
+
+		QVector<quint64> m_keys;
+};
+
+quint32 nextRandom(quint64& state)
+{
+	state = state * Q_UINT64_C(6364136223846793005)
+	      + Q_UINT64_C(1442695040888963407);
+	return quint32(state >> 33);
+}
+
+} // anonymous namespace
+
+class tst_Repetition: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void perpetualCheck();
+		void randomGames_data() const;
+		void randomGames();
+};
+
+void tst_Repetition::perpetualCheck()
+{
+	ReferenceBoard board;
+	board.initialize();
+	QVERIFY(board.setFenString("3k5/9/9/9/9/9/9/9/R8/5K3 w - - 0 1"));
+
+	// The rook checks from the d and e files while the king steps
+	// between d9 and e9
+	const QStringList moves = QStringList()
+		<< "a1d1" << "d9e9" << "d1e1" << "e9d9"
+		<< "e1d1" << "d9e9" << "d1e1" << "e9d9";
+	for (const QString& str : moves)
+	{
+		Chess::Move move = board.moveFromString(str);
+		QVERIFY2(!move.isNull(), qPrintable(str));
+		QVERIFY(board.referenceIsLegalMove(move));
+		board.play(move);
+		QCOMPARE(board.repeatCount(), board.referenceRepeatCount());
+	}
+	QCOMPARE(board.repeatCount(), 1);
+
+	// A third check from d1 would repeat the position a third time
+	QVERIFY(board.moveFromString("e1d1").isNull());
+	QVERIFY(!board.legalMoves().isEmpty());
+}
+
+void tst_Repetition::randomGames_data() const
+{
+	QTest::addColumn<QString>("fen");
+
+	QTest::newRow("startpos")
+		<< "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w - - 0 1";
+	QTest::newRow("rook vs king")
+		<< "3k5/9/9/9/9/9/9/9/R8/5K3 w - - 0 1";
+	QTest::newRow("rook and cannon vs advisors")
+		<< "3aka3/9/9/9/9/9/9/2C6/R8/5K3 w - - 0 1";
+	QTest::newRow("rooks")
+		<< "3k5/4a4/9/9/9/9/9/9/r7R/4K4 w - - 0 1";
+}
+
+/*
+ * Plays random games that often reverse their own moves, so positions
+ * repeat, and compares the repetition count and the legality of every
+ * pseudo-legal move with the reference implementation.
+ */
+void tst_Repetition::randomGames()
+{
+	QFETCH(QString, fen);
+
+	quint64 state = 1;
+	for (int game = 0; game < 20; game++)
+	{
+		ReferenceBoard board;
+		board.initialize();
+		QVERIFY(board.setFenString(fen));
+
+		QVector<Chess::Move> history;
+		for (int ply = 0; ply < 200; ply++)
+		{
+			QCOMPARE(board.repeatCount(), board.referenceRepeatCount());
+
+			QVarLengthArray<Chess::Move> moves;
+			board.generateMoves(moves);
+
+			QVector<Chess::Move> legal;
+			for (int i = 0; i < moves.size(); i++)
+			{
+				bool isLegal = board.vIsLegalMove(moves[i]);
+				QCOMPARE(isLegal, board.referenceIsLegalMove(moves[i]));
+				if (isLegal)
+					legal << moves[i];
+			}
+			if (legal.isEmpty())
+				break;
+
+			Chess::Move move = legal.at(int(nextRandom(state) % legal.size()));
+			if (history.size() >= 2 && nextRandom(state) % 4 != 0)
+			{
+				const Chess::Move& old = history.at(history.size() - 2);
+				Chess::Move back(old.targetSquare(), old.sourceSquare());
+				if (legal.contains(back))
+					move = back;
+			}
+
+			board.play(move);
+			history << move;
+		}
+	}
+}
+
+QTEST_MAIN(tst_Repetition)
+#include "tst_repetition.moc"
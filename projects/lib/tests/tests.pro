@@ -1,5 +1,5 @@
 TEMPLATE = subdirs
-SUBDIRS = chessboard tb sprt mersenne tournamentplayer tournamentpair polyglotbook
+SUBDIRS = chessboard tb sprt mersenne enginetranscript tournamentplayer tournamentpair polyglotbook compiledbook repetition timecontrol gamewriter gamerecord openingsuite
 win32 {
     SUBDIRS += pipereader
 }
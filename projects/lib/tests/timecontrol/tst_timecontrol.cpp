@@ -0,0 +1,74 @@
+#include <QtTest/QtTest>
+#include <timecontrol.h>
+
+class tst_TimeControl: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void untimed();
+		void startTime();
+		void replyTime();
+		void futureReplyTime();
+};
+
+void tst_TimeControl::untimed()
+{
+	TimeControl tc("40/60");
+	tc.setStartTime(TimeControl::currentTime());
+	tc.update();
+
+	QCOMPARE(tc.lastMoveTime(), 0);
+	QCOMPARE(tc.lastMoveOverhead(), 0);
+	QCOMPARE(tc.lastMoveLag(), 0);
+	QCOMPARE(tc.timeLeft(), 60000);
+}
+
+void tst_TimeControl::startTime()
+{
+	TimeControl tc("40/60");
+	tc.startTimer();
+	qint64 start = TimeControl::currentTime();
+	QTest::qSleep(20);
+
+	// The time before the start time isn't charged
+	tc.setStartTime(start + 10);
+	QVERIFY(tc.activeTimeLeft() <= 60000);
+	tc.update(true, start + 15);
+
+	QCOMPARE(tc.lastMoveTime(), 5);
+	QVERIFY(tc.lastMoveOverhead() >= 10);
+	QVERIFY(tc.lastMoveLag() >= 5);
+	QCOMPARE(tc.timeLeft(), 60000 - 5);
+}
+
+void tst_TimeControl::replyTime()
+{
+	TimeControl tc("40/60+1");
+	tc.startTimer();
+	qint64 start = TimeControl::currentTime();
+	QTest::qSleep(20);
+
+	// A start time before the timer started is ignored
+	tc.setStartTime(start - 1000);
+	tc.update(true, start + 10);
+
+	QVERIFY(tc.lastMoveTime() >= 10);
+	QVERIFY(tc.lastMoveTime() < 20);
+	QCOMPARE(tc.lastMoveOverhead(), 0);
+	QVERIFY(tc.lastMoveLag() >= 10);
+	QCOMPARE(tc.timeLeft(), 60000 - tc.lastMoveTime() + 1000);
+}
+
+void tst_TimeControl::futureReplyTime()
+{
+	TimeControl tc("40/60");
+	tc.startTimer();
+	tc.update(true, TimeControl::currentTime() + 100000);
+
+	QVERIFY(tc.lastMoveTime() < 100000);
+	QCOMPARE(tc.lastMoveLag(), 0);
+}
+
+QTEST_MAIN(tst_TimeControl)
+#include "tst_timecontrol.moc"